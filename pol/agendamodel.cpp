@@ -0,0 +1,303 @@
+#include "agendamodel.h"
+#include "taskmanager.h"
+#include "storagebackend.h"
+#include "trace.h"
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QLocale>
+#include <QFont>
+#include <QColor>
+#include <algorithm>
+
+namespace {
+
+typedef QList<QPair<int, QList<Task>>> PartitionBatch;
+
+}
+
+AgendaModel::AgendaModel(TaskManager* taskManager, QObject* parent)
+    : QAbstractListModel(parent), taskManager(taskManager) {
+    connect(taskManager, &TaskManager::tasksChanged, this, &AgendaModel::onTasksChanged);
+    resetTo(QDate::currentDate());
+}
+
+int AgendaModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant AgendaModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+    const Row& row = rows.at(index.row());
+    if (row.header) {
+        switch (role) {
+            case Qt::DisplayRole: {
+                QString text = QLocale(QLocale::Russian).toString(row.day, "dddd, d MMMM yyyy");
+                if (row.day == QDate::currentDate()) {
+                    text = "Сегодня — " + text;
+                }
+                return text;
+            }
+            case Qt::FontRole: {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            case Qt::BackgroundRole:
+                return row.day == QDate::currentDate() ? QColor(219, 234, 254) : QColor(241, 245, 249);
+            case IsHeaderRole: return true;
+            case DayRole: return row.day;
+            default: return QVariant();
+        }
+    }
+
+    const Task& task = row.task;
+    bool completed = task.getStatus() == TaskStatus::Completed;
+    switch (role) {
+        case Qt::DisplayRole:
+            return task.getCategory().isEmpty() ? task.getTitle()
+                                                : task.getTitle() + "  ·  " + task.getCategory();
+        case Qt::ToolTipRole: return task.getDescription();
+        case Qt::CheckStateRole: return completed ? Qt::Checked : Qt::Unchecked;
+        case Qt::ForegroundRole: return completed ? QColor(100, 116, 139) : task.priorityColor();
+        case IsHeaderRole: return false;
+        case TaskIdRole: return task.getId();
+        case RuleIdRole: return task.getRecurrenceId();
+        case DayRole: return row.day;
+        default: return QVariant();
+    }
+}
+
+Qt::ItemFlags AgendaModel::flags(const QModelIndex& index) const {
+    if (!index.isValid() || rows.at(index.row()).header) {
+        return Qt::ItemIsEnabled;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+}
+
+bool AgendaModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (role != Qt::CheckStateRole || !index.isValid() || rows.at(index.row()).header) {
+        return false;
+    }
+    // Сама модель задачу не меняет: строка обновится по tasksChanged
+    const Task& task = rows.at(index.row()).task;
+    emit statusToggled(task.getId(), task.getRecurrenceId(), task.getOccurrenceDate(),
+                       value.toInt() == Qt::Checked);
+    return true;
+}
+
+int AgendaModel::firstRowOf(const QDate& day) const {
+    QVector<Row>::const_iterator it = std::lower_bound(rows.constBegin(), rows.constEnd(), day,
+        [](const Row& row, const QDate& d) { return row.day < d; });
+    return int(it - rows.constBegin());
+}
+
+int AgendaModel::rowForDay(const QDate& day) const {
+    return qMin(firstRowOf(day), qMax(0, rows.size() - 1));
+}
+
+QVector<AgendaModel::Row> AgendaModel::buildRows(const QDate& from, const QDate& to) const {
+    TRACE_SCOPE("AgendaModel::buildRows");
+    QList<Task> found = taskManager->getTasksInRange(from, to);
+    std::stable_sort(found.begin(), found.end(), [](const Task& a, const Task& b) {
+        return a.getDeadline() < b.getDeadline();
+    });
+
+    QVector<Row> result;
+    result.reserve(found.size() + 64);
+    QDate today = QDate::currentDate();
+    int i = 0;
+    for (QDate day = from; day <= to; day = day.addDays(1)) {
+        // Пустые дни не показываем, кроме сегодняшнего — к нему прокручивают
+        bool any = i < found.size() && found[i].getDeadline() == day;
+        if (!any && day != today) {
+            continue;
+        }
+        Row header;
+        header.day = day;
+        header.header = true;
+        result.append(header);
+        for (; i < found.size() && found[i].getDeadline() == day; ++i) {
+            Row row;
+            row.day = day;
+            row.task = found[i];
+            result.append(row);
+        }
+    }
+    return result;
+}
+
+bool AgendaModel::prefetch(const QDate& from, const QDate& to) {
+    QList<int> keys = taskManager->missingPartitions(from, to);
+    QList<int> toRead;
+    for (int key : keys) {
+        if (!prefetching.contains(key)) {
+            toRead.append(key);
+            prefetching.insert(key);
+        }
+    }
+    if (keys.isEmpty()) {
+        return true;
+    }
+    if (toRead.isEmpty()) {
+        return false;   // уже читаются
+    }
+
+    StorageBackend* storage = StorageBackend::instance();
+    QFutureWatcher<PartitionBatch>* reader = new QFutureWatcher<PartitionBatch>(this);
+    connect(reader, &QFutureWatcherBase::finished, this, [this, reader]() {
+        PartitionBatch batch = reader->result();
+        reader->deleteLater();
+        for (const QPair<int, QList<Task>>& partition : batch) {
+            prefetching.remove(partition.first);
+            taskManager->adoptPartition(partition.first, partition.second);
+        }
+        emit dataReady();
+    });
+    reader->setFuture(QtConcurrent::run([toRead, storage]() {
+        TRACE_SCOPE("AgendaModel::prefetch");
+        PartitionBatch batch;
+        for (int key : toRead) {
+            QList<Task> loaded;
+            storage->readPartition(key, loaded);
+            batch.append(qMakePair(key, loaded));
+        }
+        return batch;
+    }));
+    return false;
+}
+
+void AgendaModel::resetTo(const QDate& center) {
+    beginResetModel();
+    firstDay = center.addDays(-CHUNK_DAYS / 2);
+    lastDay = center.addDays(CHUNK_DAYS);
+    rows = buildRows(firstDay, lastDay);
+    endResetModel();
+    prefetch(firstDay.addDays(-CHUNK_DAYS), firstDay.addDays(-1));
+    prefetch(lastDay.addDays(1), lastDay.addDays(CHUNK_DAYS));
+}
+
+bool AgendaModel::extendForward() {
+    QDate from = lastDay.addDays(1);
+    QDate to = lastDay.addDays(CHUNK_DAYS);
+    if (!prefetch(from, to)) {
+        return false;
+    }
+    QVector<Row> added = buildRows(from, to);
+    if (!added.isEmpty()) {
+        beginInsertRows(QModelIndex(), rows.size(), rows.size() + added.size() - 1);
+        rows += added;
+        endInsertRows();
+    }
+    lastDay = to;
+    trimFront();
+    // Следующий кусок — заранее
+    prefetch(to.addDays(1), to.addDays(CHUNK_DAYS));
+    return true;
+}
+
+bool AgendaModel::extendBackward() {
+    QDate from = firstDay.addDays(-CHUNK_DAYS);
+    QDate to = firstDay.addDays(-1);
+    if (!prefetch(from, to)) {
+        return false;
+    }
+    QVector<Row> added = buildRows(from, to);
+    if (!added.isEmpty()) {
+        beginInsertRows(QModelIndex(), 0, added.size() - 1);
+        rows = added + rows;
+        endInsertRows();
+        emit rowsPrepended(added.size());
+    }
+    firstDay = from;
+    trimBack();
+    prefetch(from.addDays(-CHUNK_DAYS), from.addDays(-1));
+    return true;
+}
+
+void AgendaModel::trimFront() {
+    if (firstDay.daysTo(lastDay) < MAX_WINDOW_DAYS) {
+        return;
+    }
+    QDate newFirst = lastDay.addDays(-MAX_WINDOW_DAYS + 1);
+    int count = firstRowOf(newFirst);
+    if (count > 0) {
+        beginRemoveRows(QModelIndex(), 0, count - 1);
+        rows.remove(0, count);
+        endRemoveRows();
+        emit rowsPrepended(-count);
+    }
+    firstDay = newFirst;
+}
+
+void AgendaModel::trimBack() {
+    if (firstDay.daysTo(lastDay) < MAX_WINDOW_DAYS) {
+        return;
+    }
+    QDate newLast = firstDay.addDays(MAX_WINDOW_DAYS - 1);
+    int from = firstRowOf(newLast.addDays(1));
+    if (from < rows.size()) {
+        beginRemoveRows(QModelIndex(), from, rows.size() - 1);
+        rows.resize(from);
+        endRemoveRows();
+    }
+    lastDay = newLast;
+}
+
+void AgendaModel::refreshDay(const QDate& day) {
+    if (day < firstDay || day > lastDay) {
+        return;
+    }
+    int start = firstRowOf(day);
+    int end = firstRowOf(day.addDays(1));
+    QVector<Row> fresh = buildRows(day, day);
+    if (fresh.size() == end - start) {
+        for (int i = 0; i < fresh.size(); ++i) {
+            rows[start + i] = fresh[i];
+        }
+        if (!fresh.isEmpty()) {
+            emit dataChanged(index(start), index(end - 1));
+        }
+        return;
+    }
+    if (end > start) {
+        beginRemoveRows(QModelIndex(), start, end - 1);
+        rows.remove(start, end - start);
+        endRemoveRows();
+    }
+    if (!fresh.isEmpty()) {
+        beginInsertRows(QModelIndex(), start, start + fresh.size() - 1);
+        for (int i = 0; i < fresh.size(); ++i) {
+            rows.insert(start + i, fresh[i]);
+        }
+        endInsertRows();
+    }
+}
+
+void AgendaModel::onTasksChanged(const QList<TaskId>& taskIds) {
+    if (taskIds.isEmpty()) {
+        // Перезагрузка набора или правка правил — окно строится заново на том же месте
+        beginResetModel();
+        rows = buildRows(firstDay, lastDay);
+        endResetModel();
+        return;
+    }
+    // Дни, где задача была, и дни, где она теперь
+    QSet<qint64> days;
+    QSet<TaskId> ids = QSet<TaskId>::fromList(taskIds);
+    for (const Row& row : rows) {
+        if (!row.header && ids.contains(row.task.getId())) {
+            days.insert(row.day.toJulianDay());
+        }
+    }
+    for (TaskId taskId : taskIds) {
+        const Task* task = taskManager->getTask(taskId);
+        if (task) {
+            days.insert(task->getDeadline().toJulianDay());
+        }
+    }
+    for (qint64 day : days) {
+        refreshDay(QDate::fromJulianDay(day));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef AGENDAMODEL_H
+#define AGENDAMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QSet>
+#include <QDate>
+#include "task.h"
+
+class TaskManager;
+
+// Лента задач по дням: строки — заголовок дня и его задачи. В модели всегда только
+// окно дней вокруг прокрутки (не больше MAX_WINDOW_DAYS): у края окно расширяется
+// на CHUNK_DAYS, а с противоположной стороны столько же отбрасывается. Разделы месяцев
+// для следующего куска читаются из хранилища заранее в пуле потоков, поэтому прокрутка не ждёт диска.
+class AgendaModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IsHeaderRole = Qt::UserRole + 100,
+        TaskIdRole,
+        RuleIdRole,
+        DayRole
+    };
+
+    explicit AgendaModel(TaskManager* taskManager, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+
+    QDate getFirstDay() const { return firstDay; }
+    QDate getLastDay() const { return lastDay; }
+    int rowForDay(const QDate& day) const;      // заголовок дня или ближайшего следующего
+
+    void resetTo(const QDate& center);
+    // false — данные ещё читаются, повторить по dataReady
+    bool extendBackward();
+    bool extendForward();
+
+signals:
+    void statusToggled(TaskId taskId, int ruleId, const QDate& occurrenceDate, bool completed);
+    void rowsPrepended(int count);      // строки добавлены или убраны сверху (count < 0):
+                                        // вид сдвигает прокрутку, чтобы содержимое не прыгало
+    void dataReady();
+
+private slots:
+    void onTasksChanged(const QList<TaskId>& taskIds);
+
+private:
+    struct Row {
+        Row() : header(false) {}
+        QDate day;
+        bool header;
+        Task task;
+    };
+
+    static const int CHUNK_DAYS = 62;
+    static const int MAX_WINDOW_DAYS = 366;
+
+    TaskManager* taskManager;
+    QVector<Row> rows;
+    QDate firstDay;     // окно включительно
+    QDate lastDay;
+    QSet<int> prefetching;      // разделы, которые читаются сейчас
+
+    QVector<Row> buildRows(const QDate& from, const QDate& to) const;
+    bool prefetch(const QDate& from, const QDate& to);  // true — всё уже в памяти
+    void trimFront();
+    void trimBack();
+    void refreshDay(const QDate& day);
+    int firstRowOf(const QDate& day) const;
+};
+
+#endif // AGENDAMODEL_H
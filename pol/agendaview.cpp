@@ -0,0 +1,56 @@
+#include "agendaview.h"
+#include "agendamodel.h"
+#include <QScrollBar>
+
+AgendaView::AgendaView(AgendaModel* model, QWidget* parent)
+    : QListView(parent), agenda(model), adjusting(false) {
+    setModel(model);
+    setUniformItemSizes(true);
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setStyleSheet("QListView { border: 1px solid #e2e8f0; border-radius: 8px; }"
+                  "QListView::item { padding: 4px 8px; }");
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &AgendaView::checkEdges);
+    connect(agenda, &AgendaModel::dataReady, this, &AgendaView::checkEdges);
+    connect(agenda, &AgendaModel::rowsPrepended, this, &AgendaView::onRowsPrepended);
+}
+
+void AgendaView::scrollToDay(const QDate& day) {
+    if (day < agenda->getFirstDay() || day > agenda->getLastDay()) {
+        agenda->resetTo(day);
+    }
+    scrollTo(agenda->index(agenda->rowForDay(day)), QAbstractItemView::PositionAtTop);
+}
+
+void AgendaView::checkEdges() {
+    int rows = agenda->rowCount();
+    if (adjusting || rows == 0) {
+        return;
+    }
+    int top = indexAt(QPoint(0, 0)).row();
+    int bottom = indexAt(QPoint(0, viewport()->height() - 1)).row();
+    if (bottom < 0) {
+        bottom = rows - 1;      // строк меньше, чем помещается
+    }
+    // Сдвиг за один вызов не больше одного куска: при быстрой прокрутке
+    // следующий кусок запросит следующее событие полосы прокрутки
+    if (bottom >= rows - EDGE_ROWS) {
+        agenda->extendForward();
+    } else if (top >= 0 && top < EDGE_ROWS) {
+        agenda->extendBackward();
+    }
+}
+
+void AgendaView::onRowsPrepended(int count) {
+    // Строки сверху добавились или ушли — прокрутка сдвигается на столько же,
+    // чтобы на экране остались те же дни
+    executeDelayedItemsLayout();
+    int rowHeight = sizeHintForRow(0);
+    if (rowHeight > 0) {
+        QScrollBar* bar = verticalScrollBar();
+        adjusting = true;
+        bar->setValue(bar->value() + count * rowHeight);
+        adjusting = false;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef AGENDAVIEW_H
+#define AGENDAVIEW_H
+
+#include <QListView>
+#include <QDate>
+
+class AgendaModel;
+
+// Список ленты с одинаковой высотой строк: рисуются только видимые строки,
+// у края прокрутки модель подгружает следующий кусок дней.
+class AgendaView : public QListView {
+    Q_OBJECT
+
+public:
+    explicit AgendaView(AgendaModel* model, QWidget* parent = nullptr);
+
+    void scrollToDay(const QDate& day);
+
+private slots:
+    void checkEdges();
+    void onRowsPrepended(int count);
+
+private:
+    static const int EDGE_ROWS = 20;    // за сколько строк до края просить следующий кусок
+
+    AgendaModel* agenda;
+    bool adjusting;     // прокрутка сдвигается из-за правки модели, а не пользователем
+};
+
+#endif // AGENDAVIEW_H
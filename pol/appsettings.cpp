@@ -0,0 +1,17 @@
+#include "appsettings.h"
+#include <QSettings>
+#include <QStandardPaths>
+
+QVariant AppSettings::value(const QString& key, const QVariant& defaultValue) {
+    QSettings settings(filePath(), QSettings::IniFormat);
+    return settings.value(key, defaultValue);
+}
+
+void AppSettings::setValue(const QString& key, const QVariant& value) {
+    QSettings settings(filePath(), QSettings::IniFormat);
+    settings.setValue(key, value);
+}
+
+QString AppSettings::filePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/settings.ini";
+}
@@ -0,0 +1,17 @@
+#ifndef APPSETTINGS_H
+#define APPSETTINGS_H
+
+#include <QString>
+#include <QVariant>
+
+// Настройки приложения: settings.ini рядом с данными в AppData
+class AppSettings {
+public:
+    static QVariant value(const QString& key, const QVariant& defaultValue = QVariant());
+    static void setValue(const QString& key, const QVariant& value);
+
+private:
+    static QString filePath();
+};
+
+#endif // APPSETTINGS_H
@@ -0,0 +1,266 @@
+#include "backuparchive.h"
+#include "storagebackend.h"
+#include "trace.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <cstring>
+
+static const char ARCHIVE_MAGIC[] = "POLBAK01";
+static const char INDEX_MAGIC[] = "POLINDEX";
+static const int MAGIC_SIZE = 8;
+static const int TAIL_SIZE = 8 + MAGIC_SIZE;
+
+static bool fail(QString* error, const QString& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+// Имя из индекса не должно выводить за пределы каталога данных
+static bool isSafeName(const QString& name) {
+    return !name.isEmpty() && !QDir::isAbsolutePath(name) && !name.contains('\\')
+        && !name.split('/').contains("..");
+}
+
+QStringList BackupArchive::collectFiles(const QString& dataDir) {
+    QDir dir(dataDir);
+    QStringList names;
+    for (const QString& name : QDir(dir.filePath("tasks")).entryList(QStringList() << "*.json", QDir::Files)) {
+        names.append("tasks/" + name);
+    }
+    for (const QString& name : QStringList() << "english_vocabulary.json" << "gamestats.json"
+                                             << "gamestats_ledger.jsonl") {
+        if (dir.exists(name)) {
+            names.append(name);
+        }
+    }
+    // Старая база после возврата на JSON не нужна — в копию идёт только действующая
+    if (StorageBackend::activeKind() == StorageBackend::Sqlite && dir.exists("pol.sqlite")) {
+        names.append("pol.sqlite");
+    }
+    names.append(dir.entryList(QStringList() << "prayer_*.png", QDir::Files));
+    return names;
+}
+
+bool BackupArchive::write(const QString& archivePath, const QString& dataDir,
+                          const Progress& progress, QString* error) {
+    TRACE_SCOPE("BackupArchive::write");
+    QDir dir(dataDir);
+    QStringList names = collectFiles(dataDir);
+    qint64 total = 0;
+    for (const QString& name : names) {
+        total += QFileInfo(dir.filePath(name)).size();
+    }
+
+    // QSaveFile: недописанный архив не заменит прежний файл с тем же именем
+    QSaveFile out(archivePath);
+    if (!out.open(QIODevice::WriteOnly)) {
+        return fail(error, "Не удалось создать файл: " + archivePath);
+    }
+    QDataStream stream(&out);
+    stream.writeRawData(ARCHIVE_MAGIC, MAGIC_SIZE);
+
+    QJsonArray index;
+    qint64 done = 0;
+    for (const QString& name : names) {
+        QFile in(dir.filePath(name));
+        if (!in.open(QIODevice::ReadOnly)) {
+            return fail(error, "Не удалось прочитать " + name);
+        }
+        // Изображения уже сжаты — повторное сжатие только тратит время
+        bool compressed = !name.endsWith(".png", Qt::CaseInsensitive);
+        qint64 offset = out.pos();
+        qint64 size = 0;
+        int chunks = 0;
+        for (;;) {
+            QByteArray chunk = in.read(CHUNK_SIZE);
+            if (chunk.isEmpty()) {
+                break;
+            }
+            QByteArray block = compressed ? qCompress(chunk, COMPRESSION_LEVEL) : chunk;
+            stream << quint32(block.size());
+            stream.writeRawData(block.constData(), block.size());
+            size += chunk.size();
+            done += chunk.size();
+            chunks++;
+            if (progress) {
+                progress(done, total);
+            }
+        }
+        stream << quint32(0);
+        if (in.error() != QFile::NoError) {
+            return fail(error, "Ошибка чтения " + name);
+        }
+
+        QJsonObject entry;
+        entry["name"] = name;
+        entry["offset"] = double(offset);
+        entry["size"] = double(size);
+        entry["chunks"] = chunks;
+        entry["compressed"] = compressed;
+        index.append(entry);
+    }
+
+    qint64 indexOffset = out.pos();
+    QByteArray indexData = qCompress(QJsonDocument(index).toJson(QJsonDocument::Compact));
+    stream << quint32(indexData.size());
+    stream.writeRawData(indexData.constData(), indexData.size());
+    stream << quint64(indexOffset);
+    stream.writeRawData(INDEX_MAGIC, MAGIC_SIZE);
+
+    if (stream.status() != QDataStream::Ok || !out.commit()) {
+        return fail(error, "Не удалось записать " + archivePath);
+    }
+    return true;
+}
+
+bool BackupArchive::restore(const QString& archivePath, const QString& dataDir,
+                            const Progress& progress, QString* error) {
+    TRACE_SCOPE("BackupArchive::restore");
+    QDir dir(dataDir);
+    QDir staging(dir.filePath(".restore"));
+    staging.removeRecursively();
+
+    QStringList names;
+    if (!extract(archivePath, staging.path(), progress, names, error)) {
+        staging.removeRecursively();
+        return false;
+    }
+
+    // Восстановление заменяет набор задач целиком: лишние разделы удаляем
+    bool hasTasks = false;
+    for (const QString& name : names) {
+        hasTasks = hasTasks || name.startsWith("tasks/");
+    }
+    // Снимок и журнал геймификации — одна пара (ledgerOffset снимка указывает в журнал):
+    // если в копии есть хотя бы один из них, прежние удаляются оба
+    if (names.contains("gamestats.json") || names.contains("gamestats_ledger.jsonl")) {
+        dir.remove("gamestats.json");
+        dir.remove("gamestats_ledger.jsonl");
+    }
+    // Журнал WAL относится к прежней базе; без базы в копии данные берутся из файлов JSON
+    dir.remove("pol.sqlite-wal");
+    dir.remove("pol.sqlite-shm");
+    if (!names.contains("pol.sqlite")) {
+        dir.remove("pol.sqlite");
+    }
+    if (hasTasks) {
+        QDir tasksDir(dir.filePath("tasks"));
+        for (const QString& name : tasksDir.entryList(QStringList() << "*.json", QDir::Files)) {
+            tasksDir.remove(name);
+        }
+    }
+
+    for (const QString& name : names) {
+        QString target = dir.filePath(name);
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        QFile::remove(target);
+        if (!QFile::rename(staging.filePath(name), target)) {
+            staging.removeRecursively();
+            return fail(error, "Не удалось заменить " + name);
+        }
+    }
+    staging.removeRecursively();
+    return true;
+}
+
+bool BackupArchive::extract(const QString& archivePath, const QString& stagingDir,
+                            const Progress& progress, QStringList& names, QString* error) {
+    QFile in(archivePath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        return fail(error, "Не удалось открыть " + archivePath);
+    }
+    QDataStream stream(&in);
+    char magic[MAGIC_SIZE];
+    if (in.size() < MAGIC_SIZE + 4 + TAIL_SIZE || stream.readRawData(magic, MAGIC_SIZE) != MAGIC_SIZE
+        || memcmp(magic, ARCHIVE_MAGIC, MAGIC_SIZE) != 0) {
+        return fail(error, "Файл не является резервной копией");
+    }
+
+    // Индекс — в конце файла
+    quint64 indexOffset = 0;
+    in.seek(in.size() - TAIL_SIZE);
+    stream >> indexOffset;
+    if (stream.readRawData(magic, MAGIC_SIZE) != MAGIC_SIZE || memcmp(magic, INDEX_MAGIC, MAGIC_SIZE) != 0
+        || indexOffset >= quint64(in.size())) {
+        return fail(error, "Резервная копия не дописана или повреждена");
+    }
+    in.seek(qint64(indexOffset));
+    quint32 indexSize = 0;
+    stream >> indexSize;
+    if (indexSize > MAX_BLOCK_SIZE) {
+        return fail(error, "Повреждён индекс резервной копии");
+    }
+    QByteArray indexData(int(indexSize), Qt::Uninitialized);
+    if (stream.readRawData(indexData.data(), int(indexSize)) != int(indexSize)) {
+        return fail(error, "Повреждён индекс резервной копии");
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(qUncompress(indexData));
+    if (!doc.isArray()) {
+        return fail(error, "Повреждён индекс резервной копии");
+    }
+    QJsonArray index = doc.array();
+
+    qint64 total = 0;
+    for (const QJsonValue& value : index) {
+        total += qint64(value.toObject()["size"].toDouble());
+    }
+
+    QDir staging(stagingDir);
+    qint64 done = 0;
+    for (const QJsonValue& value : index) {
+        QJsonObject entry = value.toObject();
+        QString name = entry["name"].toString();
+        qint64 size = qint64(entry["size"].toDouble());
+        bool compressed = entry["compressed"].toBool(true);
+        if (!isSafeName(name)) {
+            return fail(error, "Недопустимое имя в резервной копии: " + name);
+        }
+
+        QString target = staging.filePath(name);
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        QFile out(target);
+        if (!out.open(QIODevice::WriteOnly)) {
+            return fail(error, "Не удалось создать " + target);
+        }
+        in.seek(qint64(entry["offset"].toDouble()));
+        qint64 written = 0;
+        for (;;) {
+            quint32 blockSize = 0;
+            stream >> blockSize;
+            if (stream.status() != QDataStream::Ok || blockSize > MAX_BLOCK_SIZE) {
+                return fail(error, "Повреждён файл " + name);
+            }
+            if (blockSize == 0) {
+                break;
+            }
+            QByteArray block(int(blockSize), Qt::Uninitialized);
+            if (stream.readRawData(block.data(), int(blockSize)) != int(blockSize)) {
+                return fail(error, "Повреждён файл " + name);
+            }
+            // qUncompress проверяет контрольную сумму zlib
+            QByteArray chunk = compressed ? qUncompress(block) : block;
+            if (chunk.isEmpty() || out.write(chunk) != chunk.size()) {
+                return fail(error, "Повреждён файл " + name);
+            }
+            written += chunk.size();
+            done += chunk.size();
+            if (progress) {
+                progress(done, total);
+            }
+        }
+        out.close();
+        if (written != size) {
+            return fail(error, "Повреждён файл " + name);
+        }
+        names.append(name);
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef BACKUPARCHIVE_H
+#define BACKUPARCHIVE_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+// Резервная копия всех данных одним файлом (*.polbak): разделы задач и правила,
+// словарь, геймификация (снимок и журнал), база pol.sqlite (если данные в SQLite)
+// и изображения глав. Настройки и состояние синхронизации относятся к устройству и не переносятся.
+//
+// Формат (числа big-endian):
+//   "POLBAK01"
+//   файлы подряд: блоки [quint32 длина][данные], блок нулевой длины завершает файл;
+//                 данные — qCompress(≤ CHUNK_SIZE байт), у PNG — как есть
+//   индекс:       [quint32 длина][qCompress(JSON [{name, offset, size, chunks, compressed}])]
+//   хвост:        [quint64 смещение индекса]["POLINDEX"]
+// Запись и чтение потоковые: в памяти не больше одного блока. Вызывать из фонового
+// потока; progress зовётся из него же.
+class BackupArchive {
+public:
+    typedef std::function<void(qint64 done, qint64 total)> Progress;
+
+    static QStringList collectFiles(const QString& dataDir);   // пути относительно dataDir
+    static bool write(const QString& archivePath, const QString& dataDir,
+                      const Progress& progress, QString* error);
+    // Файлы сначала распаковываются во временный каталог и проверяются; текущие данные
+    // заменяются только после успешной распаковки всего архива
+    static bool restore(const QString& archivePath, const QString& dataDir,
+                        const Progress& progress, QString* error);
+
+private:
+    static const int CHUNK_SIZE = 256 * 1024;
+    static const int COMPRESSION_LEVEL = 1;     // JSON жмётся хорошо и на быстром уровне
+    static const quint32 MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+    static bool extract(const QString& archivePath, const QString& stagingDir,
+                        const Progress& progress, QStringList& names, QString* error);
+};
+
+#endif // BACKUPARCHIVE_H
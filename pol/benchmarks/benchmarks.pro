@@ -0,0 +1,12 @@
+# Бенчмарки хранилища и запросов. Собираются отдельно от приложения:
+#   qmake benchmarks.pro && make && ./core/bench_core
+# Отзывчивость интерфейса без экрана (платформа offscreen):
+#   ./gui/bench_gui
+# Годы использования в ускоренном времени (объём данных, открытие, память по контрольным точкам):
+#   ./simulator/simulator
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    core \
+    gui \
+    simulator
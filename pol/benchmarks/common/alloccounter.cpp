@@ -0,0 +1,72 @@
+#include "alloccounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<quint64> allocCount(0);
+static std::atomic<quint64> allocBytes(0);
+
+static inline void countAlloc(std::size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+
+void* malloc(std::size_t size) {
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) {
+    countAlloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* ptr, std::size_t size) {
+    countAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+}
+
+// operator new идёт через malloc и уже посчитан
+#else
+void* operator new(std::size_t size) {
+    countAlloc(size);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+#endif
+
+AllocStats AllocCounter::snapshot() {
+    AllocStats s;
+    s.count = allocCount.load(std::memory_order_relaxed);
+    s.bytes = allocBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool AllocCounter::coversMalloc() {
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,19 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <QtGlobal>
+
+// Счётчик выделений памяти в процессе бенчмарка. На glibc перехватываются
+// malloc/calloc/realloc (ими пользуются контейнеры Qt), иначе — только operator new.
+struct AllocStats {
+    quint64 count;
+    quint64 bytes;
+};
+
+class AllocCounter {
+public:
+    static AllocStats snapshot();
+    static bool coversMalloc();
+};
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,86 @@
+#include "benchreport.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QSysInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+BenchReport::BenchReport(const QString& suite)
+    : suite(suite) {
+}
+
+void BenchReport::add(const QString& name, qint64 records, qint64 wallNs, const AllocStats& allocs) {
+    QJsonObject o;
+    o["name"] = name;
+    o["records"] = records;
+    o["wall_ms"] = wallNs / 1e6;
+    o["allocations"] = static_cast<double>(allocs.count);
+    o["allocated_bytes"] = static_cast<double>(allocs.bytes);
+    results.append(o);
+}
+
+void BenchReport::addSamples(const QString& name, qint64 records, QVector<qint64> samplesNs) {
+    if (samplesNs.isEmpty()) {
+        return;
+    }
+    std::sort(samplesNs.begin(), samplesNs.end());
+    auto percentile = [&samplesNs](double p) {
+        int i = qBound(0, static_cast<int>(p * (samplesNs.size() - 1) + 0.5), samplesNs.size() - 1);
+        return samplesNs.at(i) / 1e6;
+    };
+    double total = 0;
+    for (qint64 ns : samplesNs) {
+        total += ns;
+    }
+
+    QJsonObject o;
+    o["name"] = name;
+    o["records"] = records;
+    o["samples"] = samplesNs.size();
+    o["mean_ms"] = total / samplesNs.size() / 1e6;
+    o["p50_ms"] = percentile(0.50);
+    o["p90_ms"] = percentile(0.90);
+    o["p99_ms"] = percentile(0.99);
+    o["max_ms"] = samplesNs.last() / 1e6;
+    results.append(o);
+
+    qInfo().noquote() << QString("%1: p50 %2 ms, p90 %3 ms, p99 %4 ms, max %5 ms (n=%6)")
+        .arg(name, -28)
+        .arg(o["p50_ms"].toDouble(), 0, 'f', 2)
+        .arg(o["p90_ms"].toDouble(), 0, 'f', 2)
+        .arg(o["p99_ms"].toDouble(), 0, 'f', 2)
+        .arg(o["max_ms"].toDouble(), 0, 'f', 2)
+        .arg(samplesNs.size());
+}
+
+bool BenchReport::write(const QString& path) const {
+    QJsonObject root;
+    root["suite"] = suite;
+    root["qt"] = QString(qVersion());
+    root["platform"] = QSysInfo::prettyProductName();
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["alloc_counter"] = AllocCounter::coversMalloc() ? "malloc" : "operator new";
+    root["results"] = results;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    return true;
+}
+
+BenchScope::BenchScope()
+    : start(AllocCounter::snapshot()) {
+    timer.start();
+}
+
+AllocStats BenchScope::allocs() const {
+    AllocStats now = AllocCounter::snapshot();
+    AllocStats d;
+    d.count = now.count - start.count;
+    d.bytes = now.bytes - start.bytes;
+    return d;
+}
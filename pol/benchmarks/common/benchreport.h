@@ -0,0 +1,37 @@
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include <QString>
+#include <QJsonArray>
+#include <QVector>
+#include <QElapsedTimer>
+#include "alloccounter.h"
+
+// Машиночитаемый отчёт: одна запись на замер (время, аллокации, объём)
+class BenchReport {
+public:
+    explicit BenchReport(const QString& suite);
+
+    void add(const QString& name, qint64 records, qint64 wallNs, const AllocStats& allocs);
+    // Серия замеров одного действия: перцентили задержки
+    void addSamples(const QString& name, qint64 records, QVector<qint64> samplesNs);
+    bool write(const QString& path) const;
+
+private:
+    QString suite;
+    QJsonArray results;
+};
+
+// Замер одного вызова: время по QElapsedTimer и разница счётчика аллокаций
+class BenchScope {
+public:
+    BenchScope();
+    qint64 elapsedNs() const { return timer.nsecsElapsed(); }
+    AllocStats allocs() const;
+
+private:
+    QElapsedTimer timer;
+    AllocStats start;
+};
+
+#endif // BENCHREPORT_H
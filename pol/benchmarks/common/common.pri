@@ -0,0 +1,17 @@
+# Общие части бенчмарков: исходники ядра приложения, генератор данных,
+# счётчик аллокаций и отчёт в JSON.
+POL_SRC = $$PWD/../..
+
+include($$POL_SRC/core/core.pri)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/syntheticdata.cpp \
+    $$PWD/alloccounter.cpp \
+    $$PWD/benchreport.cpp
+
+HEADERS += \
+    $$PWD/syntheticdata.h \
+    $$PWD/alloccounter.h \
+    $$PWD/benchreport.h
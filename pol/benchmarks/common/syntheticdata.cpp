@@ -0,0 +1,102 @@
+#include "syntheticdata.h"
+#include "englishdata.h"
+#include "storagebackend.h"
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const char* const CATEGORIES[] = {
+    "Английский", "Молитва", "Работа", "Дом", "Спорт", "Учёба", "Покупки", ""
+};
+
+QList<Task> SyntheticData::makeTasks(int count, quint32 seed) {
+    QRandomGenerator rng(seed);
+    QDate today = QDate::currentDate();
+    QList<Task> tasks;
+    tasks.reserve(count);
+    for (int i = 0; i < count; i++) {
+        QDate deadline = today.addDays(rng.bounded(-3 * 365, 90));
+        Task task(QString("Задача %1").arg(i),
+                  rng.bounded(4) == 0 ? QString() : QString("Описание задачи номер %1").arg(i),
+                  deadline,
+                  static_cast<Priority>(rng.bounded(3)),
+                  QString::fromUtf8(CATEGORIES[rng.bounded(8)]));
+        if (deadline <= today && rng.bounded(10) < 6) {
+            task.setStatus(TaskStatus::Completed);
+        }
+        tasks.append(task);
+    }
+    return tasks;
+}
+
+bool SyntheticData::writeVocabulary(const QString& path, int wordCount, quint32 seed) {
+    QRandomGenerator rng(seed);
+    QJsonObject root;
+    int perLesson = wordCount / EnglishData::LESSON_COUNT;
+    int extra = wordCount % EnglishData::LESSON_COUNT;
+    int n = 0;
+    for (int i = 0; i < EnglishData::LESSON_COUNT; i++) {
+        QJsonArray arr;
+        int words = perLesson + (i < extra ? 1 : 0);
+        for (int w = 0; w < words; w++, n++) {
+            QJsonObject o;
+            o["word"] = QString("word%1_%2").arg(n).arg(rng.generate() % 1000);
+            o["translation"] = QString("слово%1").arg(n);
+            arr.append(o);
+        }
+        root[EnglishData::levelName(i / EnglishData::LESSONS_PER_LEVEL) + "." +
+             QString::number(i % EnglishData::LESSONS_PER_LEVEL + 1)] = arr;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    return true;
+}
+
+bool SyntheticData::writeGameStats(int days, int events, quint32 seed) {
+    QRandomGenerator rng(seed);
+    StorageBackend* storage = StorageBackend::instance();
+    // ISO-даты Qt — только годы 0–9999: миллион дней начинается с первого года
+    QDate first = QDate::currentDate().addDays(1 - days);
+    if (first.year() < 1) {
+        first = QDate(1, 1, 1);
+    }
+    QJsonObject dayCounts;
+    for (int i = 0; i < days; i++) {
+        dayCounts[first.addDays(i).toString(Qt::ISODate)] = 1 + int(rng.bounded(3));
+    }
+    QJsonObject root;
+    root["version"] = 2;
+    root["baseXP"] = 0;
+    root["days"] = dayCounts;
+    root["ledgerOffset"] = double(storage->eventsEnd());
+    if (!storage->writeDocument("gamestats", QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        return false;
+    }
+    for (int i = 0; i < events; i++) {
+        QJsonObject event;
+        event["at"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        event["day"] = first.addDays(rng.bounded(days)).toString(Qt::ISODate);
+        event["task"] = QString::number(i + 1);
+        event["delta"] = rng.bounded(4) == 0 ? -1 : 1;
+        if (!storage->appendEvent(event)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QString SyntheticData::resetDataDir() {
+    QStandardPaths::setTestModeEnabled(true);
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(dir).removeRecursively();
+    QDir().mkpath(dir);
+    return dir;
+}
@@ -0,0 +1,25 @@
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include "task.h"
+#include <QList>
+#include <QString>
+
+// Детерминированные синтетические данные для бенчмарков
+class SyntheticData {
+public:
+    // Задачи со сроками от ~3 лет назад до ~3 месяцев вперёд, ~60% выполнены
+    static QList<Task> makeTasks(int count, quint32 seed = 42);
+
+    // english_vocabulary.json с wordCount словами, равномерно по урокам
+    static bool writeVocabulary(const QString& path, int wordCount, quint32 seed = 42);
+
+    // Геймификация в текущем хранилище: снимок с days днями подряд и events событиями
+    // журнала после него (их load проигрывает поверх снимка)
+    static bool writeGameStats(int days, int events, quint32 seed = 42);
+
+    // Чистый каталог AppData (в тестовом режиме QStandardPaths)
+    static QString resetDataDir();
+};
+
+#endif // SYNTHETICDATA_H
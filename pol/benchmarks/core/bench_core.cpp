@@ -0,0 +1,439 @@
+// Бенчмарки хранилища и запросов ядра на синтетических данных 1k / 100k / 1M.
+//
+//   ./bench_core                      — все замеры, отчёт в bench_core.json
+//   ./bench_core -o result.xml,xml    — плюс стандартный вывод QtTest (время)
+//   POL_BENCH_MAX_RECORDS=100000      — пропустить строки крупнее
+//   POL_BENCH_REPORT=path.json        — куда писать отчёт с аллокациями
+
+#include <QtTest>
+#include <functional>
+#include "taskmanager.h"
+#include "englishdata.h"
+#include "gamestats.h"
+#include "isodate.h"
+#include "syntheticdata.h"
+#include "benchreport.h"
+
+class CoreBenchmark : public QObject {
+    Q_OBJECT
+
+public:
+    CoreBenchmark();
+    ~CoreBenchmark();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void taskStoreWrite_data();
+    void taskStoreWrite();
+    void taskStoreOpen_data();
+    void taskStoreOpen();
+    void taskStoreLoadAll_data();
+    void taskStoreLoadAll();
+    void taskExport_data();
+    void taskExport();
+    void taskImport_data();
+    void taskImport();
+    void taskQueries_data();
+    void taskQueries();
+
+    void englishLoad_data();
+    void englishLoad();
+    void englishSave_data();
+    void englishSave();
+    void englishAddWord_data();
+    void englishAddWord();
+
+    void isoDateTimeParse_data();
+    void isoDateTimeParse();
+    void isoDateTimeFormat_data();
+    void isoDateTimeFormat();
+
+    void gameStatsLoad_data();
+    void gameStatsLoad();
+    void gameStatsSave_data();
+    void gameStatsSave();
+
+private:
+    BenchReport report;
+    TaskManager* manager;
+    int preparedRecords;
+    int maxRecords;
+
+    void addSizeRows();
+    bool tooLarge(int records) const { return records > maxRecords; }
+    void prepareTasks(int records);
+    void measure(int records, const std::function<void()>& op);
+    void addCodecRows();
+    static QList<QDateTime> makeTimestamps();
+};
+
+static const int SIZES[] = { 1000, 100000, 1000000 };
+static const char* const SIZE_TAGS[] = { "1k", "100k", "1M" };
+
+static volatile int sink = 0;   // чтобы результаты запросов не выбрасывались оптимизатором
+
+CoreBenchmark::CoreBenchmark()
+    : report("core"), manager(nullptr), preparedRecords(-1), maxRecords(SIZES[2]) {
+}
+
+CoreBenchmark::~CoreBenchmark() {
+    delete manager;
+}
+
+void CoreBenchmark::initTestCase() {
+    bool ok = false;
+    int limit = qEnvironmentVariableIntValue("POL_BENCH_MAX_RECORDS", &ok);
+    if (ok && limit > 0) {
+        maxRecords = limit;
+    }
+    SyntheticData::resetDataDir();
+}
+
+void CoreBenchmark::cleanupTestCase() {
+    delete manager;
+    manager = nullptr;
+    QString path = qEnvironmentVariable("POL_BENCH_REPORT", "bench_core.json");
+    QVERIFY2(report.write(path), qPrintable("Не удалось записать " + path));
+    SyntheticData::resetDataDir();
+}
+
+void CoreBenchmark::addSizeRows() {
+    QTest::addColumn<int>("records");
+    for (int i = 0; i < 3; i++) {
+        QTest::newRow(SIZE_TAGS[i]) << SIZES[i];
+    }
+}
+
+void CoreBenchmark::prepareTasks(int records) {
+    if (manager && preparedRecords == records) {
+        return;
+    }
+    delete manager;
+    SyntheticData::resetDataDir();
+    QList<Task> data = SyntheticData::makeTasks(records);
+    manager = new TaskManager();
+    TaskManager::Batch batch(manager);
+    for (const Task& task : data) {
+        manager->addTask(task);
+    }
+    preparedRecords = records;
+}
+
+void CoreBenchmark::measure(int records, const std::function<void()>& op) {
+    BenchScope scope;
+    op();
+    qint64 ns = scope.elapsedNs();
+    QString name = QString("%1/%2").arg(QTest::currentTestFunction()).arg(QTest::currentDataTag());
+    report.add(name, records, ns, scope.allocs());
+    QTest::setBenchmarkResult(ns / 1e6, QTest::WalltimeMilliseconds);
+}
+
+// --- Задачи: хранилище ---
+
+void CoreBenchmark::taskStoreWrite_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::taskStoreWrite() {
+    // Пакетная вставка всех задач и одно сохранение разделов
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    delete manager;
+    manager = nullptr;
+    SyntheticData::resetDataDir();
+    QList<Task> data = SyntheticData::makeTasks(records);
+    TaskManager* m = new TaskManager();
+    measure(records, [m, &data]() {
+        TaskManager::Batch batch(m);
+        for (const Task& task : data) {
+            m->addTask(task);
+        }
+    });
+    manager = m;
+    preparedRecords = records;
+}
+
+void CoreBenchmark::taskStoreOpen_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::taskStoreOpen() {
+    // Запуск: чтение только текущих разделов
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    prepareTasks(records);
+    delete manager;
+    manager = nullptr;
+    TaskManager* m = nullptr;
+    measure(records, [&m]() {
+        m = new TaskManager();
+    });
+    manager = m;
+}
+
+void CoreBenchmark::taskStoreLoadAll_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::taskStoreLoadAll() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    prepareTasks(records);
+    manager->evictIdlePartitions(0);
+    TaskManager* m = manager;
+    measure(records, [m]() {
+        sink += m->getAllTasks().size();
+    });
+}
+
+void CoreBenchmark::taskExport_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::taskExport() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    prepareTasks(records);
+    QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/export.json";
+    TaskManager* m = manager;
+    measure(records, [m, path]() {
+        m->saveToFile(path);
+    });
+}
+
+void CoreBenchmark::taskImport_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::taskImport() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    prepareTasks(records);
+    QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/export.json";
+    QVERIFY(manager->saveToFile(path));
+    TaskManager* m = manager;
+    measure(records, [m, path]() {
+        m->loadFromFile(path);
+    });
+}
+
+// --- Задачи: фильтры и статистика ---
+
+void CoreBenchmark::taskQueries_data() {
+    QTest::addColumn<int>("records");
+    QTest::addColumn<QString>("query");
+    const char* const queries[] = {
+        "getTasksByStatus", "getTasksByPriority", "getTasksByCategory",
+        "getOverdueTasks", "getTodayTasks", "getWeekTasks", "getTasksForDate",
+        "getCategories", "getCompletedTodayCount", "getCompletedThisWeekCount",
+        "getDailyCompletionStats", "getCategoryStats", "getPriorityStats"
+    };
+    for (int i = 0; i < 3; i++) {
+        for (const char* q : queries) {
+            QTest::newRow(qPrintable(QString("%1/%2").arg(q).arg(SIZE_TAGS[i]))) << SIZES[i] << QString(q);
+        }
+    }
+}
+
+void CoreBenchmark::taskQueries() {
+    QFETCH(int, records);
+    QFETCH(QString, query);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    prepareTasks(records);
+
+    TaskManager* m = manager;
+    QDate today = QDate::currentDate();
+    QHash<QString, std::function<void()>> ops;
+    ops["getTasksByStatus"] = [m]() { sink += m->getTasksByStatus(TaskStatus::Pending).size(); };
+    ops["getTasksByPriority"] = [m]() { sink += m->getTasksByPriority(Priority::High).size(); };
+    ops["getTasksByCategory"] = [m]() { sink += m->getTasksByCategory("Работа").size(); };
+    ops["getOverdueTasks"] = [m]() { sink += m->getOverdueTasks().size(); };
+    ops["getTodayTasks"] = [m]() { sink += m->getTodayTasks().size(); };
+    ops["getWeekTasks"] = [m]() { sink += m->getWeekTasks().size(); };
+    ops["getTasksForDate"] = [m, today]() { sink += m->getTasksForDate(today.addDays(-400)).size(); };
+    ops["getCategories"] = [m]() { sink += m->getCategories().size(); };
+    ops["getCompletedTodayCount"] = [m]() { sink += m->getCompletedTodayCount(); };
+    ops["getCompletedThisWeekCount"] = [m]() { sink += m->getCompletedThisWeekCount(); };
+    ops["getDailyCompletionStats"] = [m]() { sink += m->getDailyCompletionStats(30).size(); };
+    ops["getCategoryStats"] = [m]() { sink += m->getCategoryStats().size(); };
+    ops["getPriorityStats"] = [m]() { sink += m->getPriorityStats().size(); };
+    QVERIFY(ops.contains(query));
+    measure(records, ops.value(query));
+}
+
+// --- Словарь английского ---
+
+void CoreBenchmark::englishLoad_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::englishLoad() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    QString dir = SyntheticData::resetDataDir();
+    QVERIFY(SyntheticData::writeVocabulary(dir + "/english_vocabulary.json", records));
+    EnglishData data;
+    measure(records, [&data]() {
+        data.load();
+    });
+}
+
+void CoreBenchmark::englishSave_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::englishSave() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    QString dir = SyntheticData::resetDataDir();
+    QVERIFY(SyntheticData::writeVocabulary(dir + "/english_vocabulary.json", records));
+    EnglishData data;
+    data.load();
+    measure(records, [&data]() {
+        data.save();
+    });
+}
+
+void CoreBenchmark::englishAddWord_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::englishAddWord() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    QString dir = SyntheticData::resetDataDir();
+    QVERIFY(SyntheticData::writeVocabulary(dir + "/english_vocabulary.json", records));
+    EnglishData data;
+    data.load();
+    measure(records, [&data]() {
+        data.addWord(0, "benchmark", "замер");
+    });
+}
+
+// --- Даты ISO-8601: Qt против IsoDate на 1M меток ---
+
+static const int TIMESTAMPS = 1000000;
+
+void CoreBenchmark::addCodecRows() {
+    QTest::addColumn<bool>("fast");
+    QTest::newRow("qt") << false;
+    QTest::newRow("isodate") << true;
+}
+
+QList<QDateTime> CoreBenchmark::makeTimestamps() {
+    // Метки с шагом чуть больше часа — разные дни, месяцы и годы, как createdAt задач
+    QList<QDateTime> stamps;
+    stamps.reserve(TIMESTAMPS);
+    QDateTime start(QDate(2015, 1, 1), QTime(0, 0));
+    for (int i = 0; i < TIMESTAMPS; i++) {
+        stamps.append(start.addSecs(qint64(i) * 3671));
+    }
+    return stamps;
+}
+
+void CoreBenchmark::isoDateTimeParse_data() {
+    addCodecRows();
+}
+
+void CoreBenchmark::isoDateTimeParse() {
+    QFETCH(bool, fast);
+    QStringList texts;
+    texts.reserve(TIMESTAMPS);
+    for (const QDateTime& stamp : makeTimestamps()) {
+        texts.append(stamp.toString(Qt::ISODate));
+    }
+    // Каждая метка сверяется с Qt один раз, вне замера
+    if (fast) {
+        for (const QString& text : texts) {
+            QCOMPARE(IsoDate::parseDateTime(text), QDateTime::fromString(text, Qt::ISODate));
+        }
+    }
+    measure(TIMESTAMPS, [&texts, fast]() {
+        for (const QString& text : texts) {
+            sink += (fast ? IsoDate::parseDateTime(text) : QDateTime::fromString(text, Qt::ISODate)).date().day();
+        }
+    });
+}
+
+void CoreBenchmark::isoDateTimeFormat_data() {
+    addCodecRows();
+}
+
+void CoreBenchmark::isoDateTimeFormat() {
+    QFETCH(bool, fast);
+    QList<QDateTime> stamps = makeTimestamps();
+    if (fast) {
+        for (const QDateTime& stamp : stamps) {
+            QCOMPARE(IsoDate::formatDateTime(stamp), stamp.toString(Qt::ISODate));
+        }
+    }
+    measure(TIMESTAMPS, [&stamps, fast]() {
+        for (const QDateTime& stamp : stamps) {
+            sink += (fast ? IsoDate::formatDateTime(stamp) : stamp.toString(Qt::ISODate)).size();
+        }
+    });
+}
+
+// --- Геймификация ---
+
+// records — дней в снимке и столько же событий журнала после него
+
+void CoreBenchmark::gameStatsLoad_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::gameStatsLoad() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    SyntheticData::resetDataDir();
+    QVERIFY(SyntheticData::writeGameStats(records, records));
+    GameStats stats;
+    measure(records, [&stats]() {
+        stats.load();
+    });
+    QVERIFY(stats.getXP() > 0);
+}
+
+void CoreBenchmark::gameStatsSave_data() {
+    addSizeRows();
+}
+
+void CoreBenchmark::gameStatsSave() {
+    QFETCH(int, records);
+    if (tooLarge(records)) {
+        QSKIP("Больше POL_BENCH_MAX_RECORDS");
+    }
+    SyntheticData::resetDataDir();
+    QVERIFY(SyntheticData::writeGameStats(records, records));
+    GameStats stats;
+    stats.load();
+    measure(records, [&stats]() {
+        stats.save();
+    });
+}
+
+QTEST_GUILESS_MAIN(CoreBenchmark)
+
+#include "bench_core.moc"
@@ -0,0 +1,12 @@
+QT += core testlib
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_core
+
+include(../common/common.pri)
+
+SOURCES += \
+    bench_core.cpp
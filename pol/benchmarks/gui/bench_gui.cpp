@@ -0,0 +1,190 @@
+// Задержки интерфейса MainWindow на больших данных без экрана (QPA offscreen).
+// Сценарий: запуск до первого кадра, первое открытие вкладок, смена даты, отметка задачи, смена урока и уровня английского,
+// смена Евангелия, открытие диалога задачи. Для каждого действия — перцентили.
+//
+//   POL_BENCH_TASKS=100000        — число задач (по умолчанию 100000)
+//   POL_BENCH_WORDS=100000        — число слов в словаре
+//   POL_BENCH_ITERATIONS=200      — повторов каждого действия
+//   POL_BENCH_REPORT=bench_gui.json
+
+#include <QApplication>
+#include <QDateEdit>
+#include <QTableWidget>
+#include <QListWidget>
+#include <QComboBox>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QDialog>
+#include <QTimer>
+#include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <functional>
+#include "mainwindow.h"
+#include "theme.h"
+#include "syntheticdata.h"
+#include "benchreport.h"
+
+static int envInt(const char* name, int defaultValue) {
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+// Время действия вместе с обработкой накопившихся событий (раскладка, перерисовка)
+static qint64 timeInteraction(const std::function<void()>& action) {
+    QElapsedTimer timer;
+    timer.start();
+    action();
+    QCoreApplication::processEvents();
+    return timer.nsecsElapsed();
+}
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    Theme::apply(app);
+
+    const int taskCount = envInt("POL_BENCH_TASKS", 100000);
+    const int wordCount = envInt("POL_BENCH_WORDS", 100000);
+    const int iterations = envInt("POL_BENCH_ITERATIONS", 200);
+
+    // Данные
+    QString dir = SyntheticData::resetDataDir();
+    {
+        TaskManager seed;
+        TaskManager::Batch batch(&seed);
+        for (const Task& task : SyntheticData::makeTasks(taskCount)) {
+            seed.addTask(task);
+        }
+    }
+    if (!SyntheticData::writeVocabulary(dir + "/english_vocabulary.json", wordCount)) {
+        qCritical() << "Не удалось записать словарь в" << dir;
+        return 1;
+    }
+
+    BenchReport report("gui");
+    QRandomGenerator rng(7);
+
+    MainWindow* window = nullptr;
+    QVector<qint64> startup;
+    startup.append(timeInteraction([&window]() {
+        window = new MainWindow();
+        window->show();
+    }));
+    report.addSamples("startupToFirstFrame", taskCount, startup);
+    while (window->timeToFirstFrame() < 0) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    report.addSamples("timeToFirstFrame", taskCount, QVector<qint64>() << window->timeToFirstFrame() * 1000000);
+
+    // Вкладки «Английский» и «Молитва» строятся при первом открытии
+    QTabWidget* tabs = window->findChild<QTabWidget*>("tabWidget");
+    if (!tabs) {
+        qCritical() << "Не найдены вкладки MainWindow";
+        return 1;
+    }
+    for (int tab = 1; tab < tabs->count(); tab++) {
+        QVector<qint64> firstOpen;
+        firstOpen.append(timeInteraction([tabs, tab]() {
+            tabs->setCurrentIndex(tab);
+        }));
+        report.addSamples(QString("tabFirstOpen/%1").arg(tab), 0, firstOpen);
+    }
+    tabs->setCurrentIndex(0);
+
+    QDateEdit* dateSelector = window->findChild<QDateEdit*>("dateSelector");
+    QTableWidget* tasksTable = window->findChild<QTableWidget*>("tasksTable");
+    QPushButton* addButton = window->findChild<QPushButton*>("addButton");
+    QComboBox* levelCombo = window->findChild<QComboBox*>("englishLevelCombo");
+    QListWidget* lessonList = window->findChild<QListWidget*>("englishLessonList");
+    QComboBox* gospelCombo = window->findChild<QComboBox*>("prayerGospelCombo");
+    if (!dateSelector || !tasksTable || !addButton || !levelCombo || !lessonList || !gospelCombo) {
+        qCritical() << "Не найдены виджеты MainWindow";
+        return 1;
+    }
+
+    QDate today = QDate::currentDate();
+    QVector<qint64> samples;
+
+    // Смена даты: ближние дни и старые месяцы (подгрузка разделов)
+    for (int i = 0; i < iterations; i++) {
+        QDate date = today.addDays(i % 4 == 0 ? rng.bounded(-900, -60) : rng.bounded(-30, 30));
+        samples.append(timeInteraction([dateSelector, date]() {
+            dateSelector->setDate(date);
+        }));
+    }
+    report.addSamples("dateChange/updateDailyTasks", taskCount, samples);
+    samples.clear();
+
+    // Отметка выполнения (сохранение, пересчёт геймификации, перерисовка дня)
+    dateSelector->setDate(today);
+    for (int i = 0; i < iterations; i++) {
+        if (tasksTable->rowCount() == 0) {
+            break;
+        }
+        int row = rng.bounded(tasksTable->rowCount());
+        QTableWidgetItem* item = tasksTable->item(row, 0);
+        Qt::CheckState next = item->checkState() == Qt::Checked ? Qt::Unchecked : Qt::Checked;
+        samples.append(timeInteraction([item, next]() {
+            item->setCheckState(next);
+        }));
+    }
+    report.addSamples("checkboxToggle", taskCount, samples);
+    samples.clear();
+
+    // Английский: смена урока заполняет englishWordsTable
+    for (int i = 0; i < iterations; i++) {
+        int row = rng.bounded(lessonList->count());
+        samples.append(timeInteraction([lessonList, row]() {
+            lessonList->setCurrentRow(row);
+        }));
+    }
+    report.addSamples("englishLessonSelected", wordCount, samples);
+    samples.clear();
+
+    for (int i = 0; i < iterations; i++) {
+        int level = (levelCombo->currentIndex() + 1) % levelCombo->count();
+        samples.append(timeInteraction([levelCombo, level]() {
+            levelCombo->setCurrentIndex(level);
+        }));
+    }
+    report.addSamples("englishLevelChanged", wordCount, samples);
+    samples.clear();
+
+    // Молитва: смена Евангелия перезаполняет prayerChapterList
+    for (int i = 0; i < iterations; i++) {
+        int gospel = (gospelCombo->currentIndex() + 1) % gospelCombo->count();
+        samples.append(timeInteraction([gospelCombo, gospel]() {
+            gospelCombo->setCurrentIndex(gospel);
+        }));
+    }
+    report.addSamples("prayerGospelChanged", 0, samples);
+    samples.clear();
+
+    // Диалог задачи: от нажатия до показа (закрываем из цикла событий диалога)
+    for (int i = 0; i < iterations; i++) {
+        QElapsedTimer timer;
+        QTimer::singleShot(0, window, [window, &timer, &samples]() {
+            samples.append(timer.nsecsElapsed());
+            if (QDialog* dialog = window->findChild<QDialog*>()) {
+                dialog->reject();
+            }
+        });
+        timer.start();
+        addButton->click();
+    }
+    report.addSamples("showTaskDialog", 0, samples);
+
+    delete window;
+
+    QString path = qEnvironmentVariable("POL_BENCH_REPORT", "bench_gui.json");
+    if (!report.write(path)) {
+        qCritical() << "Не удалось записать" << path;
+        return 1;
+    }
+    SyntheticData::resetDataDir();
+    return 0;
+}
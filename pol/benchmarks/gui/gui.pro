@@ -0,0 +1,37 @@
+QT += core gui widgets concurrent network
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench_gui
+
+include(../common/common.pri)
+
+SOURCES += \
+    $$POL_SRC/mainwindow.cpp \
+    $$POL_SRC/reminderscheduler.cpp \
+    $$POL_SRC/theme.cpp \
+    $$POL_SRC/taskdialog.cpp \
+    $$POL_SRC/syncprotocol.cpp \
+    $$POL_SRC/syncengine.cpp \
+    $$POL_SRC/storewatcher.cpp \
+    $$POL_SRC/backuparchive.cpp \
+    $$POL_SRC/memorybudget.cpp \
+    $$POL_SRC/heatmapwidget.cpp \
+    $$POL_SRC/agendamodel.cpp \
+    $$POL_SRC/agendaview.cpp \
+    bench_gui.cpp
+
+HEADERS += \
+    $$POL_SRC/mainwindow.h \
+    $$POL_SRC/reminderscheduler.h \
+    $$POL_SRC/theme.h \
+    $$POL_SRC/taskdialog.h \
+    $$POL_SRC/syncprotocol.h \
+    $$POL_SRC/syncengine.h \
+    $$POL_SRC/storewatcher.h \
+    $$POL_SRC/backuparchive.h \
+    $$POL_SRC/memorybudget.h \
+    $$POL_SRC/heatmapwidget.h \
+    $$POL_SRC/agendamodel.h \
+    $$POL_SRC/agendaview.h
@@ -0,0 +1,360 @@
+// Многолетнее использование приложения в ускоренном времени. Часы ядра (Clock)
+// зафиксированы и сдвигаются по дням; каждый день по seed разыгрываются привычки
+// (правила повторения), разовые задачи, отметки и новые слова. В контрольных точках —
+// объём данных на диске, холодное открытие и чтение, память. Один seed — один и тот же прогон.
+//
+//   POL_SIM_YEARS=5               — сколько лет моделировать
+//   POL_SIM_SEED=42
+//   POL_SIM_CHECKPOINT_DAYS=30    — шаг контрольных точек
+//   POL_SIM_STORAGE=json|sqlite   — хранилище
+//   POL_SIM_REPORT=simulator.json
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+#include "taskmanager.h"
+#include "englishdata.h"
+#include "gamestats.h"
+#include "storagebackend.h"
+#include "appsettings.h"
+#include "clock.h"
+#include "syntheticdata.h"
+
+static int envInt(const char* name, int defaultValue) {
+    bool ok = false;
+    int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+static const char* const CATEGORIES[] = { "Работа", "Дом", "Учёба", "Покупки", "" };
+
+// Привычка: правило повторения и вероятность отметить вхождение в день, когда оно есть
+struct Habit {
+    int ruleId;
+    int percent;
+};
+
+class Simulator {
+public:
+    Simulator(quint32 seed, const QString& dataDir);
+    ~Simulator();
+
+    void simulateDay(const QDate& date);
+    QJsonObject checkpoint(const QDate& date);
+
+private:
+    QRandomGenerator rng;
+    QString dataDir;
+    TaskManager* manager;
+    EnglishData* english;
+    GameStats* stats;
+    QList<Habit> habits;
+    QVector<qint64> dayNs;     // длительность дней с прошлой контрольной точки
+    int wordsAdded;
+    int tasksAdded;
+    int completions;
+
+    void open();
+    void close();
+    void setTime(const QDate& date, int fromHour, int toHour);
+    void complete(TaskId taskId, const QDate& date);
+};
+
+Simulator::Simulator(quint32 seed, const QString& dataDir)
+    : rng(seed), dataDir(dataDir), manager(nullptr), english(nullptr), stats(nullptr),
+      wordsAdded(0), tasksAdded(0), completions(0) {
+}
+
+Simulator::~Simulator() {
+    close();
+}
+
+void Simulator::open() {
+    manager = new TaskManager();
+    english = new EnglishData();
+    english->load();
+    stats = new GameStats();
+    stats->load();
+}
+
+void Simulator::close() {
+    delete manager;
+    delete english;
+    delete stats;
+    manager = nullptr;
+    english = nullptr;
+    stats = nullptr;
+    StorageBackend::shutdown();
+}
+
+void Simulator::setTime(const QDate& date, int fromHour, int toHour) {
+    int minute = rng.bounded(fromHour * 60, toHour * 60);
+    Clock::setFixed(QDateTime(date, QTime(minute / 60, minute % 60, rng.bounded(60))));
+}
+
+void Simulator::complete(TaskId taskId, const QDate& date) {
+    Task* task = manager->getTask(taskId);
+    if (!task || task->getStatus() == TaskStatus::Completed) {
+        return;
+    }
+    Task updated = *task;
+    updated.setStatus(TaskStatus::Completed);
+    manager->updateTask(updated);
+    stats->addTaskCompleted(taskId, date);
+    completions++;
+}
+
+void Simulator::simulateDay(const QDate& date) {
+    QElapsedTimer timer;
+    timer.start();
+    setTime(date, 7, 9);
+    if (!manager) {
+        open();
+        // Привычки первого дня: английский и молитва ежедневно — правила, которые пустое
+        // хранилище получает при первой загрузке; спорт пн/ср/пт заводит сам пользователь
+        int englishRule = 0;
+        int prayerRule = 0;
+        for (const RecurrenceRule& rule : manager->getRules()) {
+            QString category = rule.getPrototype().getCategory();
+            if (category == "Английский" && englishRule == 0) {
+                englishRule = rule.getId();
+            } else if (category == "Молитва" && prayerRule == 0) {
+                prayerRule = rule.getId();
+            }
+        }
+        if (englishRule == 0) {
+            englishRule = manager->addRule(RecurrenceRule(
+                Task("Английский", QString(), date, Priority::Medium, "Английский"), RecurrenceKind::Daily, date));
+        }
+        if (prayerRule == 0) {
+            prayerRule = manager->addRule(RecurrenceRule(
+                Task("Молитва", QString(), date, Priority::High, "Молитва"), RecurrenceKind::Daily, date));
+        }
+        RecurrenceRule sport(Task("Спорт", QString(), date, Priority::Low, "Спорт"),
+                             RecurrenceKind::Weekly, date);
+        sport.setWeekdays(0x15);
+        habits.append({ englishRule, 85 });
+        habits.append({ prayerRule, 90 });
+        habits.append({ manager->addRule(sport), 60 });
+    }
+    manager->checkDay();
+    stats->checkStreak(date);
+
+    // Утро: новые разовые задачи на ближайшие две недели
+    {
+        TaskManager::Batch batch(manager);
+        int added = rng.bounded(4);
+        for (int i = 0; i < added; i++) {
+            Task task(QString("Задача %1").arg(tasksAdded),
+                      rng.bounded(3) == 0 ? QString("Описание задачи %1").arg(tasksAdded) : QString(),
+                      date.addDays(rng.bounded(15)),
+                      static_cast<Priority>(rng.bounded(3)),
+                      QString::fromUtf8(CATEGORIES[rng.bounded(5)]));
+            manager->addTask(task);
+            tasksAdded++;
+        }
+    }
+
+    // День: слова в текущий урок — примерно по уроку за три недели
+    if (rng.bounded(10) < 6) {
+        setTime(date, 12, 14);
+        int lesson = qMin(wordsAdded / 60, EnglishData::LESSON_COUNT - 1);
+        int words = rng.bounded(1, 6);
+        for (int i = 0; i < words; i++) {
+            english->addWord(lesson, QString("word%1").arg(wordsAdded), QString("слово%1").arg(wordsAdded));
+            wordsAdded++;
+        }
+    }
+
+    // Вечер: отметки привычек, половины задач на сегодня и части просроченных
+    setTime(date, 19, 23);
+    {
+        TaskManager::Batch batch(manager);
+        QList<RecurrenceRule> rules = manager->getRules();
+        for (const Habit& habit : habits) {
+            for (const RecurrenceRule& rule : rules) {
+                if (rule.getId() == habit.ruleId && rule.occursOn(date) && rng.bounded(100) < habit.percent) {
+                    complete(manager->materializeOccurrence(habit.ruleId, date), date);
+                }
+            }
+        }
+        for (const Task& task : manager->getTodayTasks()) {
+            if (task.getId() != 0 && rng.bounded(2) == 0) {
+                complete(task.getId(), date);
+            }
+        }
+        for (const Task& task : manager->getOverdueTasks()) {
+            if (task.getId() != 0 && rng.bounded(10) == 0) {
+                complete(task.getId(), date);
+            }
+        }
+    }
+    // По воскресеньям иногда переносит оставшиеся просроченные на завтра
+    if (date.dayOfWeek() == 7 && rng.bounded(10) < 3) {
+        manager->rescheduleOverdueTasks(date.addDays(1));
+    }
+    dayNs.append(timer.nsecsElapsed());
+}
+
+// Объём папки данных: всего и по верхнему уровню (разделы задач, база, документы)
+static QJsonObject diskUsage(const QString& dir, qint64& total, int& files) {
+    QJsonObject entries;
+    total = 0;
+    files = 0;
+    QDirIterator it(dir, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        qint64 size = it.fileInfo().size();
+        QString top = it.filePath().mid(dir.size() + 1).section('/', 0, 0);
+        entries[top] = entries[top].toDouble() + size;
+        total += size;
+        files++;
+    }
+    return entries;
+}
+
+// Резидентная память процесса (Linux), -1 — нет данных
+static qint64 residentSetBytes() {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+    for (QByteArray line = status.readLine(); !line.isEmpty(); line = status.readLine()) {
+        if (line.startsWith("VmRSS:")) {
+            return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+        }
+    }
+    return -1;
+}
+
+static double msSince(const QElapsedTimer& timer) {
+    return timer.nsecsElapsed() / 1e6;
+}
+
+QJsonObject Simulator::checkpoint(const QDate& date) {
+    QJsonObject o;
+    o["date"] = date.toString(Qt::ISODate);
+    o["tasks_added"] = tasksAdded;
+    o["completions"] = completions;
+    o["words"] = wordsAdded;
+    o["xp"] = stats->getXP();
+
+    std::sort(dayNs.begin(), dayNs.end());
+    if (!dayNs.isEmpty()) {
+        o["day_p50_ms"] = dayNs.at(dayNs.size() / 2) / 1e6;
+        o["day_max_ms"] = dayNs.last() / 1e6;
+    }
+    dayNs.clear();
+
+    // Холодное открытие как при запуске: хранилище закрыто, всё читается заново
+    close();
+    qint64 total;
+    int files;
+    o["files_by_entry"] = diskUsage(dataDir, total, files);
+    o["data_bytes"] = static_cast<double>(total);
+    o["files"] = files;
+
+    QElapsedTimer timer;
+    timer.start();
+    manager = new TaskManager();
+    o["task_open_ms"] = msSince(timer);
+    o["task_resident_bytes"] = static_cast<double>(manager->residentBytes());
+
+    timer.restart();
+    english = new EnglishData();
+    english->load();
+    o["english_load_ms"] = msSince(timer);
+    o["english_resident_bytes"] = static_cast<double>(english->residentBytes());
+
+    timer.restart();
+    stats = new GameStats();
+    stats->load();
+    o["stats_load_ms"] = msSince(timer);
+    o["rss_bytes"] = static_cast<double>(residentSetBytes());
+
+    timer.restart();
+    int all = manager->getAllTasks().size();
+    o["task_load_all_ms"] = msSince(timer);
+    o["task_count"] = all;
+    o["task_all_resident_bytes"] = static_cast<double>(manager->residentBytes());
+
+    timer.restart();
+    manager->getDailyCompletionStats(365);
+    o["stats_year_ms"] = msSince(timer);
+
+    timer.restart();
+    stats->save();
+    o["stats_save_ms"] = msSince(timer);
+
+    timer.restart();
+    english->save();
+    o["english_save_ms"] = msSince(timer);
+
+    manager->evictIdlePartitions(0);
+
+    qInfo().noquote() << QString("%1: %2 задач, %3 слов, %4 КБ на диске, открытие %5 ms, всё %6 ms")
+        .arg(o["date"].toString())
+        .arg(all)
+        .arg(wordsAdded)
+        .arg(total / 1024)
+        .arg(o["task_open_ms"].toDouble(), 0, 'f', 1)
+        .arg(o["task_load_all_ms"].toDouble(), 0, 'f', 1);
+    return o;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    int years = envInt("POL_SIM_YEARS", 5);
+    quint32 seed = static_cast<quint32>(envInt("POL_SIM_SEED", 42));
+    int checkpointDays = envInt("POL_SIM_CHECKPOINT_DAYS", 30);
+    QString storage = qEnvironmentVariable("POL_SIM_STORAGE", "json");
+    QString reportPath = qEnvironmentVariable("POL_SIM_REPORT", "simulator.json");
+
+    QString dataDir = SyntheticData::resetDataDir();
+    StorageBackend::Kind kind = storage == "sqlite" ? StorageBackend::Sqlite : StorageBackend::Json;
+    AppSettings::setValue("storage/backend", StorageBackend::kindName(kind));
+    StorageBackend::setActiveKind(kind);
+
+    // Начало фиксировано, чтобы дни недели и месяцы совпадали между прогонами
+    QDate start(2024, 1, 1);
+    QDate end = start.addYears(years);
+    QJsonArray checkpoints;
+    {
+        Simulator simulator(seed, dataDir);
+        int day = 0;
+        for (QDate date = start; date < end; date = date.addDays(1), day++) {
+            simulator.simulateDay(date);
+            if ((day + 1) % checkpointDays == 0 || date.addDays(1) == end) {
+                QJsonObject o = simulator.checkpoint(date);
+                o["day"] = day + 1;
+                checkpoints.append(o);
+            }
+        }
+    }
+    Clock::setFixed(QDateTime());
+
+    QJsonObject root;
+    root["suite"] = "simulator";
+    root["qt"] = QString(qVersion());
+    root["seed"] = static_cast<double>(seed);
+    root["years"] = years;
+    root["storage"] = StorageBackend::kindName(kind);
+    root["checkpoints"] = checkpoints;
+    QFile file(reportPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Не удалось записать" << reportPath;
+        return 1;
+    }
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    SyntheticData::resetDataDir();
+    return 0;
+}
@@ -0,0 +1,24 @@
+# Утилита командной строки над данными приложения, без QApplication и виджетов:
+#   pol-cli add "Купить хлеб" --date 2026-10-20
+#   pol-cli list --from 2026-10-01 --to 2026-10-31 --json
+QT += core gui sql
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = pol-cli
+
+INCLUDEPATH += $$PWD/..
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lpolcore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lpolcore
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lpolcore
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libpolcore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libpolcore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/polcore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/polcore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../core/libpolcore.a
+
+SOURCES += \
+    main.cpp
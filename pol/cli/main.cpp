@@ -0,0 +1,312 @@
+#include "taskmanager.h"
+#include "taskranking.h"
+#include "gamestats.h"
+#include "storagebackend.h"
+#include "trace.h"
+#include "clock.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <cstdio>
+
+// Команды pol-cli. Вывод построчный и идёт в stdout по мере обхода задач;
+// ошибки — в stderr, код возврата 1 (2 — неверные аргументы).
+namespace {
+
+QTextStream out(stdout);
+QTextStream err(stderr);
+
+int usage(const QString& message) {
+    err << message << "\n";
+    err.flush();
+    return 2;
+}
+
+bool parseDate(const QString& text, QDate& date) {
+    if (text.isEmpty()) {
+        return true;
+    }
+    if (text == "today") {
+        date = Clock::currentDate();
+        return true;
+    }
+    date = QDate::fromString(text, Qt::ISODate);
+    return date.isValid();
+}
+
+bool parsePriority(const QString& text, Priority& priority) {
+    if (text.isEmpty() || text == "medium") {
+        priority = Priority::Medium;
+    } else if (text == "low") {
+        priority = Priority::Low;
+    } else if (text == "high") {
+        priority = Priority::High;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString priorityName(Priority priority) {
+    switch (priority) {
+        case Priority::Low: return "low";
+        case Priority::High: return "high";
+        default: return "medium";
+    }
+}
+
+// Аргументы команды или, если это "-", строки stdin
+QStringList argumentsOrStdin(const QStringList& args) {
+    if (args != QStringList() << "-") {
+        return args;
+    }
+    QStringList lines;
+    QTextStream in(stdin);
+    QString line;
+    while (in.readLineInto(&line)) {
+        if (!line.trimmed().isEmpty()) {
+            lines.append(line);
+        }
+    }
+    return lines;
+}
+
+void printTask(const Task& task, bool json) {
+    if (json) {
+        out << QJsonDocument(task.toJson()).toJson(QJsonDocument::Compact) << "\n";
+        return;
+    }
+    out << task.getId() << '\t'
+        << task.getDeadline().toString(Qt::ISODate) << '\t'
+        << (task.getStatus() == TaskStatus::Completed ? "x" : "-") << '\t'
+        << priorityName(task.getPriority()) << '\t'
+        << task.getCategory() << '\t'
+        << task.getTitle() << "\n";
+}
+
+// add НАЗВАНИЕ [--date --priority --category --description]
+// add - — по строке stdin: дата<TAB>название[<TAB>категория[<TAB>приоритет]]
+int commandAdd(TaskManager& manager, const QCommandLineParser& parser, const QStringList& args) {
+    if (args.isEmpty()) {
+        return usage("add: нужно название задачи или \"-\"");
+    }
+    bool fromStdin = args == QStringList() << "-";
+    QDate date = Clock::currentDate();
+    Priority priority;
+    if (!parseDate(parser.value("date"), date) || !parsePriority(parser.value("priority"), priority)) {
+        return usage("add: неверная дата или приоритет");
+    }
+
+    TaskManager::Batch batch(&manager);
+    if (!fromStdin) {
+        Task task(args.join(' '), parser.value("description"), date, priority, parser.value("category"));
+        out << manager.addTask(task) << "\n";
+        return 0;
+    }
+    int line = 0;
+    for (const QString& row : argumentsOrStdin(args)) {
+        line++;
+        QStringList fields = row.split('\t');
+        QDate rowDate;
+        Priority rowPriority = priority;
+        if (fields.size() < 2 || !parseDate(fields[0], rowDate)
+            || (fields.size() > 3 && !parsePriority(fields[3], rowPriority))) {
+            err << "add: строка " << line << " пропущена\n";
+            continue;
+        }
+        Task task(fields[1], QString(), rowDate.isValid() ? rowDate : date, rowPriority,
+                  fields.size() > 2 ? fields[2] : parser.value("category"));
+        out << manager.addTask(task) << "\n";
+    }
+    return 0;
+}
+
+// complete ID... [--undo]; complete - — id из stdin
+int commandComplete(TaskManager& manager, GameStats& stats, const QCommandLineParser& parser,
+                    const QStringList& args) {
+    if (args.isEmpty()) {
+        return usage("complete: нужны id задач или \"-\"");
+    }
+    TaskStatus status = parser.isSet("undo") ? TaskStatus::Pending : TaskStatus::Completed;
+    int failed = 0;
+    TaskManager::Batch batch(&manager);
+    for (const QString& arg : argumentsOrStdin(args)) {
+        bool ok = false;
+        TaskId taskId = arg.trimmed().toLongLong(&ok);
+        Task* task = ok ? manager.findTask(taskId) : nullptr;     // в том числе из невыгруженных месяцев
+        if (!task) {
+            err << "complete: нет задачи " << arg.trimmed() << "\n";
+            failed++;
+            continue;
+        }
+        if (task->getStatus() == status) {
+            continue;
+        }
+        // Геймификация — как при отметке в приложении
+        QDate completedDay = task->getCompletedAt().date();
+        Task updated = *task;
+        updated.setStatus(status);
+        manager.updateTask(updated);
+        if (status == TaskStatus::Completed) {
+            stats.addTaskCompleted(taskId);
+        } else if (completedDay.isValid()) {
+            stats.removeTaskCompleted(taskId, completedDay);
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+// list [--from --to --status --category --json]
+int commandList(TaskManager& manager, const QCommandLineParser& parser) {
+    QDate from;
+    QDate to;
+    if (!parseDate(parser.value("from"), from) || !parseDate(parser.value("to"), to)) {
+        return usage("list: неверная дата");
+    }
+    QString status = parser.value("status");
+    if (!status.isEmpty() && status != "pending" && status != "completed") {
+        return usage("list: --status pending или completed");
+    }
+    QString category = parser.value("category");
+    bool json = parser.isSet("json");
+
+    std::function<void(const Task&)> print = [&](const Task& task) {
+        if (!status.isEmpty() && (task.getStatus() == TaskStatus::Completed) != (status == "completed")) {
+            return;
+        }
+        if (!category.isEmpty() && task.getCategory() != category) {
+            return;
+        }
+        printTask(task, json);
+    };
+    if (from.isValid() || to.isValid()) {
+        // Диапазон — вместе с невыполненными вхождениями повторяющихся задач (id 0)
+        for (const Task& task : manager.getTasksInRange(from.isValid() ? from : QDate(1, 1, 1),
+                                                        to.isValid() ? to : QDate(9999, 12, 31))) {
+            print(task);
+        }
+    } else {
+        // Без диапазона — по разделам, не поднимая все задачи в память
+        manager.forEachTask(print);
+    }
+    return 0;
+}
+
+// next [--limit N] — первые места рейтинга «Что дальше»
+int commandNext(TaskManager& manager, const QCommandLineParser& parser) {
+    int limit = parser.value("limit").toInt();
+    if (limit <= 0) {
+        return usage("next: --limit — положительное число");
+    }
+    TaskRanking ranking(&manager);
+    ranking.rebuild();
+    for (TaskId taskId : ranking.top(limit)) {
+        const Task* task = manager.findTask(taskId);
+        if (task) {
+            printTask(*task, parser.isSet("json"));
+        }
+    }
+    return 0;
+}
+
+// stats [--days N]
+int commandStats(TaskManager& manager, GameStats& stats, const QCommandLineParser& parser) {
+    int days = parser.value("days").toInt();
+    if (days <= 0) {
+        return usage("stats: --days — положительное число");
+    }
+    out << "completed_today\t" << manager.getCompletedTodayCount() << "\n";
+    out << "completed_week\t" << manager.getCompletedThisWeekCount() << "\n";
+    out << "xp\t" << stats.getXP() << "\n";
+    out << "level\t" << stats.getLevel() << "\n";
+    out << "streak\t" << stats.getStreak() << "\n";
+    out << "best_streak\t" << stats.getBestStreak() << "\n";
+    QMap<QDate, int> perDay = manager.getDailyCompletionStats(days);
+    for (QMap<QDate, int>::const_iterator it = perDay.constBegin(); it != perDay.constEnd(); ++it) {
+        out << "day\t" << it.key().toString(Qt::ISODate) << '\t' << it.value() << "\n";
+    }
+    QMap<QString, int> categories = manager.getCategoryStats();
+    for (QMap<QString, int>::const_iterator it = categories.constBegin(); it != categories.constEnd(); ++it) {
+        out << "category\t" << it.key() << '\t' << it.value() << "\n";
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+   QCoreApplication a(argc, argv);
+   // Та же папка данных, что у приложения
+   QCoreApplication::setApplicationName("pol");
+   Trace::initFromEnvironment();
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription(
+       "Задачи, статистика и перенос данных без запуска интерфейса.\n"
+       "Команды:\n"
+       "  add НАЗВАНИЕ | -       добавить задачу (\"-\": строки stdin дата<TAB>название[<TAB>категория[<TAB>приоритет]])\n"
+       "  complete ID... | -     отметить выполненными (--undo — снять отметку)\n"
+       "  list                   задачи: id, срок, x/-, приоритет, категория, название\n"
+       "  next                   что делать дальше: невыполненные задачи по убыванию важности\n"
+       "  stats                  выполнено по дням и категориям, XP и серия\n"
+       "  export ФАЙЛ            все задачи одним JSON-файлом\n"
+       "  import ФАЙЛ            заменить задачи содержимым файла");
+   parser.addHelpOption();
+   parser.addPositionalArgument("command", "add, complete, list, next, stats, export или import.");
+   parser.addOptions({
+       {"date", "Срок новой задачи (yyyy-MM-dd или today).", "date"},
+       {"priority", "Приоритет: low, medium, high.", "priority", "medium"},
+       {"category", "Категория.", "category"},
+       {"description", "Описание новой задачи.", "text"},
+       {"from", "Начало диапазона сроков (list).", "date"},
+       {"to", "Конец диапазона сроков (list).", "date"},
+       {"status", "pending или completed (list).", "status"},
+       {"json", "Вывод задач по одной JSON-записи в строке (list, next)."},
+       {"limit", "Сколько задач показать (next).", "count", "5"},
+       {"days", "Сколько последних дней в статистике.", "days", "30"},
+       {"undo", "Снять отметку о выполнении (complete)."}
+   });
+   parser.process(a);
+
+   QStringList args = parser.positionalArguments();
+   if (args.isEmpty()) {
+       parser.showHelp(2);
+   }
+   QString command = args.takeFirst();
+
+   int result;
+   {
+       StorageBackend::instance();
+       TaskManager manager;
+       if (command == "add") {
+           result = commandAdd(manager, parser, args);
+       } else if (command == "complete") {
+           GameStats stats;
+           stats.load();
+           result = commandComplete(manager, stats, parser, args);
+       } else if (command == "list") {
+           result = commandList(manager, parser);
+       } else if (command == "next") {
+           result = commandNext(manager, parser);
+       } else if (command == "stats") {
+           GameStats stats;
+           stats.load();
+           stats.checkStreak(Clock::currentDate());
+           result = commandStats(manager, stats, parser);
+       } else if (command == "export" && args.size() == 1) {
+           result = manager.saveToFile(args.first()) ? 0 : 1;
+       } else if (command == "import" && args.size() == 1) {
+           result = manager.loadFromFile(args.first()) ? 0 : 1;
+       } else {
+           result = usage("Неизвестная команда: " + command + " (см. --help)");
+       }
+   }
+   out.flush();
+   err.flush();
+   StorageBackend::shutdown();
+   Trace::finish();
+   return result;
+}
@@ -0,0 +1,21 @@
+#include "clock.h"
+#include <limits>
+
+const qint64 Clock::REAL = std::numeric_limits<qint64>::min();
+std::atomic<qint64> Clock::fixedMsecs(Clock::REAL);
+
+QDateTime Clock::currentDateTime() {
+    qint64 msecs = fixedMsecs.load(std::memory_order_relaxed);
+    return msecs == REAL ? QDateTime::currentDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+}
+
+void Clock::setFixed(const QDateTime& now) {
+    fixedMsecs.store(now.isValid() ? now.toMSecsSinceEpoch() : REAL, std::memory_order_relaxed);
+}
+
+void Clock::advance(qint64 secs) {
+    qint64 msecs = fixedMsecs.load(std::memory_order_relaxed);
+    if (msecs != REAL) {
+        fixedMsecs.store(msecs + secs * 1000, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QDate>
+#include <QDateTime>
+#include <atomic>
+
+// Текущие дата и время для ядра. По умолчанию — системные часы; симулятор
+// (benchmarks/simulator) фиксирует время и сдвигает его сам, чтобы прогнать
+// годы использования за минуты и с одинаковым результатом при одном seed.
+class Clock {
+public:
+    static QDate currentDate() { return currentDateTime().date(); }
+    static QDateTime currentDateTime();
+
+    static bool isFixed() { return fixedMsecs.load(std::memory_order_relaxed) != REAL; }
+    static void setFixed(const QDateTime& now);     // невалидное время — снова системные часы
+    static void advance(qint64 secs);               // только для зафиксированных часов
+
+private:
+    static const qint64 REAL;
+    static std::atomic<qint64> fixedMsecs;      // мс от эпохи или REAL
+};
+
+#endif // CLOCK_H
@@ -0,0 +1,81 @@
+#include "completionhistory.h"
+#include "isodate.h"
+#include <cstring>
+
+CompletionHistory::Year::Year() {
+    memset(counts, 0, sizeof(counts));
+    memset(bits, 0, sizeof(bits));
+}
+
+void CompletionHistory::add(const QDate& day, int delta) {
+    if (!day.isValid() || delta == 0) {
+        return;
+    }
+    Year& year = years[day.year()];
+    int i = day.dayOfYear() - 1;
+    int value = qBound(0, int(year.counts[i]) + delta, 0xFFFF);
+    year.counts[i] = quint16(value);
+    if (value > 0) {
+        year.bits[i / 64] |= quint64(1) << (i % 64);
+    } else {
+        year.bits[i / 64] &= ~(quint64(1) << (i % 64));
+    }
+}
+
+int CompletionHistory::count(const QDate& day) const {
+    QMap<int, Year>::const_iterator it = years.constFind(day.year());
+    return it == years.constEnd() || !day.isValid() ? 0 : it->counts[day.dayOfYear() - 1];
+}
+
+bool CompletionHistory::hasCompletions(const QDate& day) const {
+    QMap<int, Year>::const_iterator it = years.constFind(day.year());
+    if (it == years.constEnd() || !day.isValid()) {
+        return false;
+    }
+    int i = day.dayOfYear() - 1;
+    return (it->bits[i / 64] >> (i % 64)) & 1;
+}
+
+int CompletionHistory::activeDays(int year) const {
+    QMap<int, Year>::const_iterator it = years.constFind(year);
+    if (it == years.constEnd()) {
+        return 0;
+    }
+    int days = 0;
+    for (int w = 0; w < BITMAP_WORDS; w++) {
+        days += qPopulationCount(it->bits[w]);
+    }
+    return days;
+}
+
+int CompletionHistory::maxCount(int year) const {
+    QMap<int, Year>::const_iterator it = years.constFind(year);
+    if (it == years.constEnd()) {
+        return 0;
+    }
+    int result = 0;
+    for (int i = 0; i < DAYS_IN_YEAR; i++) {
+        result = qMax(result, int(it->counts[i]));
+    }
+    return result;
+}
+
+QJsonObject CompletionHistory::toJson() const {
+    QJsonObject obj;
+    for (QMap<int, Year>::const_iterator it = years.constBegin(); it != years.constEnd(); ++it) {
+        QDate first(it.key(), 1, 1);
+        for (int i = 0; i < DAYS_IN_YEAR; i++) {
+            if (it->counts[i] > 0) {
+                obj[IsoDate::formatDate(first.addDays(i))] = int(it->counts[i]);
+            }
+        }
+    }
+    return obj;
+}
+
+void CompletionHistory::fromJson(const QJsonObject& obj) {
+    years.clear();
+    for (QJsonObject::const_iterator it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        add(IsoDate::parseDate(it.key()), it.value().toInt());
+    }
+}
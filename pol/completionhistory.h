@@ -0,0 +1,38 @@
+#ifndef COMPLETIONHISTORY_H
+#define COMPLETIONHISTORY_H
+
+#include <QDate>
+#include <QMap>
+#include <QList>
+#include <QJsonObject>
+
+// Число выполненных задач по дням. На каждый год — 366 счётчиков и битовая карта
+// «в этот день что-то выполнено»; годы лежат в QMap. Ведётся TaskManager при каждой
+// правке и сохраняется рядом с разделами, так что для истории не нужно читать старые месяцы.
+class CompletionHistory {
+public:
+    void add(const QDate& day, int delta);
+    int count(const QDate& day) const;
+    bool hasCompletions(const QDate& day) const;
+    int activeDays(int year) const;         // дней с выполненными задачами за год
+    int maxCount(int year) const;
+    QList<int> getYears() const { return years.keys(); }
+    void clear() { years.clear(); }
+
+    QJsonObject toJson() const;             // {"2026-10-19": 3, ...}
+    void fromJson(const QJsonObject& obj);
+
+private:
+    static const int DAYS_IN_YEAR = 366;
+    static const int BITMAP_WORDS = (DAYS_IN_YEAR + 63) / 64;
+
+    struct Year {
+        Year();
+        quint16 counts[DAYS_IN_YEAR];       // индекс — dayOfYear() - 1
+        quint64 bits[BITMAP_WORDS];
+    };
+
+    QMap<int, Year> years;
+};
+
+#endif // COMPLETIONHISTORY_H
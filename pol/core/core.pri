@@ -0,0 +1,42 @@
+# Ядро без интерфейса: задачи и правила, словарь, геймификация, хранилище, настройки.
+# Подключается приложением (pol.pro), статической библиотекой core.pro и бенчмарками.
+# QtGui нужен только ради QColor в Task::priorityColor — виджетов в ядре нет.
+QT += core gui sql
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/../task.cpp \
+    $$PWD/../taskmanager.cpp \
+    $$PWD/../recurrence.cpp \
+    $$PWD/../daycontext.cpp \
+    $$PWD/../completionhistory.cpp \
+    $$PWD/../taskgraph.cpp \
+    $$PWD/../taskranking.cpp \
+    $$PWD/../gamestats.cpp \
+    $$PWD/../englishdata.cpp \
+    $$PWD/../appsettings.cpp \
+    $$PWD/../storagebackend.cpp \
+    $$PWD/../jsonstorage.cpp \
+    $$PWD/../sqlitestorage.cpp \
+    $$PWD/../trace.cpp \
+    $$PWD/../clock.cpp \
+    $$PWD/../isodate.cpp
+
+HEADERS += \
+    $$PWD/../task.h \
+    $$PWD/../taskmanager.h \
+    $$PWD/../recurrence.h \
+    $$PWD/../daycontext.h \
+    $$PWD/../completionhistory.h \
+    $$PWD/../taskgraph.h \
+    $$PWD/../taskranking.h \
+    $$PWD/../gamestats.h \
+    $$PWD/../englishdata.h \
+    $$PWD/../appsettings.h \
+    $$PWD/../storagebackend.h \
+    $$PWD/../jsonstorage.h \
+    $$PWD/../sqlitestorage.h \
+    $$PWD/../trace.h \
+    $$PWD/../clock.h \
+    $$PWD/../isodate.h
@@ -0,0 +1,8 @@
+# Статическая библиотека ядра (libpolcore) для программ без интерфейса, см. cli/.
+# Приложение собирает те же исходники через core.pri.
+TEMPLATE = lib
+CONFIG += staticlib c++11
+
+TARGET = polcore
+
+include(core.pri)
@@ -0,0 +1,26 @@
+#include "daycontext.h"
+#include "clock.h"
+
+DayContext::DayContext()
+    : DayContext(Clock::currentDate()) {
+}
+
+DayContext::DayContext(const QDate& today)
+    : today(today),
+      weekStart(today.addDays(1 - today.dayOfWeek())),
+      weekEnd(today.addDays(7 - today.dayOfWeek())) {
+}
+
+DayContext::Bucket DayContext::classify(const Task& task) const {
+    if (task.getStatus() == TaskStatus::Completed || !task.getDeadline().isValid()) {
+        return NoBucket;
+    }
+    QDate deadline = task.getDeadline();
+    if (deadline < today) {
+        return Overdue;
+    }
+    if (deadline == today) {
+        return Today;
+    }
+    return deadline <= weekEnd ? ThisWeek : Later;
+}
@@ -0,0 +1,34 @@
+#ifndef DAYCONTEXT_H
+#define DAYCONTEXT_H
+
+#include "task.h"
+#include <QDate>
+
+// Снимок «сегодня» и границ текущей недели. Создаётся один раз на пачку задач,
+// чтобы не вызывать Clock::currentDate() для каждой задачи.
+class DayContext {
+public:
+    enum Bucket {
+        NoBucket = 0,   // выполнена или без срока
+        Overdue,
+        Today,
+        ThisWeek,       // после сегодня и до воскресенья включительно
+        Later
+    };
+
+    DayContext();
+    explicit DayContext(const QDate& today);
+
+    QDate getToday() const { return today; }
+    QDate getWeekStart() const { return weekStart; }
+    QDate getWeekEnd() const { return weekEnd; }
+
+    Bucket classify(const Task& task) const;
+
+private:
+    QDate today;
+    QDate weekStart;
+    QDate weekEnd;
+};
+
+#endif // DAYCONTEXT_H
@@ -1,16 +1,12 @@
 #include "englishdata.h"
-#include <QFile>
-#include <QJsonDocument>
+#include "storagebackend.h"
+#include "trace.h"
 #include <QJsonArray>
-#include <QStandardPaths>
-#include <QDir>
-#include <QFileInfo>
 
-EnglishData::EnglishData() {
+EnglishData::EnglishData() : resident(true), revision(0) {
     for (int i = 0; i < LESSON_COUNT; i++) {
         lessons.append(QList<EnglishWord>());
     }
-    load();
 }
 
 QString EnglishData::levelName(int levelIndex) {
@@ -24,7 +20,7 @@ QString EnglishData::levelName(int levelIndex) {
     }
 }
 
-QString EnglishData::lessonId(int index) const {
+QString EnglishData::lessonId(int index) {
     if (index < 0 || index >= LESSON_COUNT) return QString();
     int lev = index / LESSONS_PER_LEVEL;
     int num = (index % LESSONS_PER_LEVEL) + 1;
@@ -41,85 +37,161 @@ int EnglishData::lessonNumInLevel(int lessonIndex) const {
     return (lessonIndex % LESSONS_PER_LEVEL) + 1;
 }
 
+int EnglishData::lessonIndex(const QString& id) const {
+    int dot = id.indexOf('.');
+    if (dot < 0) return -1;
+    int lev = -1;
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        if (levelName(i) == id.left(dot)) lev = i;
+    }
+    bool ok = false;
+    int num = id.mid(dot + 1).toInt(&ok);
+    if (lev < 0 || !ok || num < 1 || num > LESSONS_PER_LEVEL) return -1;
+    return lev * LESSONS_PER_LEVEL + num - 1;
+}
+
 QList<EnglishWord> EnglishData::getWords(int lessonIndex) const {
+    ensureResident();
     if (lessonIndex < 0 || lessonIndex >= lessons.size()) return QList<EnglishWord>();
     return lessons.at(lessonIndex);
 }
 
 void EnglishData::setWords(int lessonIndex, const QList<EnglishWord>& words) {
+    ensureResident();
     if (lessonIndex < 0 || lessonIndex >= lessons.size()) return;
     lessons[lessonIndex] = words;
-    save();
+    revision++;
+    saveLesson(lessonIndex);
 }
 
 void EnglishData::addWord(int lessonIndex, const QString& word, const QString& translation) {
+    ensureResident();
     if (lessonIndex < 0 || lessonIndex >= lessons.size()) return;
     EnglishWord w;
     w.word = word.trimmed();
     w.translation = translation.trimmed();
     if (!w.word.isEmpty()) {
         lessons[lessonIndex].append(w);
-        save();
+        revision++;
+        saveLesson(lessonIndex);
     }
 }
 
 void EnglishData::removeWord(int lessonIndex, int wordIndex) {
+    ensureResident();
     if (lessonIndex < 0 || lessonIndex >= lessons.size()) return;
     QList<EnglishWord>& list = lessons[lessonIndex];
     if (wordIndex >= 0 && wordIndex < list.size()) {
         list.removeAt(wordIndex);
-        save();
+        revision++;
+        saveLesson(lessonIndex);
     }
 }
 
 void EnglishData::load() {
-    QString path = dataPath();
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) return;
-    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
-    file.close();
-    for (int i = 0; i < LESSON_COUNT && i < lessons.size(); i++) {
-        QString key = "A1.1"; // fallback
-        int lev = i / LESSONS_PER_LEVEL;
-        int num = (i % LESSONS_PER_LEVEL) + 1;
-        key = levelName(lev) + "." + QString::number(num);
-        QJsonArray arr = root[key].toArray();
-        QList<EnglishWord> list;
-        for (const QJsonValue& v : arr) {
-            QJsonObject o = v.toObject();
-            EnglishWord w;
-            w.word = o["word"].toString();
-            w.translation = o["translation"].toString();
-            list.append(w);
+    TRACE_SCOPE("EnglishData::load");
+    QList<QList<EnglishWord>> loaded;
+    if (StorageBackend::instance()->readLessons(loaded)) {
+        lessons = loaded;
+        revision++;
+    }
+    resident = true;
+}
+
+void EnglishData::ensureResident() const {
+    if (resident) return;
+    TRACE_SCOPE("EnglishData::rehydrate");
+    QList<QList<EnglishWord>> loaded;
+    if (StorageBackend::instance()->readLessons(loaded)) {
+        lessons = loaded;
+    }
+    resident = true;
+}
+
+void EnglishData::unload() {
+    if (!resident) return;
+    for (int i = 0; i < lessons.size(); i++) {
+        lessons[i] = QList<EnglishWord>();
+    }
+    resident = false;
+    revision++;
+}
+
+qint64 EnglishData::residentBytes() const {
+    if (!resident) return 0;
+    // Оценка: символы UTF-16 плюс заголовки строк и узлы списка
+    qint64 bytes = 0;
+    for (const QList<EnglishWord>& list : lessons) {
+        for (const EnglishWord& w : list) {
+            bytes += (w.word.size() + w.translation.size()) * 2 + 64;
         }
-        lessons[i] = list;
     }
+    return bytes;
 }
 
-void EnglishData::save() {
-    QString path = dataPath();
-    QDir().mkpath(QFileInfo(path).absolutePath());
-    QJsonObject root;
+QList<int> EnglishData::mergeLessons(const QList<QList<EnglishWord>>& fresh, quint64 expectedRevision) {
+    QList<int> changedLessons;
+    // Выгруженный словарь и так перечитается из хранилища
+    if (!resident || revision != expectedRevision || fresh.size() != lessons.size()) {
+        return changedLessons;
+    }
     for (int i = 0; i < lessons.size(); i++) {
-        QString key = "A1.1";
-        int lev = i / LESSONS_PER_LEVEL;
-        int num = (i % LESSONS_PER_LEVEL) + 1;
-        key = levelName(lev) + "." + QString::number(num);
-        QJsonArray arr;
-        for (const EnglishWord& w : lessons.at(i)) {
-            QJsonObject o;
-            o["word"] = w.word;
-            o["translation"] = w.translation;
-            arr.append(o);
+        if (lessons[i] != fresh[i]) {
+            lessons[i] = fresh[i];
+            changedLessons.append(i);
         }
-        root[key] = arr;
     }
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly)) return;
-    file.write(QJsonDocument(root).toJson());
-    file.close();
+    return changedLessons;
 }
 
-QString EnglishData::dataPath() const {
-    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/english_vocabulary.json";
+void EnglishData::save() {
+    TRACE_SCOPE("EnglishData::save");
+    ensureResident();
+    QList<int> all;
+    for (int i = 0; i < lessons.size(); i++) {
+        all.append(i);
+    }
+    StorageBackend::instance()->writeLessons(lessons, all);
+}
+
+void EnglishData::saveLesson(int lessonIndex) {
+    TRACE_SCOPE("EnglishData::saveLesson");
+    StorageBackend::instance()->writeLessons(lessons, QList<int>() << lessonIndex);
+}
+
+QJsonArray EnglishData::lessonToJson(int lessonIndex) const {
+    ensureResident();
+    if (lessonIndex < 0 || lessonIndex >= lessons.size()) return QJsonArray();
+    return wordsToJson(lessons.at(lessonIndex));
+}
+
+QJsonArray EnglishData::wordsToJson(const QList<EnglishWord>& words) {
+    QJsonArray arr;
+    for (const EnglishWord& w : words) {
+        QJsonObject o;
+        o["word"] = w.word;
+        o["translation"] = w.translation;
+        arr.append(o);
+    }
+    return arr;
+}
+
+void EnglishData::setLessonFromJson(int lessonIndex, const QJsonArray& arr) {
+    if (lessonIndex < 0 || lessonIndex >= lessons.size()) return;
+    ensureResident();
+    lessons[lessonIndex] = wordsFromJson(arr);
+    revision++;
+}
+
+QList<EnglishWord> EnglishData::wordsFromJson(const QJsonArray& arr) {
+    QList<EnglishWord> list;
+    list.reserve(arr.size());
+    for (const QJsonValue& v : arr) {
+        QJsonObject o = v.toObject();
+        EnglishWord w;
+        w.word = o["word"].toString();
+        w.translation = o["translation"].toString();
+        list.append(w);
+    }
+    return list;
 }
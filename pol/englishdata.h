@@ -5,10 +5,15 @@
 #include <QList>
 #include <QPair>
 #include <QJsonObject>
+#include <QJsonArray>
 
 struct EnglishWord {
     QString word;
     QString translation;
+
+    bool operator==(const EnglishWord& other) const {
+        return word == other.word && translation == other.translation;
+    }
 };
 
 class EnglishData {
@@ -20,21 +25,44 @@ public:
     static const int LESSON_COUNT = LEVEL_COUNT * LESSONS_PER_LEVEL;  // 250
 
     static QString levelName(int levelIndex);   // "A1", "A2", "B1", "B2", "C1"
-    QString lessonId(int index) const;         // "A1.1", "A1.2", ... "C1.50"
+    static QString lessonId(int index);        // "A1.1", "A1.2", ... "C1.50"
     int levelIndexFromLesson(int lessonIndex) const;
     int lessonNumInLevel(int lessonIndex) const;  // 1..50
+    int lessonIndex(const QString& id) const;     // "B1.7" -> индекс, -1 если нет такого
 
     QList<EnglishWord> getWords(int lessonIndex) const;
     void setWords(int lessonIndex, const QList<EnglishWord>& words);
     void addWord(int lessonIndex, const QString& word, const QString& translation);
     void removeWord(int lessonIndex, int wordIndex);
 
-    void load();
-    void save();
+    // Слова урока в JSON: [{"word": ..., "translation": ...}, ...]
+    QJsonArray lessonToJson(int lessonIndex) const;
+    void setLessonFromJson(int lessonIndex, const QJsonArray& arr);   // без сохранения
+    static QList<EnglishWord> wordsFromJson(const QJsonArray& arr);
+    static QJsonArray wordsToJson(const QList<EnglishWord>& words);
+
+    // Хранение — через StorageBackend; правка слов сохраняет только свой урок
+    void load();        // конструктор не читает данные: загрузку вызывает владелец
+    void save();        // все уроки
+    void saveLesson(int lessonIndex);   // только один урок (правка пришла с сервера)
+
+    // Нехватка памяти (см. MemoryBudget): слова выгружаются и перечитываются из хранилища
+    // при следующем обращении. Все правки сохраняются сразу, так что терять нечего
+    void unload();
+    bool isResident() const { return resident; }
+    qint64 residentBytes() const;
+
+    // Правка файла извне (см. StoreWatcher): файл читается в фоновом потоке,
+    // mergeLessons заменяет отличающиеся уроки, если после чтения не было локальных правок
+    quint64 getRevision() const { return revision; }
+    QList<int> mergeLessons(const QList<QList<EnglishWord>>& fresh, quint64 expectedRevision);
 
 private:
-    QList<QList<EnglishWord>> lessons;
-    QString dataPath() const;
+    mutable QList<QList<EnglishWord>> lessons;
+    mutable bool resident;
+    quint64 revision;   // растёт при каждой локальной правке
+
+    void ensureResident() const;
 };
 
 #endif // ENGLISHDATA_H
@@ -1,71 +1,228 @@
 #include "gamestats.h"
-#include <QFile>
-#include <QFileInfo>
+#include "storagebackend.h"
+#include "trace.h"
+#include "isodate.h"
 #include <QJsonDocument>
-#include <QStandardPaths>
-#include <QDir>
+#include <QDateTime>
+#include <cmath>
 
-GameStats::GameStats() : xp(0), level(1), streak(0) {
-    load();
+GameStats::GameStats()
+    : baseXP(0), xp(0), level(1), today(Clock::currentDate()), runEnd(0), runLength(0),
+      bestStreak(0), eventsSinceSnapshot(0) {
 }
 
-int GameStats::getXPForNextLevel() const {
-    return level * 10;
+int GameStats::xpForLevel(int level) {
+    return 5 * level * (level - 1);
 }
 
-void GameStats::addTaskCompleted() {
-    QDate today = QDate::currentDate();
-    if (lastCompletedDate == today) {
-        return; // уже считали сегодня
+int GameStats::levelForXP(int xp) {
+    if (xp <= 0) {
+        return 1;
     }
-    if (lastCompletedDate.isValid() && lastCompletedDate.daysTo(today) == 1) {
-        streak++;
-    } else if (!lastCompletedDate.isValid() || lastCompletedDate.daysTo(today) > 1) {
-        streak = 1;
+    // 5·L·(L-1) ≤ xp  ⇔  L ≤ (1 + √(1 + 0.8·xp)) / 2; поправка на округление double
+    int lvl = int((1.0 + std::sqrt(1.0 + 0.8 * xp)) / 2.0);
+    while (lvl > 1 && xpForLevel(lvl) > xp) lvl--;
+    while (xpForLevel(lvl + 1) <= xp) lvl++;
+    return qMax(1, lvl);
+}
+
+int GameStats::getStreak() const {
+    if (runLength == 0) {
+        return 0;
     }
-    lastCompletedDate = today;
-    xp += 10; // +10 XP за задачу
-    recalcLevel();
-    save();
+    // Серия жива, если последний день с выполненной задачей — сегодня или вчера
+    return today.toJulianDay() - runEnd <= 1 ? runLength : 0;
+}
+
+void GameStats::addTaskCompleted(TaskId taskId, const QDate& day) {
+    appendToLedger(taskId, day.toJulianDay(), 1);
+    applyEvent(day.toJulianDay(), 1);
+}
+
+void GameStats::removeTaskCompleted(TaskId taskId, const QDate& day) {
+    if (!dayCounts.contains(day.toJulianDay())) {
+        return; // отметка была до журнала — забирать нечего
+    }
+    appendToLedger(taskId, day.toJulianDay(), -1);
+    applyEvent(day.toJulianDay(), -1);
+}
+
+void GameStats::checkStreak(const QDate& today) {
+    this->today = today;
+}
+
+bool GameStats::applyEvent(qint64 day, int delta) {
+    int before = dayCounts.value(day, 0);
+    int after = qMax(0, before + delta);
+    if (after == before) {
+        return false;
+    }
+    if (after == 0) {
+        dayCounts.remove(day);
+    } else {
+        dayCounts[day] = after;
+    }
+    if (before > 0 && after > 0) {
+        return true;    // XP и серии зависят только от того, был ли день активным
+    }
+
+    xp = baseXP + XP_PER_DAY * dayCounts.size();
+    level = levelForXP(xp);
+    if (after > 0 && runLength > 0 && day == runEnd + 1) {
+        runEnd = day;
+        runLength++;
+        bestStreak = qMax(bestStreak, runLength);
+    } else if (after > 0 && day > runEnd + 1) {
+        runEnd = day;
+        runLength = 1;
+        bestStreak = qMax(bestStreak, 1);
+    } else {
+        // Правка в прошлом (снятие отметки, синхронизация) — серии пересчитываем по дням
+        recomputeRuns();
+    }
+    return true;
+}
+
+void GameStats::recomputeRuns() {
+    runEnd = 0;
+    runLength = 0;
+    bestStreak = 0;
+    for (QMap<qint64, int>::const_iterator it = dayCounts.constBegin(); it != dayCounts.constEnd(); ++it) {
+        runLength = (runLength > 0 && it.key() == runEnd + 1) ? runLength + 1 : 1;
+        runEnd = it.key();
+        bestStreak = qMax(bestStreak, runLength);
+    }
+}
+
+int GameStats::completionsOn(const QDate& day) const {
+    return dayCounts.value(day.toJulianDay(), 0);
 }
 
-void GameStats::recalcLevel() {
-    int need = 0;
-    int lvl = 1;
-    while (xp >= need + lvl * 10) {
-        need += lvl * 10;
-        lvl++;
+int GameStats::xpBetween(const QDate& from, const QDate& to) const {
+    int days = 0;
+    for (QMap<qint64, int>::const_iterator it = dayCounts.lowerBound(from.toJulianDay());
+         it != dayCounts.constEnd() && it.key() <= to.toJulianDay(); ++it) {
+        days++;
+    }
+    return days * XP_PER_DAY;
+}
+
+int GameStats::xpThisWeek(const QDate& today) const {
+    return xpBetween(today.addDays(1 - today.dayOfWeek()), today);
+}
+
+void GameStats::appendToLedger(TaskId taskId, qint64 day, int delta) {
+    QJsonObject event;
+    event["at"] = IsoDate::formatDateTime(Clock::currentDateTime());
+    event["day"] = IsoDate::formatDate(QDate::fromJulianDay(day));
+    event["task"] = QString::number(taskId);
+    event["delta"] = delta;
+    if (!StorageBackend::instance()->appendEvent(event)) return;
+
+    if (++eventsSinceSnapshot >= SNAPSHOT_EVERY) {
+        save();
     }
-    level = lvl;
 }
 
 void GameStats::load() {
-    QString path = dataPath();
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly)) return;
-    QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
-    file.close();
-    xp = obj["xp"].toInt(0);
-    level = obj["level"].toInt(1);
-    streak = obj["streak"].toInt(0);
-    lastCompletedDate = QDate::fromString(obj["lastCompletedDate"].toString(), Qt::ISODate);
-    recalcLevel();
+    loadPreloaded(preload());
+}
+
+GameStats::Preload GameStats::preload() {
+    TRACE_SCOPE("GameStats::preload");
+    StorageBackend* storage = StorageBackend::instance();
+    Preload data;
+    QByteArray snapshot = storage->readDocument("gamestats");
+    qint64 ledgerOffset = 0;
+    if (!snapshot.isEmpty()) {
+        data.snapshot = QJsonDocument::fromJson(snapshot).object();
+        ledgerOffset = qint64(data.snapshot["ledgerOffset"].toDouble());
+    }
+    data.eventsRead = storage->readEvents(ledgerOffset, data.events);
+    return data;
+}
+
+void GameStats::loadPreloaded(const Preload& data) {
+    TRACE_SCOPE("GameStats::loadPreloaded");
+    // Снимка может не быть (он пишется раз в SNAPSHOT_EVERY событий) — тогда журнал
+    // проигрывается с нуля, а не поверх прежнего состояния (повторная загрузка после восстановления)
+    dayCounts.clear();
+    baseXP = 0;
+    xp = 0;
+    level = 1;
+    runEnd = 0;
+    runLength = 0;
+    bestStreak = 0;
+    eventsSinceSnapshot = 0;
+
+    if (!data.snapshot.isEmpty()) {
+        fromJson(data.snapshot);
+    }
+
+    // Дочитываем события после снимка
+    if (!data.eventsRead) {
+        return; // журнал моложе снимка (восстановление, синхронизация) — верим снимку
+    }
+    int replayed = 0;
+    for (const QJsonObject& event : data.events) {
+        QDate day = IsoDate::parseDate(event["day"].toString());
+        if (day.isValid()) {
+            applyEvent(day.toJulianDay(), event["delta"].toInt());
+            replayed++;
+        }
+    }
+    eventsSinceSnapshot = replayed;
 }
 
 void GameStats::save() {
-    QString path = dataPath();
-    QDir().mkpath(QFileInfo(path).absolutePath());
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly)) return;
+    TRACE_SCOPE("GameStats::save");
+    StorageBackend* storage = StorageBackend::instance();
+    QJsonObject obj = toJson();
+    obj["ledgerOffset"] = double(storage->eventsEnd());
+    if (!storage->writeDocument("gamestats", QJsonDocument(obj).toJson())) return;
+    eventsSinceSnapshot = 0;
+}
+
+QJsonObject GameStats::toJson() const {
     QJsonObject obj;
+    obj["version"] = 2;
+    obj["baseXP"] = baseXP;
+    QJsonObject days;
+    for (QMap<qint64, int>::const_iterator it = dayCounts.constBegin(); it != dayCounts.constEnd(); ++it) {
+        days[IsoDate::formatDate(QDate::fromJulianDay(it.key()))] = it.value();
+    }
+    obj["days"] = days;
+    // Поля старого формата — для чтения человеком и старыми версиями
     obj["xp"] = xp;
     obj["level"] = level;
-    obj["streak"] = streak;
-    obj["lastCompletedDate"] = lastCompletedDate.toString(Qt::ISODate);
-    file.write(QJsonDocument(obj).toJson());
-    file.close();
+    obj["streak"] = getStreak();
+    obj["lastCompletedDate"] = runLength > 0 ? IsoDate::formatDate(QDate::fromJulianDay(runEnd)) : QString();
+    return obj;
 }
 
-QString GameStats::dataPath() const {
-    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/gamestats.json";
+void GameStats::fromJson(const QJsonObject& obj) {
+    dayCounts.clear();
+    if (obj.contains("days")) {
+        baseXP = obj["baseXP"].toInt(0);
+        QJsonObject days = obj["days"].toObject();
+        for (QJsonObject::const_iterator it = days.constBegin(); it != days.constEnd(); ++it) {
+            QDate day = IsoDate::parseDate(it.key());
+            if (day.isValid() && it.value().toInt() > 0) {
+                dayCounts.insert(day.toJulianDay(), it.value().toInt());
+            }
+        }
+    } else {
+        // Старый формат: дни серии восстанавливаются, остальной XP остаётся без истории
+        int oldXP = obj["xp"].toInt(0);
+        QDate last = IsoDate::parseDate(obj["lastCompletedDate"].toString());
+        int days = last.isValid() ? qMax(1, obj["streak"].toInt(0)) : 0;
+        days = qMin(days, oldXP / XP_PER_DAY);
+        for (int i = 0; i < days; i++) {
+            dayCounts.insert(last.addDays(-i).toJulianDay(), 1);
+        }
+        baseXP = oldXP - days * XP_PER_DAY;
+    }
+    xp = baseXP + XP_PER_DAY * dayCounts.size();
+    level = levelForXP(xp);
+    recomputeRuns();
 }
@@ -3,29 +3,76 @@
 
 #include <QString>
 #include <QDate>
+#include <QMap>
 #include <QJsonObject>
+#include "task.h"
+#include "clock.h"
 
+// Геймификация как журнал событий: каждая отметка «выполнено» и её снятие дописываются
+// в журнал хранилища (gamestats_ledger.jsonl или таблица events), в памяти ведутся итоги
+// по дням. +10 XP за день, в котором выполнена хотя бы одна задача; снятая отметка
+// забирает XP, если день опустел. Снимок gamestats — периодические итоги с позицией
+// в журнале: при загрузке дочитывается только хвост журнала после снимка.
 class GameStats {
 public:
+    static const int XP_PER_DAY = 10;
+
     GameStats();
 
     int getXP() const { return xp; }
     int getLevel() const { return level; }
-    int getStreak() const { return streak; }
-    int getXPForNextLevel() const;  // XP нужно до следующего уровня
+    int getStreak() const;                  // текущая серия на день последнего checkStreak
+    int getBestStreak() const { return bestStreak; }
+    int getXPForNextLevel() const { return level * 10; }       // размер текущего уровня в XP
+    int getXPInLevel() const { return xp - xpForLevel(level); }
+
+    // Уровень L начинается с 10 + 20 + ... + 10·(L-1) = 5·L·(L-1) XP
+    static int xpForLevel(int level);
+    static int levelForXP(int xp);
+
+    void addTaskCompleted(TaskId taskId, const QDate& day = Clock::currentDate());
+    void removeTaskCompleted(TaskId taskId, const QDate& day);     // day — когда задачу отметили
+    void checkStreak(const QDate& today);   // день, на который считается текущая серия
+
+    // Выборки по итогам дней
+    int completionsOn(const QDate& day) const;
+    int xpBetween(const QDate& from, const QDate& to) const;
+    int xpThisWeek(const QDate& today) const;
 
-    void addTaskCompleted();       // Выполнена задача сегодня — +XP, обновить streak
-    void load();
-    void save();
+    void load();                   // конструктор не читает данные: загрузку вызывает владелец
+
+    // load в два шага: preload только читает хранилище (можно в пуле потоков),
+    // loadPreloaded в главном потоке заменяет итоги прочитанным
+    struct Preload {
+        Preload() : eventsRead(false) {}
+        QJsonObject snapshot;
+        QList<QJsonObject> events;      // журнал после снимка
+        bool eventsRead;                // false — журнал моложе снимка, верим снимку
+    };
+    static Preload preload();
+    void loadPreloaded(const Preload& data);
+    void save();                   // снимок итогов; журнал после него пуст
+
+    // Итоги по дням (синхронизация); старый формат {xp, streak, lastCompletedDate} тоже читается
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject& obj);
 
 private:
+    static const int SNAPSHOT_EVERY = 64;   // событий в журнале между снимками
+
+    int baseXP;                 // XP из старого формата, для которого нет истории по дням
     int xp;
     int level;
-    int streak;
-    QDate lastCompletedDate;
+    QMap<qint64, int> dayCounts;    // julian day -> выполнено задач (только дни > 0)
+    QDate today;
+    qint64 runEnd;              // последняя серия подряд: её последний день и длина
+    int runLength;
+    int bestStreak;
+    int eventsSinceSnapshot;
 
-    void recalcLevel();             // пересчитать level по xp
-    QString dataPath() const;
+    bool applyEvent(qint64 day, int delta);     // без записи в журнал
+    void recomputeRuns();
+    void appendToLedger(TaskId taskId, qint64 day, int delta);
 };
 
 #endif // GAMESTATS_H
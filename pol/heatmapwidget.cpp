@@ -0,0 +1,168 @@
+#include "heatmapwidget.h"
+#include "taskmanager.h"
+#include "trace.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+
+HeatmapWidget::HeatmapWidget(TaskManager* taskManager, QWidget* parent)
+    : QWidget(parent), taskManager(taskManager), history(taskManager->getCompletionHistory()),
+      yearCount(1), cell(MAX_CELL) {
+    setObjectName("heatmap");
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    connect(taskManager, &TaskManager::completionCountChanged, this, &HeatmapWidget::onCompletionCountChanged);
+    connect(taskManager, &TaskManager::tasksChanged, this, &HeatmapWidget::onTasksChanged);
+}
+
+void HeatmapWidget::setYearCount(int count) {
+    count = qMax(1, count);
+    if (count == yearCount) {
+        return;
+    }
+    yearCount = count;
+    updateGeometry();
+    update();
+}
+
+QSize HeatmapWidget::sizeHint() const {
+    return QSize(LABEL_WIDTH + WEEKS * (MAX_CELL + GAP), yearCount * ((MAX_CELL + GAP) * 7 + GAP * 2));
+}
+
+QSize HeatmapWidget::minimumSizeHint() const {
+    return QSize(LABEL_WIDTH + WEEKS * (MIN_CELL + GAP), yearCount * ((MIN_CELL + GAP) * 7 + GAP * 2));
+}
+
+int HeatmapWidget::firstYear() const {
+    return QDate::currentDate().year() - yearCount + 1;
+}
+
+int HeatmapWidget::tileHeight() const {
+    return (cell + GAP) * 7;
+}
+
+QRect HeatmapWidget::tileRect(int year) const {
+    int row = QDate::currentDate().year() - year;     // текущий год сверху
+    return QRect(LABEL_WIDTH, row * (tileHeight() + GAP * 2), WEEKS * (cell + GAP), tileHeight());
+}
+
+QRect HeatmapWidget::cellRect(const QDate& day) const {
+    // Столбец — номер недели от понедельника, на которую пришлось 1 января
+    QDate jan1(day.year(), 1, 1);
+    int column = (day.dayOfYear() - 1 + jan1.dayOfWeek() - 1) / 7;
+    int row = day.dayOfWeek() - 1;
+    return QRect(column * (cell + GAP), row * (cell + GAP), cell, cell);
+}
+
+QDate HeatmapWidget::dayAt(const QPoint& pos) const {
+    for (int year = firstYear(); year <= QDate::currentDate().year(); year++) {
+        QRect tile = tileRect(year);
+        if (!tile.contains(pos)) {
+            continue;
+        }
+        QPoint p = pos - tile.topLeft();
+        int column = p.x() / (cell + GAP);
+        int row = p.y() / (cell + GAP);
+        QDate jan1(year, 1, 1);
+        QDate day = jan1.addDays(column * 7 + row - (jan1.dayOfWeek() - 1));
+        return day.year() == year ? day : QDate();
+    }
+    return QDate();
+}
+
+QColor HeatmapWidget::colorFor(int count) {
+    if (count <= 0) return QColor(235, 237, 240);
+    if (count == 1) return QColor(155, 233, 168);
+    if (count <= 3) return QColor(64, 196, 99);
+    if (count <= 6) return QColor(48, 161, 78);
+    return QColor(33, 110, 57);
+}
+
+void HeatmapWidget::paintCell(QPainter& painter, const QDate& day, int count) const {
+    QRect r = cellRect(day);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(r.adjusted(-1, -1, 1, 1), Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setBrush(colorFor(count));
+    painter.drawRoundedRect(r, 2, 2);
+}
+
+QPixmap HeatmapWidget::renderTile(int year) const {
+    TRACE_SCOPE("HeatmapWidget::renderTile");
+    qreal dpr = devicePixelRatioF();
+    QPixmap tile(QSize(WEEKS * (cell + GAP), tileHeight()) * dpr);
+    tile.setDevicePixelRatio(dpr);
+    tile.fill(Qt::transparent);
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    QDate day(year, 1, 1);
+    for (; day.year() == year; day = day.addDays(1)) {
+        painter.setBrush(colorFor(history.count(day)));
+        painter.drawRoundedRect(cellRect(day), 2, 2);
+    }
+    return tile;
+}
+
+void HeatmapWidget::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.setPen(palette().color(QPalette::WindowText));
+    for (int year = firstYear(); year <= QDate::currentDate().year(); year++) {
+        QRect rect = tileRect(year);
+        if (!event->rect().intersects(rect.adjusted(-LABEL_WIDTH, 0, 0, 0))) {
+            continue;
+        }
+        QHash<int, QPixmap>::iterator it = tiles.find(year);
+        if (it == tiles.end()) {
+            it = tiles.insert(year, renderTile(year));
+        }
+        painter.drawText(QRect(0, rect.top(), LABEL_WIDTH - GAP * 2, cell + GAP),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(year));
+        painter.drawPixmap(rect.topLeft(), it.value());
+    }
+}
+
+void HeatmapWidget::resizeEvent(QResizeEvent* event) {
+    int fitted = qBound(int(MIN_CELL), (width() - LABEL_WIDTH) / WEEKS - GAP, int(MAX_CELL));
+    if (fitted != cell) {
+        cell = fitted;
+        tiles.clear();
+    }
+    QWidget::resizeEvent(event);
+}
+
+bool HeatmapWidget::event(QEvent* event) {
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent* help = static_cast<QHelpEvent*>(event);
+        QDate day = dayAt(help->pos());
+        if (day.isValid()) {
+            QToolTip::showText(help->globalPos(), QString("%1: выполнено %2")
+                .arg(day.toString("dd.MM.yyyy")).arg(history.count(day)), this);
+        } else {
+            QToolTip::hideText();
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void HeatmapWidget::onCompletionCountChanged(const QDate& day, int count) {
+    QHash<int, QPixmap>::iterator it = tiles.find(day.year());
+    if (it == tiles.end()) {
+        return;     // плитка не нарисована — при показе возьмёт свежие счётчики
+    }
+    QPainter painter(&it.value());
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    paintCell(painter, day, count);
+    painter.end();
+    update(cellRect(day).translated(tileRect(day.year()).topLeft()));
+}
+
+void HeatmapWidget::onTasksChanged(const QList<TaskId>& taskIds) {
+    // Пустой список — набор перезагружен (импорт, восстановление): история пересобрана
+    if (taskIds.isEmpty()) {
+        tiles.clear();
+        update();
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef HEATMAPWIDGET_H
+#define HEATMAPWIDGET_H
+
+#include <QWidget>
+#include <QHash>
+#include <QPixmap>
+#include <QDate>
+#include "task.h"
+
+class TaskManager;
+class CompletionHistory;
+
+// Календарь выполнения за год (как на GitHub): неделя — столбец, день недели — строка,
+// цвет — число выполненных задач. Каждый год рисуется один раз в кэшированную плитку
+// по счётчикам CompletionHistory; при изменении дня перерисовывается только его клетка.
+class HeatmapWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit HeatmapWidget(TaskManager* taskManager, QWidget* parent = nullptr);
+
+    int getYearCount() const { return yearCount; }
+    void setYearCount(int count);       // последние count лет, новые сверху
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    bool event(QEvent* event) override;
+
+private slots:
+    void onCompletionCountChanged(const QDate& day, int count);
+    void onTasksChanged(const QList<TaskId>& taskIds);
+
+private:
+    static const int MAX_CELL = 12;
+    static const int MIN_CELL = 4;
+    static const int GAP = 2;
+    static const int LABEL_WIDTH = 36;      // подпись года слева
+    static const int WEEKS = 54;            // неделя 1 января может быть неполной
+
+    TaskManager* taskManager;
+    const CompletionHistory& history;
+    int yearCount;
+    int cell;
+    QHash<int, QPixmap> tiles;      // год -> плитка
+
+    int firstYear() const;          // нижний показанный год
+    int tileHeight() const;
+    QRect tileRect(int year) const;
+    QRect cellRect(const QDate& day) const;     // внутри плитки
+    QDate dayAt(const QPoint& pos) const;
+    QPixmap renderTile(int year) const;
+    void paintCell(QPainter& painter, const QDate& day, int count) const;
+    static QColor colorFor(int count);
+};
+
+#endif // HEATMAPWIDGET_H
@@ -0,0 +1,101 @@
+#include "isodate.h"
+
+static const int DATE_LENGTH = 10;          // yyyy-MM-dd
+static const int DATE_TIME_LENGTH = 19;     // yyyy-MM-ddTHH:mm:ss
+
+// Число из count цифр; -1 — встретился не цифровой символ
+static inline int readDigits(const QChar* s, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        uint digit = uint(s[i].unicode()) - '0';
+        if (digit > 9) {
+            return -1;
+        }
+        value = value * 10 + int(digit);
+    }
+    return value;
+}
+
+static inline void writeDigits(QChar* out, int value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        out[i] = QChar(ushort('0' + value % 10));
+        value /= 10;
+    }
+}
+
+static inline bool readDate(const QChar* s, int& year, int& month, int& day) {
+    if (s[4] != QLatin1Char('-') || s[7] != QLatin1Char('-')) {
+        return false;
+    }
+    year = readDigits(s, 4);
+    month = readDigits(s + 5, 2);
+    day = readDigits(s + 8, 2);
+    return year >= 0 && month >= 0 && day >= 0 && QDate::isValid(year, month, day);
+}
+
+static inline void writeDate(QChar* out, int year, int month, int day) {
+    writeDigits(out, year, 4);
+    out[4] = QLatin1Char('-');
+    writeDigits(out + 5, month, 2);
+    out[7] = QLatin1Char('-');
+    writeDigits(out + 8, day, 2);
+}
+
+QDate IsoDate::parseDate(const QString& text) {
+    int year, month, day;
+    if (text.size() == DATE_LENGTH && readDate(text.constData(), year, month, day)) {
+        return QDate(year, month, day);
+    }
+    return QDate::fromString(text, Qt::ISODate);
+}
+
+QDateTime IsoDate::parseDateTime(const QString& text) {
+    const QChar* s = text.constData();
+    bool utc = text.size() == DATE_TIME_LENGTH + 1 && s[DATE_TIME_LENGTH] == QLatin1Char('Z');
+    int year, month, day;
+    if ((text.size() == DATE_TIME_LENGTH || utc) && s[10] == QLatin1Char('T')
+        && s[13] == QLatin1Char(':') && s[16] == QLatin1Char(':') && readDate(s, year, month, day)) {
+        int hour = readDigits(s + 11, 2);
+        int minute = readDigits(s + 14, 2);
+        int second = readDigits(s + 17, 2);
+        if (hour >= 0 && minute >= 0 && second >= 0 && QTime::isValid(hour, minute, second)) {
+            return QDateTime(QDate(year, month, day), QTime(hour, minute, second), utc ? Qt::UTC : Qt::LocalTime);
+        }
+    }
+    return QDateTime::fromString(text, Qt::ISODate);
+}
+
+QString IsoDate::formatDate(const QDate& date) {
+    int year, month, day;
+    date.getDate(&year, &month, &day);
+    if (!date.isValid() || year < 0 || year > 9999) {
+        return date.toString(Qt::ISODate);
+    }
+    QString text(DATE_LENGTH, Qt::Uninitialized);
+    writeDate(text.data(), year, month, day);
+    return text;
+}
+
+QString IsoDate::formatDateTime(const QDateTime& dateTime) {
+    Qt::TimeSpec spec = dateTime.timeSpec();
+    QDate date = dateTime.date();
+    int year, month, day;
+    date.getDate(&year, &month, &day);
+    if (!dateTime.isValid() || (spec != Qt::LocalTime && spec != Qt::UTC) || year < 0 || year > 9999) {
+        return dateTime.toString(Qt::ISODate);
+    }
+    int secs = dateTime.time().msecsSinceStartOfDay() / 1000;
+    QString text(spec == Qt::UTC ? DATE_TIME_LENGTH + 1 : DATE_TIME_LENGTH, Qt::Uninitialized);
+    QChar* out = text.data();
+    writeDate(out, year, month, day);
+    out[10] = QLatin1Char('T');
+    writeDigits(out + 11, secs / 3600, 2);
+    out[13] = QLatin1Char(':');
+    writeDigits(out + 14, secs / 60 % 60, 2);
+    out[16] = QLatin1Char(':');
+    writeDigits(out + 17, secs % 60, 2);
+    if (spec == Qt::UTC) {
+        out[DATE_TIME_LENGTH] = QLatin1Char('Z');
+    }
+    return text;
+}
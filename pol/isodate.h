@@ -0,0 +1,21 @@
+#ifndef ISODATE_H
+#define ISODATE_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QString>
+
+// Даты в JSON задач, правил и геймификации: ровно те форматы, что пишет приложение —
+// yyyy-MM-dd и yyyy-MM-ddTHH:mm:ss (локальное время, с Z — UTC). Такие строки
+// разбираются и собираются напрямую по символам, без разбора формата в Qt и
+// без промежуточных строк; всё остальное (годы вне 0–9999, смещения, доли секунды,
+// 24:00) уходит в QDate/QDateTime::fromString/toString с Qt::ISODate — результат тот же.
+class IsoDate {
+public:
+    static QDate parseDate(const QString& text);
+    static QDateTime parseDateTime(const QString& text);
+    static QString formatDate(const QDate& date);
+    static QString formatDateTime(const QDateTime& dateTime);
+};
+
+#endif // ISODATE_H
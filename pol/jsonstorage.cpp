@@ -0,0 +1,231 @@
+#include "jsonstorage.h"
+#include "taskmanager.h"
+#include "trace.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+JsonStorage::JsonStorage() {
+}
+
+QString JsonStorage::dataDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+QString JsonStorage::taskDirectory() {
+    return dataDirectory() + "/tasks";
+}
+
+QString JsonStorage::partitionPath(int key) {
+    if (key == 0) {
+        return taskDirectory() + "/undated.json";
+    }
+    return taskDirectory() + QString("/%1-%2.json").arg(key / 100).arg(key % 100, 2, 10, QChar('0'));
+}
+
+int JsonStorage::partitionKeyFromFileName(const QString& fileName) {
+    QFileInfo info(fileName);
+    if (info.suffix() != "json") {
+        return -1;
+    }
+    QString base = info.completeBaseName();
+    if (base == "undated") {
+        return 0;
+    }
+    QDate month = QDate::fromString(base + "-01", Qt::ISODate);
+    return month.isValid() ? TaskManager::partitionKey(month) : -1;
+}
+
+QString JsonStorage::englishPath() {
+    return dataDirectory() + "/english_vocabulary.json";
+}
+
+QString JsonStorage::documentPath(const QString& name) const {
+    if (name == "gamestats") {
+        return dataDirectory() + "/gamestats.json";
+    }
+    return taskDirectory() + "/" + name + ".json";   // recurrences, history, graph
+}
+
+QString JsonStorage::ledgerPath() const {
+    return dataDirectory() + "/gamestats_ledger.jsonl";
+}
+
+bool JsonStorage::readTaskFile(const QString& path, QList<Task>& out) {
+    QFile file(path);
+
+    if (!file.exists()) {
+        return false;
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Не удалось открыть файл для чтения:" << file.fileName();
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    file.close();
+
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull() || !doc.isArray()) {
+        return false;
+    }
+
+    QJsonArray jsonArray = doc.array();
+    out.reserve(out.size() + jsonArray.size());
+    for (const QJsonValue& value : jsonArray) {
+        if (value.isObject()) {
+            out.append(Task::fromJson(value.toObject()));
+        }
+    }
+    return true;
+}
+
+bool JsonStorage::writeTaskFile(const QString& path, const QList<Task>& tasks) {
+    QJsonArray jsonArray;
+    for (const Task& task : tasks) {
+        jsonArray.append(task.toJson());
+    }
+
+    QJsonDocument doc(jsonArray);
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Не удалось открыть файл для записи:" << file.fileName();
+        return false;
+    }
+
+    file.write(doc.toJson());
+    file.close();
+    return true;
+}
+
+bool JsonStorage::readLessonFile(const QString& path, QList<QList<EnglishWord>>& out) {
+    TRACE_SCOPE("JsonStorage::readLessonFile");
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    file.close();
+    // Недописанный файл не считаем пустым словарём
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) return false;
+    QJsonObject root = doc.object();
+    out.clear();
+    out.reserve(EnglishData::LESSON_COUNT);
+    for (int i = 0; i < EnglishData::LESSON_COUNT; i++) {
+        out.append(EnglishData::wordsFromJson(root[EnglishData::lessonId(i)].toArray()));
+    }
+    return true;
+}
+
+QList<int> JsonStorage::partitionKeys() {
+    QList<int> keys;
+    QStringList files = QDir(taskDirectory()).entryList(QStringList() << "*.json", QDir::Files);
+    for (const QString& name : files) {
+        int key = partitionKeyFromFileName(name);
+        if (key >= 0) {
+            keys.append(key);
+        }
+    }
+    return keys;
+}
+
+bool JsonStorage::readPartition(int key, QList<Task>& out) {
+    return readTaskFile(partitionPath(key), out);
+}
+
+bool JsonStorage::writePartition(int key, const QList<Task>& tasks) {
+    QDir().mkpath(taskDirectory());
+    return writeTaskFile(partitionPath(key), tasks);
+}
+
+bool JsonStorage::removePartition(int key) {
+    QString path = partitionPath(key);
+    return !QFile::exists(path) || QFile::remove(path);
+}
+
+QByteArray JsonStorage::readDocument(const QString& name) {
+    QFile file(documentPath(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+bool JsonStorage::writeDocument(const QString& name, const QByteArray& data) {
+    QString path = documentPath(name);
+    if (data.isEmpty()) {
+        return !QFile::exists(path) || QFile::remove(path);
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Не удалось открыть файл для записи:" << file.fileName();
+        return false;
+    }
+    file.write(data);
+    file.close();
+    return true;
+}
+
+bool JsonStorage::readLessons(QList<QList<EnglishWord>>& out) {
+    return readLessonFile(englishPath(), out);
+}
+
+bool JsonStorage::writeLessons(const QList<QList<EnglishWord>>& lessons, const QList<int>& changed) {
+    // Словарь — один файл: переписывается целиком при любой правке
+    Q_UNUSED(changed);
+    QString path = englishPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QJsonObject root;
+    for (int i = 0; i < lessons.size(); i++) {
+        root[EnglishData::lessonId(i)] = EnglishData::wordsToJson(lessons.at(i));
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+    return true;
+}
+
+bool JsonStorage::appendEvent(const QJsonObject& event) {
+    QString path = ledgerPath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) return false;
+    file.write(QJsonDocument(event).toJson(QJsonDocument::Compact) + '\n');
+    file.close();
+    return true;
+}
+
+qint64 JsonStorage::eventsEnd() {
+    return QFileInfo(ledgerPath()).size();
+}
+
+bool JsonStorage::readEvents(qint64 from, QList<QJsonObject>& out) {
+    QFile ledger(ledgerPath());
+    if (!ledger.open(QIODevice::ReadOnly)) {
+        return from == 0;
+    }
+    if (ledger.size() < from) {
+        return false;
+    }
+    ledger.seek(from);
+    while (!ledger.atEnd()) {
+        QJsonObject event = QJsonDocument::fromJson(ledger.readLine()).object();
+        if (!event.isEmpty()) {
+            out.append(event);
+        }
+    }
+    ledger.close();
+    return true;
+}
+
+bool JsonStorage::clearEvents() {
+    QString path = ledgerPath();
+    return !QFile::exists(path) || QFile::remove(path);
+}
@@ -0,0 +1,49 @@
+#ifndef JSONSTORAGE_H
+#define JSONSTORAGE_H
+
+#include "storagebackend.h"
+
+// Прежние файлы в AppData:
+//   tasks/2026-10.json, tasks/undated.json — разделы задач (массив Task::toJson)
+//   tasks/recurrences.json, tasks/history.json — правила и история выполнения
+//   english_vocabulary.json — словарь {"A1.1": [{word, translation}], ...}
+//   gamestats.json и gamestats_ledger.jsonl — снимок и журнал геймификации
+// Любая правка переписывает файл целиком; позиция журнала — смещение в байтах.
+class JsonStorage : public StorageBackend {
+public:
+    JsonStorage();
+
+    Kind kind() const override { return Json; }
+
+    QList<int> partitionKeys() override;
+    bool readPartition(int key, QList<Task>& out) override;
+    bool writePartition(int key, const QList<Task>& tasks) override;
+    bool removePartition(int key) override;
+
+    QByteArray readDocument(const QString& name) override;
+    bool writeDocument(const QString& name, const QByteArray& data) override;
+
+    bool readLessons(QList<QList<EnglishWord>>& out) override;
+    bool writeLessons(const QList<QList<EnglishWord>>& lessons, const QList<int>& changed) override;
+
+    bool appendEvent(const QJsonObject& event) override;
+    qint64 eventsEnd() override;
+    bool readEvents(qint64 from, QList<QJsonObject>& out) override;
+    bool clearEvents() override;
+
+    // Пути и формат файлов — и для StoreWatcher, экспорта и старого tasks.json
+    static QString dataDirectory();
+    static QString taskDirectory();
+    static QString partitionPath(int key);
+    static int partitionKeyFromFileName(const QString& fileName);   // -1 — не файл раздела
+    static QString englishPath();
+    static bool readTaskFile(const QString& path, QList<Task>& out);
+    static bool writeTaskFile(const QString& path, const QList<Task>& tasks);
+    static bool readLessonFile(const QString& path, QList<QList<EnglishWord>>& out);
+
+private:
+    QString documentPath(const QString& name) const;
+    QString ledgerPath() const;
+};
+
+#endif // JSONSTORAGE_H
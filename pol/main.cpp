@@ -1,11 +1,20 @@
 #include "mainwindow.h"
+#include "trace.h"
+#include "theme.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
    QApplication a(argc, argv);
-   MainWindow w;
-   w.show();
-   return a.exec();
+   Trace::initFromEnvironment();
+   Theme::apply(a);
+   int result;
+   {
+       MainWindow w;
+       w.show();
+       result = a.exec();
+   }
+   Trace::finish();
+   return result;
 }
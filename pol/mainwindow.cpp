@@ -1,11 +1,21 @@
 #include "mainwindow.h"
 #include "task.h"
+#include "trace.h"
+#include "theme.h"
+#include "taskdialog.h"
+#include "syncengine.h"
+#include "storewatcher.h"
+#include "memorybudget.h"
+#include "heatmapwidget.h"
+#include "agendamodel.h"
+#include "agendaview.h"
+#include "appsettings.h"
+#include "storagebackend.h"
+#include "taskranking.h"
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QDialog>
-#include <QFormLayout>
-#include <QDialogButtonBox>
 #include <QDate>
 #include <QFrame>
 #include <QApplication>
@@ -24,13 +34,36 @@
 #include <QFileInfo>
 #include <QScreen>
 #include <QGuiApplication>
+#include <QStatusBar>
+#include <QDebug>
+#include <QTimer>
+#include <QSignalBlocker>
+#include <QProgressDialog>
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QShortcut>
 
 #if defined(Q_OS_ANDROID) || defined(Q_OS_IOS)
 #define POL_MOBILE 1
 #endif
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), taskManager(new TaskManager()) {
+    : QMainWindow(parent), taskManager(new TaskManager(nullptr, TaskManager::LoadLater)), reminders(nullptr), taskDialog(nullptr), syncEngine(nullptr), storeWatcher(nullptr), memoryBudget(nullptr),
+      startupNs(Trace::nowNs()), firstFrameMsecs(-1), agendaView(nullptr), englishTabBuilt(false), prayerTabBuilt(false),
+      prayerImageEvicted(false) {
+    TRACE_SCOPE("MainWindow::MainWindow");
+    // Хранилище открывается (и при смене вида переносит данные) в главном потоке,
+    // до фоновых загрузок
+    StorageBackend::instance();
+    // Хранилища читаются параллельно в пуле потоков, пока строится интерфейс; прочитанное
+    // ставится на место в главном потоке (там же записи первого запуска).
+    // Задачи и геймификация нужны для первого кадра, словарь — только вкладке «Английский».
+    QFuture<TaskManager::Preload> tasksLoaded = QtConcurrent::run(&TaskManager::preload);
+    QFuture<GameStats::Preload> statsLoaded = QtConcurrent::run(&GameStats::preload);
+    englishLoaded = QtConcurrent::run([this]() { englishData.load(); });
+
     setWindowTitle("Выполнение задач по дням");
 #ifdef POL_MOBILE
     setMinimumSize(320, 480);
@@ -46,117 +79,47 @@ MainWindow::MainWindow(QWidget *parent)
     resize(1000, 700);
 #endif
 
-    // Глобальные стили — фиолетовая тема
-    QString styleSheet = R"(
-        QMainWindow { background-color: #f5f3ff; }
-        QWidget { background-color: #f5f3ff; font-family: 'Segoe UI', sans-serif; }
-
-        QFrame#headerFrame {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #7c3aed, stop:1 #6d28d9);
-            border-radius: 12px;
-            padding: 16px;
-        }
-        QLabel#dateLabel {
-            color: #f5f3ff;
-            font-size: 16pt;
-            font-weight: bold;
-            letter-spacing: 0.5px;
-        }
-        QDateEdit#dateSelector {
-            background-color: rgba(255,255,255,0.95);
-            color: #0d0d0d;
-            border: none;
-            border-radius: 8px;
-            padding: 8px 12px;
-            font-size: 12pt;
-            min-width: 120px;
-        }
-        QDateEdit#dateSelector:hover { background-color: white; }
-        QDateEdit#dateSelector::drop-down {
-            border: none;
-            background: transparent;
-        }
-
-        QTableWidget#tasksTable {
-            background-color: white;
-            border-radius: 12px;
-            border: 1px solid #c4b5fd;
-            gridline-color: #ddd6fe;
-            padding: 4px;
-            alternate-background-color: #faf5ff;
-        }
-        QTableWidget#tasksTable::item {
-            padding: 12px 8px;
-            font-size: 11pt;
-            color: #0d0d0d;
-        }
-        QTableWidget#tasksTable::item:selected {
-            background-color: #ede9fe;
-            color: #0d0d0d;
-        }
-        QHeaderView::section {
-            background: #ede9fe;
-            color: #0d0d0d;
-            padding: 14px 8px;
-            border: none;
-            border-bottom: 2px solid #c4b5fd;
-            border-right: 1px solid #ddd6fe;
-            font-weight: bold;
-            font-size: 11pt;
-        }
-        QHeaderView::section:first { border-top-left-radius: 8px; }
-        QHeaderView::section:last { border-top-right-radius: 8px; }
-        QTableWidget#tasksTable QTableCornerButton::section {
-            background: #ede9fe;
-            border-top-left-radius: 8px;
-        }
-
-        QPushButton#addButton {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #8b5cf6, stop:1 #7c3aed);
-            color: white;
-            border: none;
-            border-radius: 10px;
-            padding: 14px 28px;
-            font-size: 13pt;
-            font-weight: bold;
-        }
-        QPushButton#addButton:hover {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #a78bfa, stop:1 #8b5cf6);
-        }
-        QPushButton#addButton:pressed {
-            background: #6d28d9;
-        }
-
-        QScrollBar:vertical {
-            background: #ede9fe;
-            width: 10px;
-            border-radius: 5px;
-            margin: 2px;
-        }
-        QScrollBar::handle:vertical {
-            background: #c4b5fd;
-            border-radius: 5px;
-            min-height: 30px;
-        }
-        QScrollBar::handle:vertical:hover { background: #a78bfa; }
-        QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical { height: 0; }
-    )";
-    setStyleSheet(styleSheet);
+    setupUI();
 
-    // Загружаем задачи из файла
-    taskManager->loadFromFile();
+    gameStats.loadPreloaded(statsLoaded.result());
+    gameStats.checkStreak(QDate::currentDate());
+    refreshGameWidget();
 
-    setupUI();
+    taskManager->loadPreloaded(tasksLoaded.result());
     updateDailyTasks();
+    tasksTable->viewport()->installEventFilter(this);
+    connect(taskManager, &TaskManager::tasksChanged, this, &MainWindow::onTasksChanged);
+    connect(taskManager, &TaskManager::dayChanged, this, &MainWindow::onDayChanged);
+    connect(taskManager, &TaskManager::undoStateChanged, this, &MainWindow::updateUndoButtons);
+    connect(taskManager, &TaskManager::statusRestored, this, &MainWindow::onStatusRestored);
+
+    // Напоминания о сроках
+    reminders = new ReminderScheduler(taskManager, this);
+    connect(reminders, &ReminderScheduler::taskDue, this, &MainWindow::onTaskDue);
+    connect(reminders, &ReminderScheduler::taskOverdue, this, &MainWindow::onTaskOverdue);
+    reminders->resync();
+
+    // «Что дальше»: счёт пересчитывается только у изменённых задач
+    ranking = new TaskRanking(taskManager, this);
+    connect(ranking, &TaskRanking::rankingChanged, this, &MainWindow::refreshNextUp);
+
+    setupMemoryBudget();
+
+    // Синхронизация и слежение за файлами не задерживают первый кадр
+    QTimer::singleShot(0, this, &MainWindow::startSync);
+    QTimer::singleShot(0, ranking, &TaskRanking::rebuild);
+    QTimer::singleShot(0, this, &MainWindow::startWatching);
 }
 
 MainWindow::~MainWindow() {
+    // Фоновая загрузка словаря пишет в englishData — дожидаемся её
+    englishLoaded.waitForFinished();
+    delete storeWatcher;
+    delete syncEngine;
     // Сохраняем задачи перед закрытием
     taskManager->saveToFile();
     delete taskManager;
+    StorageBackend::shutdown();
 }
 
 void MainWindow::setupUI() {
@@ -176,43 +139,92 @@ void MainWindow::setupUI() {
     tabWidget = new QTabWidget(this);
     tabWidget->setDocumentMode(true);
     tabWidget->tabBar()->setExpanding(true);
-    tabWidget->setStyleSheet(R"(
-        QTabWidget::pane {
-            border: 1px solid #c4b5fd;
-            border-radius: 12px;
-            background: #ffffff;
-            top: -1px;
-        }
-        QTabBar::tab {
-            background: #ede9fe;
-            color: #5b21b6;
-            padding: 14px 20px;
-            margin-right: 2px;
-            border-top-left-radius: 8px;
-            border-top-right-radius: 8px;
-            font-weight: bold;
-            font-size: 12pt;
-            min-width: 80px;
-        }
-        QTabBar::tab:selected {
-            background: #ffffff;
-            color: #6d28d9;
-            border: 1px solid #c4b5fd;
-            border-bottom: none;
-        }
-        QTabBar::tab:hover:!selected {
-            background: #ddd6fe;
-            color: #5b21b6;
-        }
-    )");
+    tabWidget->setObjectName("tabWidget");
 
     setupTasksTab();
-    setupEnglishTab();
-    setupPrayerTab();
+    englishPage = new QWidget(this);
+    tabWidget->addTab(englishPage, "🇬🇧 Английский");
+    prayerPage = new QWidget(this);
+    tabWidget->addTab(prayerPage, "✝ Молитва");
+    connect(tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onTabActivated);
 
     mainLayout->addWidget(tabWidget);
 }
 
+void MainWindow::onTabActivated(int index) {
+    QWidget* page = tabWidget->widget(index);
+    if (page == englishPage && !englishTabBuilt) {
+        englishTabBuilt = true;
+        setupEnglishTab();
+    } else if (page == prayerPage && !prayerTabBuilt) {
+        prayerTabBuilt = true;
+        setupPrayerTab();
+    } else if (page == prayerPage && prayerImageEvicted) {
+        loadPrayerImageForChapter();
+    }
+}
+
+void MainWindow::setupMemoryBudget() {
+    memoryBudget = new MemoryBudget(this);
+    prayerPixmaps.setMaxCost(memoryBudget->isLowMemoryMode() ? PRAYER_CACHE_LOW_MEMORY_KB : PRAYER_CACHE_KB);
+    memoryBudget->registerCache("prayerImages", MemoryBudget::EvictFirst,
+        [this]() { return qint64(prayerPixmaps.totalCost()) * 1024 + shownPrayerImageBytes(); },
+        [this]() { evictPrayerImages(); });
+    // Пока словарь грузится в фоне, его не трогаем
+    memoryBudget->registerCache("englishVocabulary", MemoryBudget::EvictNormal,
+        [this]() { return englishLoaded.isFinished() ? englishData.residentBytes() : qint64(0); },
+        [this]() { if (englishLoaded.isFinished()) englishData.unload(); });
+    if (memoryBudget->isLowMemoryMode()) {
+        taskManager->setUndoBudget(UNDO_LOW_MEMORY_KB * 1024);
+    }
+    memoryBudget->registerCache("taskPartitions", MemoryBudget::EvictLast,
+        [this]() { return taskManager->residentBytes(); },
+        [this]() { taskManager->evictIdlePartitions(0); });
+
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState state) {
+        if (state == Qt::ApplicationActive && prayerImageEvicted && tabWidget->currentWidget() == prayerPage) {
+            loadPrayerImageForChapter();
+        }
+    });
+}
+
+void MainWindow::evictPrayerImages() {
+    prayerPixmaps.clear();
+    // Видимое изображение оставляем, пока на него смотрят
+    bool visible = tabWidget->currentWidget() == prayerPage && qApp->applicationState() == Qt::ApplicationActive;
+    if (prayerTabBuilt && !visible && shownPrayerImageBytes() > 0) {
+        prayerImageLabel->setPixmap(QPixmap());
+        prayerImageEvicted = true;
+    }
+}
+
+qint64 MainWindow::shownPrayerImageBytes() const {
+    if (!prayerTabBuilt || !prayerImageLabel->pixmap() || prayerImageLabel->pixmap()->isNull()) {
+        return 0;
+    }
+    const QPixmap* pix = prayerImageLabel->pixmap();
+    return qint64(pix->width()) * pix->height() * pix->depth() / 8;
+}
+
+bool MainWindow::eventFilter(QObject* watched, QEvent* event) {
+    if (event->type() == QEvent::Paint && watched == tasksTable->viewport()) {
+        // Отчёт — после того как текущий кадр дорисован и выведен
+        tasksTable->viewport()->removeEventFilter(this);
+        QTimer::singleShot(0, this, &MainWindow::reportFirstFrame);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::reportFirstFrame() {
+    qint64 elapsedNs = Trace::nowNs() - startupNs;
+    firstFrameMsecs = elapsedNs / 1000000;
+    if (Trace::isEnabled()) {
+        Trace::record("MainWindow::timeToFirstFrame", startupNs, elapsedNs);
+    }
+    qInfo() << "Первый кадр через" << firstFrameMsecs << "мс";
+    emit firstFrameShown(firstFrameMsecs);
+}
+
 void MainWindow::setupTasksTab() {
     QWidget* tasksPage = new QWidget(this);
     QVBoxLayout* layout = new QVBoxLayout(tasksPage);
@@ -222,34 +234,27 @@ void MainWindow::setupTasksTab() {
 
     // Блок геймификации — синий
     QFrame* gameFrame = new QFrame(this);
-    gameFrame->setObjectName("headerFrame");
-    gameFrame->setStyleSheet("QFrame#headerFrame { background: qlineargradient(x1:0,y1:0,x2:1,y2:0, stop:0 #2563eb, stop:1 #1d4ed8); border-radius: 12px; padding: 12px; }");
+    gameFrame->setObjectName("gameFrame");
     QHBoxLayout* gameLayout = new QHBoxLayout(gameFrame);
     levelLabel = new QLabel(this);
-    levelLabel->setStyleSheet("color: #0d0d0d; font-size: 14pt; font-weight: bold;");
+    levelLabel->setObjectName("levelLabel");
     xpBar = new QProgressBar(this);
     xpBar->setTextVisible(true);
     xpBar->setFormat("%v / %m XP");
-    xpBar->setStyleSheet(R"(
-        QProgressBar {
-            border: 1px solid #1e40af;
-            border-radius: 8px;
-            background: rgba(255,255,255,0.85);
-            text-align: center;
-            color: #0d0d0d;
-            font-weight: bold;
-            font-size: 11pt;
-        }
-        QProgressBar::chunk { background: #93c5fd; border-radius: 6px; }
-    )");
+    xpBar->setObjectName("xpBar");
     xpBar->setMinimum(0);
     streakLabel = new QLabel(this);
-    streakLabel->setStyleSheet("color: #0d0d0d; font-size: 12pt; font-weight: bold;");
+    streakLabel->setObjectName("streakLabel");
     gameLayout->addWidget(levelLabel);
     gameLayout->addWidget(xpBar, 1);
     gameLayout->addWidget(streakLabel);
     layout->addWidget(gameFrame);
 
+    // История выполнения по дням; число лет — heatmap/years в settings.ini
+    HeatmapWidget* heatmap = new HeatmapWidget(taskManager, this);
+    heatmap->setYearCount(AppSettings::value("heatmap/years", 1).toInt());
+    layout->addWidget(heatmap);
+
     // Заголовок и выбор даты
     QFrame* headerFrame = new QFrame(this);
     headerFrame->setObjectName("headerFrame");
@@ -266,9 +271,16 @@ void MainWindow::setupTasksTab() {
     dateSelector->setDisplayFormat("dd.MM.yyyy");
     connect(dateSelector, &QDateEdit::dateChanged, this, &MainWindow::onDateChanged);
 
+    QPushButton* agendaButton = new QPushButton("📅 Лента", this);
+    agendaButton->setObjectName("agendaButton");
+    agendaButton->setCheckable(true);
+    agendaButton->setCursor(Qt::PointingHandCursor);
+    connect(agendaButton, &QPushButton::toggled, this, &MainWindow::onAgendaToggled);
+
     headerLayout->addWidget(dateLabel);
     headerLayout->addWidget(dateSelector);
     headerLayout->addStretch();
+    headerLayout->addWidget(agendaButton);
 
     layout->addWidget(headerFrame);
 
@@ -294,24 +306,68 @@ void MainWindow::setupTasksTab() {
     connect(tasksTable, &QTableWidget::cellChanged,
             this, &MainWindow::onTaskStatusChanged);
 
-    layout->addWidget(tasksTable, 1);
+    taskViews = new QStackedWidget(this);
+    taskViews->addWidget(tasksTable);
+    layout->addWidget(taskViews, 1);
+
+    // Первые места рейтинга (см. TaskRanking); заполняется после первого кадра
+    QGroupBox* nextUpBox = new QGroupBox("⏭ Что дальше", this);
+    nextUpBox->setObjectName("nextUpBox");
+    QVBoxLayout* nextUpLayout = new QVBoxLayout(nextUpBox);
+    nextUpList = new QListWidget(this);
+    nextUpList->setObjectName("nextUpList");
+    nextUpList->setMaximumHeight(isMobile() ? 120 : 140);
+    nextUpLayout->addWidget(nextUpList);
+    layout->addWidget(nextUpBox);
+    connect(nextUpList, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem* item) {
+        const Task* task = taskManager->getTask(item->data(Qt::UserRole).toLongLong());
+        if (task) {
+            showTaskDialog(task);
+        }
+    });
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
     addButton = new QPushButton("➕ Добавить задачу", this);
     addButton->setObjectName("addButton");
     addButton->setCursor(Qt::PointingHandCursor);
     connect(addButton, &QPushButton::clicked, this, &MainWindow::onAddTask);
+    undoButton = new QPushButton("↶ Отменить", this);
+    undoButton->setObjectName("undoButton");
+    undoButton->setEnabled(false);
+    connect(undoButton, &QPushButton::clicked, this, &MainWindow::onUndo);
+    redoButton = new QPushButton("↷ Повторить", this);
+    redoButton->setObjectName("redoButton");
+    redoButton->setEnabled(false);
+    connect(redoButton, &QPushButton::clicked, this, &MainWindow::onRedo);
+    // Только на вкладке задач: в полях ввода словаря Ctrl+Z отменяет набор текста
+    QShortcut* undoShortcut = new QShortcut(QKeySequence::Undo, tasksPage);
+    undoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(undoShortcut, &QShortcut::activated, this, &MainWindow::onUndo);
+    QShortcut* redoShortcut = new QShortcut(QKeySequence::Redo, tasksPage);
+    redoShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(redoShortcut, &QShortcut::activated, this, &MainWindow::onRedo);
+    buttonLayout->addWidget(undoButton);
+    buttonLayout->addWidget(redoButton);
     buttonLayout->addStretch();
     buttonLayout->addWidget(addButton);
     buttonLayout->addStretch();
+
+    QPushButton* backupButton = new QPushButton("💾 Резервная копия", this);
+    backupButton->setObjectName("backupButton");
+    connect(backupButton, &QPushButton::clicked, this, &MainWindow::onBackupExport);
+    QPushButton* restoreButton = new QPushButton("📂 Восстановить", this);
+    restoreButton->setObjectName("restoreButton");
+    connect(restoreButton, &QPushButton::clicked, this, &MainWindow::onBackupImport);
+    buttonLayout->addWidget(backupButton);
+    buttonLayout->addWidget(restoreButton);
     layout->addLayout(buttonLayout);
 
     tabWidget->addTab(tasksPage, "📋 Задачи");
-    refreshGameWidget();
 }
 
 void MainWindow::setupEnglishTab() {
-    QWidget* englishPage = new QWidget(this);
+    TRACE_SCOPE("MainWindow::setupEnglishTab");
+    englishLoaded.waitForFinished();
     QHBoxLayout* mainLayout = new QHBoxLayout(englishPage);
     mainLayout->setContentsMargins(16, 16, 16, 16);
     QSplitter* splitter = new QSplitter(Qt::Horizontal);
@@ -319,18 +375,18 @@ void MainWindow::setupEnglishTab() {
     QWidget* leftPanel = new QWidget(this);
     QVBoxLayout* leftLayout = new QVBoxLayout(leftPanel);
     QLabel* levelTitle = new QLabel("Уровень", this);
-    levelTitle->setStyleSheet("font-weight: bold; font-size: 12pt; color: #0d0d0d;");
+    Theme::setRole(levelTitle, "sectionTitle");
     englishLevelCombo = new QComboBox(this);
+    englishLevelCombo->setObjectName("englishLevelCombo");
     for (int i = 0; i < EnglishData::LEVEL_COUNT; i++) {
         englishLevelCombo->addItem(EnglishData::levelName(i));
     }
-    englishLevelCombo->setStyleSheet("QComboBox { background: white; color: #0d0d0d; border-radius: 8px; border: 1px solid #c4b5fd; padding: 8px; }");
     connect(englishLevelCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onEnglishLevelChanged);
 
     QLabel* lessonTitle = new QLabel("Уроки (1 — 50)", this);
-    lessonTitle->setStyleSheet("font-weight: bold; font-size: 12pt; color: #0d0d0d;");
+    Theme::setRole(lessonTitle, "sectionTitle");
     englishLessonList = new QListWidget(this);
-    englishLessonList->setStyleSheet("QListWidget { background: white; color: #0d0d0d; border-radius: 8px; border: 1px solid #c4b5fd; padding: 4px; }");
+    englishLessonList->setObjectName("englishLessonList");
     for (int i = 1; i <= EnglishData::LESSONS_PER_LEVEL; i++) {
         englishLessonList->addItem(QString::number(i));
     }
@@ -345,12 +401,12 @@ void MainWindow::setupEnglishTab() {
     QWidget* rightPanel = new QWidget(this);
     QVBoxLayout* rightLayout = new QVBoxLayout(rightPanel);
     QLabel* wordsTitle = new QLabel("Слова урока", this);
-    wordsTitle->setStyleSheet("font-weight: bold; font-size: 12pt; color: #0d0d0d;");
+    Theme::setRole(wordsTitle, "sectionTitle");
     englishWordsTable = new QTableWidget(this);
+    englishWordsTable->setObjectName("englishWordsTable");
     englishWordsTable->setColumnCount(2);
     englishWordsTable->setHorizontalHeaderLabels(QStringList() << "Слово" << "Перевод");
     englishWordsTable->horizontalHeader()->setStretchLastSection(true);
-    englishWordsTable->setStyleSheet("QTableWidget { background: white; color: #0d0d0d; border-radius: 8px; border: 1px solid #e2e8f0; }");
     rightLayout->addWidget(wordsTitle);
 
     QHBoxLayout* addRowLayout = new QHBoxLayout();
@@ -359,9 +415,9 @@ void MainWindow::setupEnglishTab() {
     englishTranslationEdit = new QLineEdit(this);
     englishTranslationEdit->setPlaceholderText("Перевод");
     englishAddWordBtn = new QPushButton("➕ Добавить", this);
-    englishAddWordBtn->setStyleSheet("QPushButton { background: #4c6ef5; color: white; border-radius: 8px; padding: 8px 16px; font-weight: bold; }");
+    englishAddWordBtn->setObjectName("englishAddWordBtn");
     englishRemoveWordBtn = new QPushButton("Удалить", this);
-    englishRemoveWordBtn->setStyleSheet("QPushButton { background: #e2e8f0; color: #0d0d0d; border-radius: 8px; padding: 8px 16px; }");
+    englishRemoveWordBtn->setObjectName("englishRemoveWordBtn");
     addRowLayout->addWidget(englishWordEdit);
     addRowLayout->addWidget(englishTranslationEdit);
     addRowLayout->addWidget(englishAddWordBtn);
@@ -374,7 +430,6 @@ void MainWindow::setupEnglishTab() {
     splitter->addWidget(rightPanel);
     splitter->setSizes(QList<int>() << 140 << 400);
     mainLayout->addWidget(splitter);
-    tabWidget->addTab(englishPage, "🇬🇧 Английский");
     onEnglishLessonSelected(0);
 }
 
@@ -384,7 +439,7 @@ void MainWindow::onEnglishLevelChanged(int) {
 }
 
 void MainWindow::setupPrayerTab() {
-    QWidget* prayerPage = new QWidget(this);
+    TRACE_SCOPE("MainWindow::setupPrayerTab");
     QVBoxLayout* mainLayout = new QVBoxLayout(prayerPage);
     mainLayout->setContentsMargins(16, 16, 16, 16);
 
@@ -393,11 +448,11 @@ void MainWindow::setupPrayerTab() {
     prayerImageLabel->setMinimumSize(200, 150);
     prayerImageLabel->setMaximumSize(500, 220);
     prayerImageLabel->setAlignment(Qt::AlignCenter);
-    prayerImageLabel->setStyleSheet("QLabel { background: #f8fafc; border: 2px dashed #cbd5e1; border-radius: 12px; color: #0d0d0d; font-size: 11pt; }");
+    prayerImageLabel->setObjectName("prayerImageLabel");
     prayerImageLabel->setText("Изображение для молитвы\n(добавьте фото)");
     prayerImageLabel->setScaledContents(false);
     prayerAddImageBtn = new QPushButton("🖼 Добавить изображение", this);
-    prayerAddImageBtn->setStyleSheet("QPushButton { background: #475569; color: #f8fafc; border-radius: 8px; padding: 10px 20px; font-weight: bold; } QPushButton:hover { background: #334155; }");
+    prayerAddImageBtn->setObjectName("prayerAddImageBtn");
     connect(prayerAddImageBtn, &QPushButton::clicked, this, &MainWindow::onPrayerAddImage);
     imageRow->addWidget(prayerImageLabel, 1);
     imageRow->addWidget(prayerAddImageBtn);
@@ -408,19 +463,19 @@ void MainWindow::setupPrayerTab() {
     QWidget* leftPanel = new QWidget(this);
     QVBoxLayout* leftLayout = new QVBoxLayout(leftPanel);
     QLabel* gospelLabel = new QLabel("Евангелие", this);
-    gospelLabel->setStyleSheet("font-weight: bold; font-size: 12pt; color: #0d0d0d;");
+    Theme::setRole(gospelLabel, "sectionTitle");
     prayerGospelCombo = new QComboBox(this);
+    prayerGospelCombo->setObjectName("prayerGospelCombo");
     prayerGospelCombo->addItem("Евангелие от Марка", 16);
     prayerGospelCombo->addItem("Евангелие от Матфея", 28);
     prayerGospelCombo->addItem("Евангелие от Луки", 24);
     prayerGospelCombo->addItem("Евангелие от Иоанна", 21);
-    prayerGospelCombo->setStyleSheet("QComboBox { background: white; color: #0d0d0d; border-radius: 8px; border: 1px solid #c4b5fd; padding: 8px; }");
     connect(prayerGospelCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::onPrayerGospelChanged);
 
     QLabel* chLabel = new QLabel("Главы", this);
-    chLabel->setStyleSheet("font-weight: bold; font-size: 12pt; color: #1e293b;");
+    Theme::setRole(chLabel, "sectionTitle");
     prayerChapterList = new QListWidget(this);
-    prayerChapterList->setStyleSheet("QListWidget { background: white; color: #1e293b; border-radius: 8px; border: 1px solid #cbd5e1; padding: 4px; }");
+    prayerChapterList->setObjectName("prayerChapterList");
     connect(prayerChapterList, &QListWidget::currentRowChanged, this, &MainWindow::onPrayerChapterSelected);
 
     leftLayout->addWidget(gospelLabel);
@@ -432,37 +487,30 @@ void MainWindow::setupPrayerTab() {
     QWidget* rightPanel = new QWidget(this);
     QVBoxLayout* rightLayout = new QVBoxLayout(rightPanel);
     QLabel* textLabel = new QLabel("Текст главы", this);
-    textLabel->setStyleSheet("font-weight: bold; font-size: 12pt; color: #0d0d0d;");
+    Theme::setRole(textLabel, "sectionTitle");
     prayerChapterText = new QTextEdit(this);
     prayerChapterText->setReadOnly(true);
-    prayerChapterText->setStyleSheet("QTextEdit { background: #faf5ff; color: #0d0d0d; border-radius: 8px; border: 1px solid #c4b5fd; padding: 12px; font-size: 11pt; }");
+    prayerChapterText->setObjectName("prayerChapterText");
     rightLayout->addWidget(textLabel);
     rightLayout->addWidget(prayerChapterText, 1);
     splitter->addWidget(rightPanel);
     splitter->setSizes(QList<int>() << 180 << 400);
     mainLayout->addWidget(splitter, 1);
 
-    tabWidget->addTab(prayerPage, "✝ Молитва");
     onPrayerGospelChanged(0);
     loadPrayerImageForChapter();
 }
 
 void MainWindow::refreshGameWidget() {
-    int xp = gameStats.getXP();
-    int need = gameStats.getXPForNextLevel();
-    int currentLevelXP = 0;
-    for (int i = 1; i < gameStats.getLevel(); i++) currentLevelXP += i * 10;
-    int xpInLevel = xp - currentLevelXP;
-    int needInLevel = gameStats.getLevel() * 10;
-
     levelLabel->setText(QString("⭐ Уровень %1").arg(gameStats.getLevel()));
-    xpBar->setMaximum(needInLevel);
-    xpBar->setValue(xpInLevel);
+    xpBar->setMaximum(gameStats.getXPForNextLevel());
+    xpBar->setValue(gameStats.getXPInLevel());
     streakLabel->setText(QString("🔥 Серия: %1 дн.").arg(gameStats.getStreak()));
 }
 
 void MainWindow::onEnglishLessonSelected(int index) {
     if (index < 0) return;
+    TRACE_SCOPE("MainWindow::populateWordsTable");
     QList<EnglishWord> words = englishData.getWords(index);
     englishWordsTable->setRowCount(words.size());
     for (int i = 0; i < words.size(); i++) {
@@ -479,6 +527,7 @@ void MainWindow::onEnglishAddWord() {
     QString trans = englishTranslationEdit->text().trimmed();
     if (word.isEmpty()) return;
     englishData.addWord(lessonIndex, word, trans);
+    if (syncEngine) syncEngine->noteEnglishLesson(lessonIndex);
     englishWordEdit->clear();
     englishTranslationEdit->clear();
     onEnglishLessonSelected(lessonRow);
@@ -490,10 +539,12 @@ void MainWindow::onEnglishRemoveWord() {
     if (lessonRow < 0 || wordRow < 0) return;
     int lessonIndex = englishLevelCombo->currentIndex() * EnglishData::LESSONS_PER_LEVEL + lessonRow;
     englishData.removeWord(lessonIndex, wordRow);
+    if (syncEngine) syncEngine->noteEnglishLesson(lessonIndex);
     onEnglishLessonSelected(lessonRow);
 }
 
 void MainWindow::onPrayerGospelChanged(int index) {
+    TRACE_SCOPE("MainWindow::populateChapterList");
     int chapters = prayerGospelCombo->itemData(index).toInt();
     prayerChapterList->clear();
     for (int i = 1; i <= chapters; i++) {
@@ -523,6 +574,7 @@ QString MainWindow::prayerImagePath(int gospelIndex, int chapterNum) const {
 }
 
 void MainWindow::loadPrayerImageForChapter() {
+    prayerImageEvicted = false;
     int gospelIndex = prayerGospelCombo->currentIndex();
     int chapterRow = prayerChapterList->currentRow();
     if (chapterRow < 0) {
@@ -537,11 +589,20 @@ void MainWindow::loadPrayerImageForChapter() {
         prayerImageLabel->setText("Изображение главы " + QString::number(chapterNum) + "\n(добавьте фото)");
         return;
     }
+    QPixmap* cached = prayerPixmaps.object(path);
+    if (cached) {
+        prayerImageLabel->setPixmap(*cached);
+        prayerImageLabel->setText("");
+        return;
+    }
+    TRACE_SCOPE("MainWindow::decodePrayerImage");
     QPixmap pix(path);
     if (pix.isNull()) return;
     pix = pix.scaled(500, 220, Qt::KeepAspectRatio, Qt::SmoothTransformation);
     prayerImageLabel->setPixmap(pix);
     prayerImageLabel->setText("");
+    int costKb = qMax(1, int(qint64(pix.width()) * pix.height() * pix.depth() / 8 / 1024));
+    prayerPixmaps.insert(path, new QPixmap(pix), costKb);
 }
 
 void MainWindow::onPrayerAddImage() {
@@ -566,70 +627,127 @@ void MainWindow::onPrayerAddImage() {
         QMessageBox::warning(this, "Ошибка", "Не удалось сохранить изображение.");
         return;
     }
+    prayerPixmaps.remove(savePath);
     pix = pix.scaled(500, 220, Qt::KeepAspectRatio, Qt::SmoothTransformation);
     prayerImageLabel->setPixmap(pix);
     prayerImageLabel->setText("");
 }
 
 void MainWindow::updateDailyTasks() {
+    TRACE_SCOPE("MainWindow::updateDailyTasks");
+    // Заполнение ячеек не должно доходить до onTaskStatusChanged
+    QSignalBlocker blocker(tasksTable);
     tasksTable->setRowCount(0);
 
     QDate selectedDate = dateSelector->date();
-    QList<Task> allTasks = taskManager->getAllTasks();
+    // Задачи со сроком на выбранную дату (раздел месяца подгружается при необходимости)
+    QList<Task> dayTasks = taskManager->getTasksForDate(selectedDate);
 
-    // Фильтруем задачи по выбранной дате (задачи со сроком на эту дату)
     int row = 0;
-    for (const Task& task : allTasks) {
-        if (task.getDeadline() == selectedDate) {
-            tasksTable->insertRow(row);
-            tasksTable->setRowHeight(row, isMobile() ? 56 : 52);
-
-            // Чекбокс выполнения
-            QTableWidgetItem* statusItem = new QTableWidgetItem();
-            statusItem->setFlags(statusItem->flags() | Qt::ItemIsUserCheckable);
-            statusItem->setCheckState(task.getStatus() == TaskStatus::Completed ? Qt::Checked : Qt::Unchecked);
-            statusItem->setData(Qt::UserRole, task.getId());
-            statusItem->setTextAlignment(Qt::AlignCenter);
-            tasksTable->setItem(row, 0, statusItem);
-
-            // Название
-            QTableWidgetItem* titleItem = new QTableWidgetItem(task.getTitle());
-            titleItem->setFont(QFont("Segoe UI", 11, QFont::Medium));
-            titleItem->setForeground(QColor(13, 13, 13));
-            if (task.getStatus() == TaskStatus::Completed) {
-                titleItem->setForeground(QColor(45, 45, 45));
-                titleItem->setFont(QFont("Segoe UI", 11, QFont::Normal));
-            }
-            tasksTable->setItem(row, 1, titleItem);
+    for (const Task& task : dayTasks) {
+        tasksTable->insertRow(row);
+        fillTaskRow(row, task);
+        row++;
+    }
 
-            // Описание
-            QTableWidgetItem* descItem = new QTableWidgetItem(task.getDescription());
-            descItem->setForeground(QColor(13, 13, 13));
-            if (task.getStatus() == TaskStatus::Completed) {
-                descItem->setForeground(QColor(60, 60, 60));
-            }
-            tasksTable->setItem(row, 2, descItem);
-
-            // Приоритет
-            QTableWidgetItem* priorityItem = new QTableWidgetItem(task.priorityToString());
-            priorityItem->setBackground(getPriorityColor(task.getPriority()));
-            priorityItem->setForeground(getPriorityTextColor(task.getPriority()));
-            priorityItem->setTextAlignment(Qt::AlignCenter);
-            priorityItem->setFont(QFont("Segoe UI", 10, QFont::Medium));
-            tasksTable->setItem(row, 3, priorityItem);
-
-            // Категория
-            QTableWidgetItem* catItem = new QTableWidgetItem(task.getCategory().isEmpty() ? "—" : task.getCategory());
-            catItem->setForeground(QColor(13, 13, 13));
-            tasksTable->setItem(row, 4, catItem);
-
-            row++;
+    tasksTable->resizeColumnsToContents();
+    updateDateLabel();
+}
+
+void MainWindow::fillTaskRow(int row, const Task& task) {
+    tasksTable->setRowHeight(row, isMobile() ? 56 : 52);
+
+    // Чекбокс выполнения
+    QTableWidgetItem* statusItem = new QTableWidgetItem();
+    statusItem->setFlags(statusItem->flags() | Qt::ItemIsUserCheckable);
+    statusItem->setCheckState(task.getStatus() == TaskStatus::Completed ? Qt::Checked : Qt::Unchecked);
+    statusItem->setData(Qt::UserRole, task.getId());
+    statusItem->setData(Qt::UserRole + 1, task.getRecurrenceId());
+    statusItem->setData(Qt::UserRole + 2, task.getOccurrenceDate());
+    statusItem->setTextAlignment(Qt::AlignCenter);
+    tasksTable->setItem(row, 0, statusItem);
+
+    // Название: замок — ждёт невыполненную задачу, в скобках — выполнено подзадач
+    QString title = task.getTitle();
+    const TaskGraph& graph = taskManager->getTaskGraph();
+    if (graph.isBlocked(task.getId())) {
+        title.prepend("🔒 ");
+    }
+    TaskGraph::Progress progress = graph.progress(task.getId());
+    if (progress.total > 0) {
+        title += QString("  (%1/%2)").arg(progress.done).arg(progress.total);
+    }
+    QTableWidgetItem* titleItem = new QTableWidgetItem(title);
+    titleItem->setFont(QFont("Segoe UI", 11, QFont::Medium));
+    titleItem->setForeground(QColor(13, 13, 13));
+    if (task.getStatus() == TaskStatus::Completed) {
+        titleItem->setForeground(QColor(45, 45, 45));
+        titleItem->setFont(QFont("Segoe UI", 11, QFont::Normal));
+    }
+    tasksTable->setItem(row, 1, titleItem);
+
+    // Описание
+    QTableWidgetItem* descItem = new QTableWidgetItem(task.getDescription());
+    descItem->setForeground(QColor(13, 13, 13));
+    if (task.getStatus() == TaskStatus::Completed) {
+        descItem->setForeground(QColor(60, 60, 60));
+    }
+    tasksTable->setItem(row, 2, descItem);
+
+    // Приоритет
+    QTableWidgetItem* priorityItem = new QTableWidgetItem(task.priorityToString());
+    priorityItem->setBackground(getPriorityColor(task.getPriority()));
+    priorityItem->setForeground(getPriorityTextColor(task.getPriority()));
+    priorityItem->setTextAlignment(Qt::AlignCenter);
+    priorityItem->setFont(QFont("Segoe UI", 10, QFont::Medium));
+    tasksTable->setItem(row, 3, priorityItem);
+
+    // Категория
+    QTableWidgetItem* catItem = new QTableWidgetItem(task.getCategory().isEmpty() ? "—" : task.getCategory());
+    catItem->setForeground(QColor(13, 13, 13));
+    tasksTable->setItem(row, 4, catItem);
+}
+
+int MainWindow::findTaskRow(TaskId taskId) const {
+    for (int row = 0; row < tasksTable->rowCount(); ++row) {
+        QTableWidgetItem* item = tasksTable->item(row, 0);
+        if (item && item->data(Qt::UserRole).toLongLong() == taskId) {
+            return row;
         }
     }
+    return -1;
+}
 
-    tasksTable->resizeColumnsToContents();
+bool MainWindow::restoreOccurrenceRow(int row, const QDate& date) {
+    // Сохранённое вхождение исчезло (например, отменена первая отметка привычки) —
+    // если правило всё ещё показывает этот день, строка снова становится виртуальной
+    QTableWidgetItem* item = tasksTable->item(row, 0);
+    int ruleId = item ? item->data(Qt::UserRole + 1).toInt() : 0;
+    if (ruleId == 0 || item->data(Qt::UserRole + 2).toDate() != date) {
+        return false;
+    }
+    for (const Task& occurrence : taskManager->getTasksForDate(date)) {
+        if (occurrence.getId() == 0 && occurrence.getRecurrenceId() == ruleId) {
+            fillTaskRow(row, occurrence);
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Обновляем заголовок
+int MainWindow::findOccurrenceRow(int ruleId, const QDate& date) const {
+    for (int row = 0; row < tasksTable->rowCount(); ++row) {
+        QTableWidgetItem* item = tasksTable->item(row, 0);
+        if (item && item->data(Qt::UserRole).toLongLong() == 0
+            && item->data(Qt::UserRole + 1).toInt() == ruleId && item->data(Qt::UserRole + 2).toDate() == date) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void MainWindow::updateDateLabel() {
+    QDate selectedDate = dateSelector->date();
     QString dateStr = selectedDate.toString("dd.MM.yyyy");
     if (selectedDate == QDate::currentDate()) {
         dateStr = "Сегодня (" + dateStr + ")";
@@ -638,117 +756,229 @@ void MainWindow::updateDailyTasks() {
     } else if (selectedDate == QDate::currentDate().addDays(-1)) {
         dateStr = "Вчера (" + dateStr + ")";
     }
-    dateLabel->setText("Задачи на: " + dateStr + " (" + QString::number(row) + " задач)");
+    dateLabel->setText("Задачи на: " + dateStr + " (" + QString::number(tasksTable->rowCount()) + " задач)");
 }
 
 void MainWindow::showTaskDialog(const Task* task) {
-    QDialog dialog(this);
-    dialog.setWindowTitle(task ? "Редактировать задачу" : "Новая задача");
-    dialog.setMinimumWidth(520);
-    dialog.setStyleSheet(R"(
-        QDialog { background-color: #f8fafc; }
-        QLabel { color: #0d0d0d; font-size: 11pt; font-weight: bold; }
-        QLineEdit, QTextEdit, QDateEdit, QComboBox {
-            background-color: white;
-            color: #0d0d0d;
-            border: 2px solid #e2e8f0;
-            border-radius: 8px;
-            padding: 10px 12px;
-            font-size: 11pt;
-            selection-background-color: #e8f0fe;
+    if (!taskDialog) {
+        taskDialog = new TaskDialog(this);
+    }
+    // Копия: подбор связанных задач может загрузить разделы
+    bool editing = task != nullptr;
+    Task original;
+    if (editing) {
+        original = *task;
+    }
+
+    // Родитель и зависимости — из невыполненных задач за месяц до и после срока
+    QDate around = editing ? original.getDeadline() : dateSelector->date();
+    if (!around.isValid()) {
+        around = dateSelector->date();
+    }
+    QList<Task> candidates;
+    QSet<TaskId> listed;
+    for (const Task& candidate : taskManager->getTasksInRange(around.addDays(-31), around.addDays(31))) {
+        if (candidate.getId() != 0 && candidate.getStatus() == TaskStatus::Pending) {
+            candidates.append(candidate);
+            listed.insert(candidate.getId());
+        }
+    }
+    QList<TaskId> linked = original.getBlockedBy();
+    linked.append(original.getParentId());
+    for (TaskId id : linked) {
+        const Task* other = taskManager->getTask(id);
+        if (other && !listed.contains(id)) {
+            candidates.append(*other);
+            listed.insert(id);
         }
-        QLineEdit:focus, QTextEdit:focus, QDateEdit:focus, QComboBox:focus {
-            border-color: #5c7cfa;
+    }
+    taskDialog->setLinkCandidates(candidates);
+    taskDialog->setTask(editing ? &original : nullptr, dateSelector->date());
+
+    if (taskDialog->exec() == QDialog::Accepted) {
+        Task newTask = original;
+        taskDialog->applyTo(newTask);
+
+        const TaskGraph& graph = taskManager->getTaskGraph();
+        bool cyclic = editing && newTask.getParentId() != 0 &&
+                      graph.createsParentCycle(newTask.getId(), newTask.getParentId());
+        for (TaskId blocker : newTask.getBlockedBy()) {
+            cyclic = cyclic || (editing && graph.createsCycle(newTask.getId(), blocker));
         }
-        QComboBox::drop-down { border: none; padding-right: 8px; }
-        QComboBox QAbstractItemView { background: white; border-radius: 8px; }
-        QPushButton {
-            background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
-                stop:0 #5c7cfa, stop:1 #4c6ef5);
-            color: white;
-            border: none;
-            border-radius: 8px;
-            padding: 10px 20px;
-            font-weight: bold;
-            font-size: 11pt;
+        if (cyclic) {
+            QMessageBox::warning(this, "Связи задач",
+                                 "Задача не может через цепочку связей ждать саму себя. Такие связи не сохранены.");
         }
-        QPushButton:hover { background: #4c6ef5; }
-    )");
-
-    QFormLayout* form = new QFormLayout(&dialog);
-    form->setSpacing(14);
-    form->setContentsMargins(24, 24, 24, 24);
-
-    QLineEdit* titleEdit = new QLineEdit(&dialog);
-    titleEdit->setPlaceholderText("Введите название задачи");
-    QTextEdit* descriptionEdit = new QTextEdit(&dialog);
-    descriptionEdit->setPlaceholderText("Описание (необязательно)");
-    descriptionEdit->setMaximumHeight(100);
-    QDateEdit* deadlineEdit = new QDateEdit(&dialog);
-    deadlineEdit->setDate(dateSelector->date());
-    deadlineEdit->setCalendarPopup(true);
-    deadlineEdit->setDisplayFormat("dd.MM.yyyy");
-    QComboBox* priorityCombo = new QComboBox(&dialog);
-    priorityCombo->addItem("Низкий", static_cast<int>(Priority::Low));
-    priorityCombo->addItem("Средний", static_cast<int>(Priority::Medium));
-    priorityCombo->addItem("Высокий", static_cast<int>(Priority::High));
-    QLineEdit* categoryEdit = new QLineEdit(&dialog);
-    categoryEdit->setPlaceholderText("Например: Английский, Молитва");
 
-    if (task) {
-        titleEdit->setText(task->getTitle());
-        descriptionEdit->setPlainText(task->getDescription());
-        deadlineEdit->setDate(task->getDeadline());
-        priorityCombo->setCurrentIndex(static_cast<int>(task->getPriority()));
-        categoryEdit->setText(task->getCategory());
+        if (editing) {
+            taskManager->updateTask(newTask);
+        } else {
+            taskManager->addTask(newTask);
+        }
+    }
+}
+
+void MainWindow::onAddTask() {
+    showTaskDialog();
+}
+
+void MainWindow::refreshNextUp() {
+    TRACE_SCOPE("MainWindow::refreshNextUp");
+    nextUpList->clear();
+    QDate today = QDate::currentDate();
+    for (TaskId taskId : ranking->top(NEXT_UP_COUNT)) {
+        const Task* task = taskManager->getTask(taskId);
+        if (!task) {
+            continue;
+        }
+        qint64 days = today.daysTo(task->getDeadline());
+        QString when = days < 0 ? QString("просрочено на %1 дн.").arg(-days)
+                     : days == 0 ? QString("сегодня")
+                     : days == 1 ? QString("завтра")
+                     : task->getDeadline().toString("dd.MM");
+        QListWidgetItem* item = new QListWidgetItem(task->getTitle() + " — " + when, nextUpList);
+        item->setData(Qt::UserRole, task->getId());
     }
+    if (nextUpList->count() == 0) {
+        QListWidgetItem* item = new QListWidgetItem("Срочных задач нет", nextUpList);
+        item->setFlags(Qt::NoItemFlags);
+    }
+}
 
-    form->addRow("Название:", titleEdit);
-    form->addRow("Описание:", descriptionEdit);
-    form->addRow("Срок:", deadlineEdit);
-    form->addRow("Приоритет:", priorityCombo);
-    form->addRow("Категория:", categoryEdit);
+void MainWindow::onUndo() {
+    if (taskManager->undo()) {
+        statusBar()->showMessage("Действие отменено", 3000);
+    }
+}
 
-    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
-    if (QPushButton* cancelBtn = buttons->button(QDialogButtonBox::Cancel)) {
-        cancelBtn->setObjectName("cancelButton");
+void MainWindow::onRedo() {
+    if (taskManager->redo()) {
+        statusBar()->showMessage("Действие повторено", 3000);
     }
-    form->addRow(buttons);
+}
 
-    dialog.setStyleSheet(dialog.styleSheet() + R"(
-        QPushButton#cancelButton {
-            background: #e2e8f0;
-            color: #0d0d0d;
-        }
-        QPushButton#cancelButton:hover { background: #cbd5e1; }
-    )");
+void MainWindow::updateUndoButtons() {
+    undoButton->setEnabled(taskManager->canUndo());
+    redoButton->setEnabled(taskManager->canRedo());
+}
 
-    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
-    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+void MainWindow::onStatusRestored(TaskId taskId, TaskStatus status, const QDate& day) {
+    // Отмена отметки возвращает и XP, как снятие галочки вручную
+    if (!day.isValid()) {
+        return;
+    }
+    if (status == TaskStatus::Completed) {
+        gameStats.addTaskCompleted(taskId, day);
+    } else {
+        gameStats.removeTaskCompleted(taskId, day);
+    }
+    refreshGameWidget();
+}
 
-    if (dialog.exec() == QDialog::Accepted) {
-        Task newTask;
-        if (task) {
-            newTask = *task;
-        }
-        newTask.setTitle(titleEdit->text());
-        newTask.setDescription(descriptionEdit->toPlainText());
-        newTask.setDeadline(deadlineEdit->date());
-        newTask.setPriority(static_cast<Priority>(priorityCombo->currentData().toInt()));
-        newTask.setCategory(categoryEdit->text());
+void MainWindow::onBackupExport() {
+    QString suggested = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
+        "/pol_backup_" + QDate::currentDate().toString("yyyy-MM-dd") + ".polbak";
+    QString path = QFileDialog::getSaveFileName(this, "Резервная копия", suggested, "Резервная копия (*.polbak)");
+    if (path.isEmpty()) {
+        return;
+    }
+    // Несохранённые правки задач — на диск, архив собирается из файлов
+    taskManager->saveToFile();
+    StorageBackend::instance()->checkpoint();
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    bool ok = runBackupJob("Создание резервной копии…", [path, dataDir](const BackupArchive::Progress& progress, QString* error) {
+        return BackupArchive::write(path, dataDir, progress, error);
+    });
+    if (ok) {
+        statusBar()->showMessage("Резервная копия сохранена: " + path, 5000);
+    }
+}
 
-        if (task) {
-            taskManager->updateTask(newTask);
-        } else {
-            taskManager->addTask(newTask);
-        }
+void MainWindow::onBackupImport() {
+    QString path = QFileDialog::getOpenFileName(this, "Восстановить из резервной копии", QString(),
+                                                "Резервная копия (*.polbak)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (QMessageBox::question(this, "Восстановление",
+            "Задачи, слова, уровень и изображения молитв будут заменены данными из копии. Продолжить?")
+        != QMessageBox::Yes) {
+        return;
+    }
+    englishLoaded.waitForFinished();
+    // Файлы базы заменяются: фоновые чтения дожидаемся, соединения закрываем
+    QThreadPool::globalInstance()->waitForDone();
+    StorageBackend::shutdown();
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    bool ok = false;
+    {
+        // Пока идёт восстановление, задачи не выгружаются и не пишутся в хранилище
+        TaskManager::Batch hold(taskManager);
+        ok = runBackupJob("Восстановление…", [path, dataDir](const BackupArchive::Progress& progress, QString* error) {
+            return BackupArchive::restore(path, dataDir, progress, error);
+        });
+    }
+    if (ok) {
+        // Копия из SQLite содержит базу, из JSON — только файлы; при расхождении
+        // с настройкой storage/backend данные перенесутся при открытии хранилища
+        StorageBackend::setActiveKind(QFile::exists(dataDir + "/pol.sqlite") ? StorageBackend::Sqlite
+                                                                              : StorageBackend::Json);
+        reloadAllData();
+        statusBar()->showMessage("Данные восстановлены", 5000);
+    }
+}
 
-        updateDailyTasks();
+bool MainWindow::runBackupJob(const QString& label, const std::function<bool(const BackupArchive::Progress&, QString*)>& job) {
+    // Работа идёт в пуле потоков; окно прогресса модальное, чтобы данные не менялись по ходу
+    QProgressDialog dialog(label, QString(), 0, 100, this);
+    dialog.setWindowModality(Qt::WindowModal);
+    dialog.setMinimumDuration(0);
+    dialog.setValue(0);
+
+    QProgressDialog* target = &dialog;
+    int lastPercent = 0;
+    BackupArchive::Progress progress = [target, lastPercent](qint64 done, qint64 total) mutable {
+        int percent = total > 0 ? int(done * 100 / total) : 100;
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            QMetaObject::invokeMethod(target, "setValue", Qt::QueuedConnection, Q_ARG(int, percent));
+        }
+    };
+    QString error;
+    QFutureWatcher<bool> watcher;
+    QEventLoop loop;
+    connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+    watcher.setFuture(QtConcurrent::run([job, progress, &error]() { return job(progress, &error); }));
+    loop.exec();
+
+    bool ok = watcher.result();
+    dialog.reset();
+    if (!ok) {
+        QMessageBox::warning(this, "Ошибка", error);
     }
+    return ok;
 }
 
-void MainWindow::onAddTask() {
-    showTaskDialog();
+void MainWindow::reloadAllData() {
+    taskManager->loadFromFile();
+    englishData.load();
+    gameStats.load();
+    gameStats.checkStreak(QDate::currentDate());
+    refreshGameWidget();
+    if (syncEngine) {
+        // Задачи сверяются по tasksChanged; словарь отмечаем явно —
+        // без реальных отличий по хэшу на сервер ничего не уйдёт
+        for (int i = 0; i < EnglishData::LESSON_COUNT; i++) {
+            syncEngine->noteEnglishLesson(i);
+        }
+    }
+    if (englishTabBuilt) {
+        onEnglishLessonSelected(englishLessonList->currentRow());
+    }
+    if (prayerTabBuilt) {
+        prayerPixmaps.clear();
+        loadPrayerImageForChapter();
+    }
 }
 
 void MainWindow::onTaskStatusChanged(int row, int column) {
@@ -760,24 +990,175 @@ void MainWindow::onTaskStatusChanged(int row, int column) {
     // Блокируем сигналы, чтобы избежать рекурсии
     tasksTable->blockSignals(true);
 
-    int taskId = item->data(Qt::UserRole).toInt();
-    Task* task = taskManager->getTask(taskId);
-    if (task) {
-        TaskStatus newStatus = item->checkState() == Qt::Checked ? TaskStatus::Completed : TaskStatus::Pending;
-        task->setStatus(newStatus);
-        taskManager->updateTask(*task);
+    // Таблица перестраивается по tasksChanged и item удаляется — читаем всё заранее
+    TaskId taskId = item->data(Qt::UserRole).toLongLong();
+    int ruleId = item->data(Qt::UserRole + 1).toInt();
+    QDate occurrenceDate = item->data(Qt::UserRole + 2).toDate();
+    TaskStatus newStatus = item->checkState() == Qt::Checked ? TaskStatus::Completed : TaskStatus::Pending;
+    setTaskStatus(taskId, ruleId, occurrenceDate, newStatus);
+
+    tasksTable->blockSignals(false);
+}
+
+void MainWindow::setTaskStatus(TaskId taskId, int ruleId, const QDate& occurrenceDate, TaskStatus newStatus) {
+    bool updated = false;
+    QDate completedDay;     // когда была поставлена снимаемая отметка
+    {
+        TaskManager::Batch batch(taskManager);
+        if (taskId == 0 && ruleId != 0) {
+            // Вхождение повторяющейся задачи сохраняется при первой отметке
+            taskId = taskManager->materializeOccurrence(ruleId, occurrenceDate);
+        }
+        const Task* task = taskManager->getTask(taskId);
+        if (task && task->getStatus() != newStatus) {
+            completedDay = task->getCompletedAt().date();
+            Task changed = *task;
+            changed.setStatus(newStatus);
+            taskManager->updateTask(changed);
+            updated = true;
+        }
+    }
+    if (updated) {
         if (newStatus == TaskStatus::Completed) {
-            gameStats.addTaskCompleted();
-            refreshGameWidget();
+            gameStats.addTaskCompleted(taskId);
+        } else if (completedDay.isValid()) {
+            gameStats.removeTaskCompleted(taskId, completedDay);
         }
-        updateDailyTasks();
+        refreshGameWidget();
     }
-
-    tasksTable->blockSignals(false);
 }
 
 void MainWindow::onDateChanged() {
     updateDailyTasks();
+    if (agendaView) {
+        agendaView->scrollToDay(dateSelector->date());
+    }
+}
+
+void MainWindow::onAgendaToggled(bool shown) {
+    if (shown && !agendaView) {
+        TRACE_SCOPE("MainWindow::buildAgenda");
+        AgendaModel* agenda = new AgendaModel(taskManager, this);
+        connect(agenda, &AgendaModel::statusToggled, this,
+                [this](TaskId taskId, int ruleId, const QDate& occurrenceDate, bool completed) {
+            setTaskStatus(taskId, ruleId, occurrenceDate,
+                          completed ? TaskStatus::Completed : TaskStatus::Pending);
+        });
+        agendaView = new AgendaView(agenda, this);
+        agendaView->setObjectName("agendaView");
+        taskViews->addWidget(agendaView);
+    }
+    taskViews->setCurrentWidget(shown ? static_cast<QWidget*>(agendaView) : tasksTable);
+    if (shown) {
+        agendaView->scrollToDay(dateSelector->date());
+    }
+}
+
+void MainWindow::onTasksChanged(const QList<TaskId>& taskIds) {
+    // Пустой список — перезагрузка набора (правила, импорт)
+    if (taskIds.isEmpty() || taskIds.size() > INCREMENTAL_ROWS_LIMIT) {
+        updateDailyTasks();
+        return;
+    }
+    // Остальное — правка на месте: меняются только строки изменённых задач
+    TRACE_SCOPE("MainWindow::onTasksChanged");
+    QSignalBlocker blocker(tasksTable);
+    QDate selectedDate = dateSelector->date();
+    for (TaskId taskId : taskIds) {
+        const Task* task = taskManager->getTask(taskId);
+        bool shown = task && task->getDeadline() == selectedDate;
+        int row = findTaskRow(taskId);
+        if (row < 0 && shown && task->getRecurrenceId() != 0) {
+            // Сохранённое вхождение правила занимает строку своего виртуального двойника
+            row = findOccurrenceRow(task->getRecurrenceId(), task->getOccurrenceDate());
+        }
+        if (!shown) {
+            if (row >= 0 && !restoreOccurrenceRow(row, selectedDate)) {
+                tasksTable->removeRow(row);
+            }
+            continue;
+        }
+        if (row < 0) {
+            row = tasksTable->rowCount();
+            tasksTable->insertRow(row);
+        }
+        fillTaskRow(row, *task);
+    }
+    tasksTable->resizeColumnsToContents();
+    updateDateLabel();
+}
+
+void MainWindow::onDayChanged(const QDate& today) {
+    gameStats.checkStreak(today);
+    refreshGameWidget();
+    // Если смотрели на «сегодня», переходим на новый день; иначе обновляем подписи «Сегодня/Вчера»
+    if (dateSelector->date() == today.addDays(-1)) {
+        dateSelector->setDate(today);
+    } else {
+        updateDailyTasks();
+    }
+}
+
+void MainWindow::startSync() {
+    QUrl url = AppSettings::value("sync/url").toUrl();
+    if (url.isEmpty()) {
+        SyncEngine::markUntracked();
+        return;
+    }
+    englishLoaded.waitForFinished();
+    syncEngine = new SyncEngine(taskManager, &englishData, &gameStats, this);
+    connect(syncEngine, &SyncEngine::statsChanged, this, &MainWindow::refreshGameWidget);
+    connect(syncEngine, &SyncEngine::englishChanged, this, &MainWindow::onRemoteEnglishChanged);
+    connect(syncEngine, &SyncEngine::syncFailed, this, [this](const QString& error) {
+        statusBar()->showMessage("Синхронизация недоступна: " + error, 5000);
+    });
+    syncEngine->setServerUrl(url);
+}
+
+void MainWindow::startWatching() {
+    if (StorageBackend::instance()->kind() != StorageBackend::Json) {
+        return;
+    }
+    storeWatcher = new StoreWatcher(taskManager, &englishData, this);
+    connect(storeWatcher, &StoreWatcher::englishChanged, this, &MainWindow::onExternalEnglishChanged);
+    // Словарь ещё может загружаться в фоне — следим за ним после загрузки
+    QFutureWatcher<void>* englishReady = new QFutureWatcher<void>(this);
+    connect(englishReady, &QFutureWatcherBase::finished, this, [this, englishReady]() {
+        storeWatcher->watchEnglish();
+        englishReady->deleteLater();
+    });
+    englishReady->setFuture(englishLoaded);
+}
+
+void MainWindow::onExternalEnglishChanged(const QList<int>& lessonIndexes) {
+    for (int lessonIndex : lessonIndexes) {
+        if (syncEngine) syncEngine->noteEnglishLesson(lessonIndex);
+        onRemoteEnglishChanged(lessonIndex);
+    }
+}
+
+void MainWindow::onRemoteEnglishChanged(int lessonIndex) {
+    if (!englishTabBuilt) {
+        return;
+    }
+    int shown = englishLevelCombo->currentIndex() * EnglishData::LESSONS_PER_LEVEL + englishLessonList->currentRow();
+    if (shown == lessonIndex) {
+        onEnglishLessonSelected(englishLessonList->currentRow());
+    }
+}
+
+void MainWindow::onTaskDue(TaskId taskId) {
+    const Task* task = taskManager->getTask(taskId);
+    if (task) {
+        statusBar()->showMessage("⏰ Сегодня срок: " + task->getTitle(), 15000);
+    }
+}
+
+void MainWindow::onTaskOverdue(TaskId taskId) {
+    const Task* task = taskManager->getTask(taskId);
+    if (task) {
+        statusBar()->showMessage("⚠ Просрочена задача: " + task->getTitle(), 15000);
+    }
 }
 
 QColor MainWindow::getPriorityColor(Priority priority) const {
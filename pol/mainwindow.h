@@ -16,9 +16,21 @@
 #include <QListWidget>
 #include <QProgressBar>
 #include <QStackedWidget>
+#include <QFuture>
+#include <QCache>
+#include <QPixmap>
 #include "taskmanager.h"
 #include "gamestats.h"
 #include "englishdata.h"
+#include "reminderscheduler.h"
+#include "backuparchive.h"
+
+class TaskDialog;
+class SyncEngine;
+class StoreWatcher;
+class MemoryBudget;
+class AgendaView;
+class TaskRanking;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -27,10 +39,28 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    qint64 timeToFirstFrame() const { return firstFrameMsecs; }  // -1, пока кадр не показан
+
+signals:
+    void firstFrameShown(qint64 msecs);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private slots:
     void onAddTask();
+    void onUndo();
+    void onRedo();
+    void updateUndoButtons();
+    void onStatusRestored(TaskId taskId, TaskStatus status, const QDate& day);
+    void refreshNextUp();
     void onTaskStatusChanged(int row, int column);
     void onDateChanged();
+    void onAgendaToggled(bool shown);
+    void onTasksChanged(const QList<TaskId>& taskIds);
+    void onTaskDue(TaskId taskId);
+    void onDayChanged(const QDate& today);
+    void onTaskOverdue(TaskId taskId);
     void refreshGameWidget();
     void onEnglishLevelChanged(int index);
     void onEnglishLessonSelected(int index);
@@ -39,6 +69,14 @@ private slots:
     void onPrayerGospelChanged(int index);
     void onPrayerChapterSelected(int index);
     void onPrayerAddImage();
+    void onTabActivated(int index);
+    void onBackupExport();
+    void onBackupImport();
+    void startSync();
+    void startWatching();
+    void onRemoteEnglishChanged(int lessonIndex);
+    void onExternalEnglishChanged(const QList<int>& lessonIndexes);
+    void reportFirstFrame();
 
 private:
     void setupUI();
@@ -48,22 +86,58 @@ private:
     void loadPrayerImageForChapter();
     QString prayerImagePath(int gospelIndex, int chapterNum) const;
     void updateDailyTasks();
+    void fillTaskRow(int row, const Task& task);
+    int findTaskRow(TaskId taskId) const;
+    int findOccurrenceRow(int ruleId, const QDate& date) const;
+    bool restoreOccurrenceRow(int row, const QDate& date);
+    void updateDateLabel();
     void showTaskDialog(const Task* task = nullptr);
+    void setTaskStatus(TaskId taskId, int ruleId, const QDate& occurrenceDate, TaskStatus newStatus);
+    bool runBackupJob(const QString& label, const std::function<bool(const BackupArchive::Progress&, QString*)>& job);
+    void reloadAllData();
+    void setupMemoryBudget();
+    void evictPrayerImages();
+    qint64 shownPrayerImageBytes() const;
     QColor getPriorityColor(Priority priority) const;
     QColor getPriorityTextColor(Priority priority) const;
     QString formatDate(const QDate& date) const;
     bool isMobile() const;
 
     TaskManager* taskManager;
+    ReminderScheduler* reminders;
+    TaskDialog* taskDialog;        // создаётся при первом открытии и переиспользуется
+    SyncEngine* syncEngine;        // только если задан sync/url в settings.ini
+    StoreWatcher* storeWatcher;    // правки файлов данных извне
+    MemoryBudget* memoryBudget;
     GameStats gameStats;
     EnglishData englishData;
+    QFuture<void> englishLoaded;
+
+    // Больше изменённых задач за раз — таблица перестраивается целиком
+    static const int INCREMENTAL_ROWS_LIMIT = 50;
+
+    // Запуск: время от конструктора до первой отрисовки таблицы задач
+    qint64 startupNs;
+    qint64 firstFrameMsecs;
 
     // Основные элементы
     QTabWidget* tabWidget;
     QDateEdit* dateSelector;
     QTableWidget* tasksTable;
     QPushButton* addButton;
+    QPushButton* undoButton;
+    QPushButton* redoButton;
     QLabel* dateLabel;
+    QStackedWidget* taskViews;     // таблица дня или лента
+    AgendaView* agendaView;        // создаётся при первом открытии ленты
+    TaskRanking* ranking;
+    QListWidget* nextUpList;       // первые места ranking
+
+    // Вкладки «Английский» и «Молитва» строятся при первом открытии
+    QWidget* englishPage;
+    QWidget* prayerPage;
+    bool englishTabBuilt;
+    bool prayerTabBuilt;
 
     // Геймификация
     QLabel* levelLabel;
@@ -85,6 +159,13 @@ private:
     QTextEdit* prayerChapterText;
     QLabel* prayerImageLabel;
     QPushButton* prayerAddImageBtn;
+    QCache<QString, QPixmap> prayerPixmaps;    // уменьшенные изображения глав, стоимость в КБ
+    bool prayerImageEvicted;                   // показанное изображение выгружено — вернуть при показе
+
+    static const int PRAYER_CACHE_KB = 16 * 1024;
+    static const int PRAYER_CACHE_LOW_MEMORY_KB = 2 * 1024;
+    static const int UNDO_LOW_MEMORY_KB = 256;     // история отмены в режиме экономии
+    static const int NEXT_UP_COUNT = 5;
 };
 
 #endif // MAINWINDOW_H
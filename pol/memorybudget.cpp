@@ -0,0 +1,147 @@
+#include "memorybudget.h"
+#include "appsettings.h"
+#include "trace.h"
+#include <QGuiApplication>
+#include <QTimer>
+#include <QFile>
+#include <QDebug>
+
+MemoryBudget::MemoryBudget(QObject* parent)
+    : QObject(parent), budget(0), lowMemory(false) {
+    qint64 totalKb = 0;
+    qint64 availableKb = 0;
+    bool smallDevice = readSystemMemory(totalKb, availableKb) && totalKb < qint64(LOW_MEMORY_DEVICE_MB) * 1024;
+    lowMemory = AppSettings::value("memory/lowMemory", smallDevice).toBool();
+    int budgetMb = AppSettings::value("memory/budgetMB", lowMemory ? LOW_MEMORY_BUDGET_MB : 0).toInt();
+    budget = qint64(qMax(0, budgetMb)) * 1024 * 1024;
+
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &MemoryBudget::onApplicationStateChanged);
+
+    // Qt не передаёт onTrimMemory из Android, поэтому свободную память системы
+    // проверяем сами — редко и грубым таймером
+    checkTimer = new QTimer(this);
+    checkTimer->setInterval(CHECK_INTERVAL_MSECS);
+    checkTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(checkTimer, &QTimer::timeout, this, &MemoryBudget::checkSystemMemory);
+#ifdef Q_OS_ANDROID
+    checkTimer->start();
+#else
+    if (lowMemory || budget > 0) {
+        checkTimer->start();
+    }
+#endif
+}
+
+void MemoryBudget::registerCache(const QString& name, Priority priority,
+                                 const SizeFunction& size, const EvictFunction& evict) {
+    Cache cache;
+    cache.name = name;
+    cache.priority = priority;
+    cache.size = size;
+    cache.evict = evict;
+    int i = 0;
+    while (i < caches.size() && caches[i].priority <= priority) {
+        i++;
+    }
+    caches.insert(i, cache);
+}
+
+void MemoryBudget::setBudget(qint64 bytes) {
+    budget = qMax<qint64>(0, bytes);
+    enforceBudget();
+}
+
+qint64 MemoryBudget::residentBytes() const {
+    qint64 total = 0;
+    for (const Cache& cache : caches) {
+        total += cache.size();
+    }
+    return total;
+}
+
+void MemoryBudget::trim(MemoryBudget::Pressure pressure) {
+    TRACE_SCOPE("MemoryBudget::trim");
+    qint64 freed = evictUpTo(pressure == Critical ? EvictLast : EvictFirst, 0);
+    if (freed > 0) {
+        qInfo() << "Освобождено памяти:" << freed / 1024 << "КБ";
+        emit trimmed(freed);
+    }
+}
+
+void MemoryBudget::enforceBudget() {
+    if (budget <= 0) {
+        return;
+    }
+    qint64 resident = residentBytes();
+    if (resident <= budget) {
+        return;
+    }
+    qint64 freed = evictUpTo(EvictLast, resident - budget);
+    if (freed > 0) {
+        emit trimmed(freed);
+    }
+}
+
+qint64 MemoryBudget::evictUpTo(Priority maxPriority, qint64 target) {
+    // target 0 — выгрузить все кэши до maxPriority включительно
+    qint64 freed = 0;
+    for (const Cache& cache : caches) {
+        if (cache.priority > maxPriority || (target > 0 && freed >= target)) {
+            break;
+        }
+        qint64 before = cache.size();
+        if (before == 0) {
+            continue;
+        }
+        cache.evict();
+        freed += qMax<qint64>(0, before - cache.size());
+    }
+    return freed;
+}
+
+void MemoryBudget::onApplicationStateChanged(Qt::ApplicationState state) {
+    if (state == Qt::ApplicationSuspended || state == Qt::ApplicationHidden) {
+        // Фоновые приложения система убивает первыми — чем меньше занято, тем дольше живём
+        trim(lowMemory ? Critical : Moderate);
+    }
+}
+
+void MemoryBudget::checkSystemMemory() {
+    qint64 totalKb = 0;
+    qint64 availableKb = 0;
+    if (readSystemMemory(totalKb, availableKb) && totalKb > 0) {
+        if (availableKb * 10 < totalKb) {
+            trim(Critical);
+        } else if (availableKb * 5 < totalKb) {
+            trim(Moderate);
+        }
+    }
+    enforceBudget();
+}
+
+bool MemoryBudget::readSystemMemory(qint64& totalKb, qint64& availableKb) {
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    QFile file("/proc/meminfo");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // Размер файлов /proc — 0, поэтому readAll, а не atEnd/readLine
+    totalKb = availableKb = -1;
+    for (const QByteArray& line : file.readAll().split('\n')) {
+        QList<QByteArray> parts = line.simplified().split(' ');
+        if (parts.size() < 2) {
+            continue;
+        }
+        if (parts[0] == "MemTotal:") {
+            totalKb = parts[1].toLongLong();
+        } else if (parts[0] == "MemAvailable:") {
+            availableKb = parts[1].toLongLong();
+        }
+    }
+    return totalKb > 0 && availableKb >= 0;
+#else
+    Q_UNUSED(totalKb);
+    Q_UNUSED(availableKb);
+    return false;
+#endif
+}
@@ -0,0 +1,77 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <functional>
+
+class QTimer;
+
+// Бюджет памяти: кэши (декодированные изображения, словарь, старые разделы задач)
+// регистрируются с приоритетом и выгружаются от первого к последнему, когда система
+// сообщает о нехватке памяти, приложение уходит в фон или сумма превышает бюджет.
+// Выгруженное перечитывается при следующем обращении.
+class MemoryBudget : public QObject {
+    Q_OBJECT
+
+public:
+    enum Priority {
+        EvictFirst = 0,     // пересоздаётся дёшево (декодированные изображения)
+        EvictNormal = 1,    // перечитывается из файла (словарь)
+        EvictLast = 2       // нужно для работы (разделы задач)
+    };
+
+    enum Pressure {
+        Moderate,   // освободить то, что пересоздаётся дёшево
+        Critical    // освободить всё, что можно
+    };
+
+    typedef std::function<qint64()> SizeFunction;      // занято сейчас, байт
+    typedef std::function<void()> EvictFunction;
+
+    explicit MemoryBudget(QObject* parent = nullptr);
+
+    void registerCache(const QString& name, Priority priority,
+                       const SizeFunction& size, const EvictFunction& evict);
+
+    // Режим экономии: мало ОЗУ у устройства или memory/lowMemory в settings.ini.
+    // В фоне тогда выгружается всё, а не только изображения
+    bool isLowMemoryMode() const { return lowMemory; }
+    qint64 getBudget() const { return budget; }          // 0 — без ограничения
+    void setBudget(qint64 bytes);
+    qint64 residentBytes() const;
+
+public slots:
+    void trim(MemoryBudget::Pressure pressure);
+    void enforceBudget();
+
+signals:
+    void trimmed(qint64 freedBytes);
+
+private slots:
+    void onApplicationStateChanged(Qt::ApplicationState state);
+    void checkSystemMemory();
+
+private:
+    struct Cache {
+        QString name;
+        Priority priority;
+        SizeFunction size;
+        EvictFunction evict;
+    };
+
+    static const int CHECK_INTERVAL_MSECS = 30 * 1000;
+    static const int LOW_MEMORY_DEVICE_MB = 3 * 1024;
+    static const int LOW_MEMORY_BUDGET_MB = 48;
+
+    QList<Cache> caches;        // по возрастанию приоритета
+    qint64 budget;
+    bool lowMemory;
+    QTimer* checkTimer;
+
+    qint64 evictUpTo(Priority maxPriority, qint64 target);
+    static bool readSystemMemory(qint64& totalKb, qint64& availableKb);
+};
+
+#endif // MEMORYBUDGET_H
@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -11,20 +11,37 @@ android {
     ANDROID_TARGET_SDK_VERSION = 33
 }
 
+# Ядро без интерфейса (задачи, словарь, геймификация, хранилище) — общее с pol-cli
+include(core/core.pri)
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
-    task.cpp \
-    taskmanager.cpp \
-    gamestats.cpp \
-    englishdata.cpp
+    reminderscheduler.cpp \
+    theme.cpp \
+    taskdialog.cpp \
+    syncprotocol.cpp \
+    syncengine.cpp \
+    storewatcher.cpp \
+    backuparchive.cpp \
+    memorybudget.cpp \
+    heatmapwidget.cpp \
+    agendamodel.cpp \
+    agendaview.cpp
 
 HEADERS += \
     mainwindow.h \
-    task.h \
-    taskmanager.h \
-    gamestats.h \
-    englishdata.h
+    reminderscheduler.h \
+    theme.h \
+    taskdialog.h \
+    syncprotocol.h \
+    syncengine.h \
+    storewatcher.h \
+    backuparchive.h \
+    memorybudget.h \
+    heatmapwidget.h \
+    agendamodel.h \
+    agendaview.h
 
 FORMS += \
     mainwindow.ui
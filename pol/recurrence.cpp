@@ -0,0 +1,180 @@
+#include "recurrence.h"
+#include "isodate.h"
+#include <QJsonArray>
+#include <algorithm>
+
+static int weekdayBit(int dayOfWeek) {
+    return 1 << (dayOfWeek - 1);
+}
+
+static int countBits(int mask) {
+    int n = 0;
+    while (mask) {
+        n += mask & 1;
+        mask >>= 1;
+    }
+    return n;
+}
+
+// Дни маски с понедельника по dayOfWeek включительно
+static int maskUpTo(int mask, int dayOfWeek) {
+    return mask & ((1 << dayOfWeek) - 1);
+}
+
+static QDate mondayOf(const QDate& date) {
+    return date.addDays(1 - date.dayOfWeek());
+}
+
+RecurrenceRule::RecurrenceRule()
+    : id(0), kind(RecurrenceKind::Daily), interval(1), weekdays(0x7f), count(0) {
+    prototype.setId(0);
+}
+
+RecurrenceRule::RecurrenceRule(const Task& prototype, RecurrenceKind kind, const QDate& startDate, int interval)
+    : id(0), prototype(prototype), kind(kind), startDate(startDate), interval(qMax(1, interval)),
+      weekdays(0x7f), count(0) {
+    this->prototype.setId(0);
+    if (kind == RecurrenceKind::Weekly && startDate.isValid()) {
+        weekdays = weekdayBit(startDate.dayOfWeek());
+    }
+}
+
+void RecurrenceRule::setPrototype(const Task& prototype) {
+    this->prototype = prototype;
+    this->prototype.setId(0);
+}
+
+bool RecurrenceRule::matchesPattern(const QDate& date) const {
+    if (!startDate.isValid() || date < startDate) {
+        return false;
+    }
+    if (until.isValid() && date > until) {
+        return false;
+    }
+    switch (kind) {
+        case RecurrenceKind::Weekly:
+            if (!(weekdays & weekdayBit(date.dayOfWeek()))) {
+                return false;
+            }
+            return (mondayOf(startDate).daysTo(mondayOf(date)) / 7) % interval == 0;
+        case RecurrenceKind::Daily:
+        case RecurrenceKind::EveryNDays:
+        default:
+            return startDate.daysTo(date) % interval == 0;
+    }
+}
+
+int RecurrenceRule::ordinal(const QDate& date) const {
+    if (kind != RecurrenceKind::Weekly) {
+        return static_cast<int>(startDate.daysTo(date) / interval) + 1;
+    }
+    // Полные активные недели до текущей + дни текущей недели до date,
+    // минус дни первой недели, пришедшиеся раньше startDate
+    qint64 week = mondayOf(startDate).daysTo(mondayOf(date)) / 7;
+    qint64 activeWeeksBefore = week == 0 ? 0 : (week - 1) / interval + 1;
+    int skippedInFirstWeek = countBits(maskUpTo(weekdays, startDate.dayOfWeek() - 1));
+    return static_cast<int>(activeWeeksBefore * countBits(weekdays))
+        + countBits(maskUpTo(weekdays, date.dayOfWeek())) - skippedInFirstWeek;
+}
+
+bool RecurrenceRule::occursOn(const QDate& date) const {
+    if (!matchesPattern(date) || skipped.contains(date.toJulianDay())) {
+        return false;
+    }
+    return count == 0 || ordinal(date) <= count;
+}
+
+QList<QDate> RecurrenceRule::occurrencesBetween(const QDate& from, const QDate& to) const {
+    QList<QDate> result;
+    if (!startDate.isValid()) {
+        return result;
+    }
+    QDate first = qMax(from, startDate);
+    QDate last = until.isValid() ? qMin(to, until) : to;
+    if (first > last) {
+        return result;
+    }
+
+    int n = -1;   // номер текущего вхождения, считаем от первого найденного
+    if (kind == RecurrenceKind::Weekly) {
+        for (QDate d = first; d <= last; d = d.addDays(1)) {
+            if (!matchesPattern(d)) {
+                continue;
+            }
+            n = n < 0 ? ordinal(d) : n + 1;
+            if (count > 0 && n > count) {
+                break;
+            }
+            if (!skipped.contains(d.toJulianDay())) {
+                result.append(d);
+            }
+        }
+    } else {
+        qint64 offset = startDate.daysTo(first) % interval;
+        QDate d = offset ? first.addDays(interval - offset) : first;
+        for (; d <= last; d = d.addDays(interval)) {
+            n = n < 0 ? ordinal(d) : n + 1;
+            if (count > 0 && n > count) {
+                break;
+            }
+            if (!skipped.contains(d.toJulianDay())) {
+                result.append(d);
+            }
+        }
+    }
+    return result;
+}
+
+Task RecurrenceRule::makeOccurrence(const QDate& date) const {
+    Task task = prototype;
+    task.setDeadline(date);
+    task.setRecurrence(id, date);
+    return task;
+}
+
+QJsonObject RecurrenceRule::toJson() const {
+    QJsonObject json;
+    json["id"] = id;
+    json["task"] = prototype.toJson();
+    json["kind"] = static_cast<int>(kind);
+    json["start"] = IsoDate::formatDate(startDate);
+    json["interval"] = interval;
+    json["weekdays"] = weekdays;
+    if (until.isValid()) {
+        json["until"] = IsoDate::formatDate(until);
+    }
+    if (count > 0) {
+        json["count"] = count;
+    }
+    if (!skipped.isEmpty()) {
+        QList<qint64> days = skipped.values();
+        std::sort(days.begin(), days.end());
+        QJsonArray arr;
+        for (qint64 jd : days) {
+            arr.append(IsoDate::formatDate(QDate::fromJulianDay(jd)));
+        }
+        json["skipped"] = arr;
+    }
+    return json;
+}
+
+RecurrenceRule RecurrenceRule::fromJson(const QJsonObject& json) {
+    RecurrenceRule rule;
+    rule.id = json["id"].toInt();
+    rule.setPrototype(Task::fromJson(json["task"].toObject()));
+    rule.kind = static_cast<RecurrenceKind>(json["kind"].toInt());
+    rule.startDate = IsoDate::parseDate(json["start"].toString());
+    rule.interval = qMax(1, json["interval"].toInt(1));
+    rule.weekdays = json["weekdays"].toInt(0x7f) & 0x7f;
+    if (json.contains("until")) {
+        rule.until = IsoDate::parseDate(json["until"].toString());
+    }
+    rule.count = json["count"].toInt(0);
+    for (const QJsonValue& v : json["skipped"].toArray()) {
+        QDate d = IsoDate::parseDate(v.toString());
+        if (d.isValid()) {
+            rule.skipped.insert(d.toJulianDay());
+        }
+    }
+    return rule;
+}
@@ -0,0 +1,61 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include "task.h"
+#include <QList>
+#include <QSet>
+#include <QDate>
+#include <QJsonObject>
+
+enum class RecurrenceKind {
+    Daily = 0,       // каждый день (или каждые interval дней)
+    Weekly = 1,      // по дням недели из weekdays, каждые interval недель
+    EveryNDays = 2   // каждые interval дней
+};
+
+// Правило повторения: хранится один раз, вхождения вычисляются по запросу.
+// Материализуются (становятся обычными Task) только выполненные или изменённые вхождения.
+class RecurrenceRule {
+public:
+    RecurrenceRule();
+    RecurrenceRule(const Task& prototype, RecurrenceKind kind, const QDate& startDate, int interval = 1);
+
+    int getId() const { return id; }
+    const Task& getPrototype() const { return prototype; }
+    RecurrenceKind getKind() const { return kind; }
+    QDate getStartDate() const { return startDate; }
+    int getInterval() const { return interval; }
+    int getWeekdays() const { return weekdays; }
+    QDate getUntil() const { return until; }
+    int getCount() const { return count; }
+
+    void setId(int id) { this->id = id; }
+    void setPrototype(const Task& prototype);
+    void setWeekdays(int mask) { weekdays = mask & 0x7f; }   // бит 0 — понедельник
+    void setUntil(const QDate& until) { this->until = until; }
+    void setCount(int count) { this->count = count; }       // 0 — без ограничения
+    void skipDate(const QDate& date) { skipped.insert(date.toJulianDay()); }
+
+    bool occursOn(const QDate& date) const;
+    QList<QDate> occurrencesBetween(const QDate& from, const QDate& to) const;
+    Task makeOccurrence(const QDate& date) const;
+
+    QJsonObject toJson() const;
+    static RecurrenceRule fromJson(const QJsonObject& json);
+
+private:
+    int id;
+    Task prototype;   // название, описание, приоритет, категория
+    RecurrenceKind kind;
+    QDate startDate;
+    int interval;
+    int weekdays;
+    QDate until;
+    int count;
+    QSet<qint64> skipped;   // удалённые вхождения (julian day)
+
+    bool matchesPattern(const QDate& date) const;
+    int ordinal(const QDate& date) const;   // номер вхождения (с 1) для date, совпадающей с шаблоном
+};
+
+#endif // RECURRENCE_H
@@ -0,0 +1,142 @@
+#include "reminderscheduler.h"
+#include "taskmanager.h"
+#include <QTimer>
+#include <QDateTime>
+#include <algorithm>
+
+ReminderScheduler::ReminderScheduler(TaskManager* taskManager, QObject* parent)
+    : QObject(parent), taskManager(taskManager), reminderTime(9, 0), nextGeneration(0) {
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    // Грубый таймер: системе проще объединить пробуждение с другими (батарея на Android)
+    timer->setTimerType(Qt::VeryCoarseTimer);
+    connect(timer, &QTimer::timeout, this, &ReminderScheduler::onTimeout);
+    connect(taskManager, &TaskManager::tasksChanged, this, &ReminderScheduler::onTasksChanged);
+    // Окно планирования сдвигается вместе с днём
+    connect(taskManager, &TaskManager::dayChanged, this, &ReminderScheduler::resync);
+}
+
+void ReminderScheduler::setReminderTime(const QTime& time) {
+    if (!time.isValid() || time == reminderTime) {
+        return;
+    }
+    reminderTime = time;
+    resync();
+}
+
+void ReminderScheduler::schedule(TaskId taskId, const QDate& deadline) {
+    QHash<TaskId, Scheduled>::const_iterator it = live.constFind(taskId);
+    if (it != live.constEnd() && it->deadline == deadline) {
+        return; // срок не изменился — уже запланировано
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 dueAt = QDateTime(deadline, reminderTime).toMSecsSinceEpoch();
+    qint64 overdueAt = QDateTime(deadline.addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+    if (overdueAt <= now) {
+        // Давно просроченные задачи повторно не напоминаем
+        cancel(taskId);
+        return;
+    }
+
+    Scheduled s;
+    s.generation = ++nextGeneration;
+    s.deadline = deadline;
+    live.insert(taskId, s);
+
+    Entry due = { qMax(dueAt, now), taskId, s.generation, Due };
+    Entry overdue = { overdueAt, taskId, s.generation, Overdue };
+    push(due);
+    push(overdue);
+    rearm();
+}
+
+void ReminderScheduler::cancel(TaskId taskId) {
+    // Записи в куче остаются и отбрасываются при извлечении
+    if (live.remove(taskId) > 0) {
+        compact();
+    }
+}
+
+void ReminderScheduler::resync() {
+    heap.clear();
+    live.clear();
+    QDate today = QDate::currentDate();
+    for (const Task& task : taskManager->getTasksInRange(today, today.addDays(SCHEDULE_DAYS_AHEAD))) {
+        if (task.getId() != 0 && task.getStatus() == TaskStatus::Pending) {
+            schedule(task.getId(), task.getDeadline());
+        }
+    }
+    rearm();
+}
+
+void ReminderScheduler::onTasksChanged(const QList<TaskId>& taskIds) {
+    if (taskIds.isEmpty()) {
+        resync();
+        return;
+    }
+    for (TaskId id : taskIds) {
+        const Task* task = taskManager->getTask(id);
+        if (!task || task->getStatus() == TaskStatus::Completed || !task->getDeadline().isValid()) {
+            cancel(id);
+        } else {
+            schedule(id, task->getDeadline());
+        }
+    }
+}
+
+void ReminderScheduler::onTimeout() {
+    qint64 horizon = QDateTime::currentMSecsSinceEpoch() + COALESCE_MSECS;
+    while (!heap.isEmpty() && heap.first().when <= horizon) {
+        Entry entry = heap.first();
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.removeLast();
+
+        QHash<TaskId, Scheduled>::const_iterator it = live.constFind(entry.taskId);
+        if (it == live.constEnd() || it->generation != entry.generation) {
+            continue; // отменено или перенесено
+        }
+        if (entry.kind == Due) {
+            emit taskDue(entry.taskId);
+        } else {
+            live.remove(entry.taskId);
+            emit taskOverdue(entry.taskId);
+        }
+    }
+    rearm();
+}
+
+void ReminderScheduler::push(const Entry& entry) {
+    heap.append(entry);
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+void ReminderScheduler::rearm() {
+    if (heap.isEmpty()) {
+        timer->stop();
+        return;
+    }
+    qint64 delay = heap.first().when - QDateTime::currentMSecsSinceEpoch();
+    timer->start(static_cast<int>(qBound<qint64>(0, delay, MAX_SLEEP_MSECS)));
+}
+
+void ReminderScheduler::compact() {
+    // На каждую живую задачу в куче не больше двух записей; остальное — мусор
+    if (heap.size() <= 4 * live.size() + 64) {
+        return;
+    }
+    QVector<Entry> kept;
+    kept.reserve(2 * live.size());
+    for (const Entry& entry : heap) {
+        QHash<TaskId, Scheduled>::const_iterator it = live.constFind(entry.taskId);
+        if (it != live.constEnd() && it->generation == entry.generation) {
+            kept.append(entry);
+        }
+    }
+    heap.swap(kept);
+    std::make_heap(heap.begin(), heap.end(), later);
+}
+
+bool ReminderScheduler::later(const Entry& a, const Entry& b) {
+    return a.when > b.when;
+}
@@ -0,0 +1,72 @@
+#ifndef REMINDERSCHEDULER_H
+#define REMINDERSCHEDULER_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QDate>
+#include <QTime>
+#include "task.h"
+
+class QTimer;
+class TaskManager;
+
+// Напоминания о сроках: один таймер, перевзводимый по минимальной куче времён.
+// Отмена и перенос — смена поколения задачи (O(1)) и push в кучу (O(log n));
+// устаревшие записи выбрасываются при извлечении. Все напоминания в пределах
+// COALESCE_MSECS срабатывают за одно пробуждение.
+class ReminderScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ReminderScheduler(TaskManager* taskManager, QObject* parent = nullptr);
+
+    void schedule(TaskId taskId, const QDate& deadline);
+    void cancel(TaskId taskId);
+    void resync();
+    int pendingCount() const { return live.size(); }
+
+    QTime getReminderTime() const { return reminderTime; }
+    void setReminderTime(const QTime& time);
+
+signals:
+    void taskDue(TaskId taskId);       // наступил день срока (в reminderTime)
+    void taskOverdue(TaskId taskId);   // день срока прошёл, задача не выполнена
+
+private slots:
+    void onTasksChanged(const QList<TaskId>& taskIds);
+    void onTimeout();
+
+private:
+    enum Kind { Due, Overdue };
+
+    struct Entry {
+        qint64 when;
+        TaskId taskId;
+        quint32 generation;
+        Kind kind;
+    };
+
+    struct Scheduled {
+        quint32 generation;
+        QDate deadline;
+    };
+
+    static const int COALESCE_MSECS = 60 * 1000;
+    static const int MAX_SLEEP_MSECS = 60 * 60 * 1000;
+    static const int SCHEDULE_DAYS_AHEAD = 90;
+
+    TaskManager* taskManager;
+    QTimer* timer;
+    QTime reminderTime;
+    QVector<Entry> heap;             // min-куча по when
+    QHash<TaskId, Scheduled> live;   // taskId -> актуальное поколение
+    quint32 nextGeneration;
+
+    static bool later(const Entry& a, const Entry& b);   // компаратор min-кучи
+    void push(const Entry& entry);
+    void rearm();
+    void compact();
+};
+
+#endif // REMINDERSCHEDULER_H
@@ -0,0 +1,439 @@
+#include "sqlitestorage.h"
+#include "jsonstorage.h"
+#include "trace.h"
+#include "isodate.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QCoreApplication>
+#include <QThread>
+#include <QAtomicInt>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDir>
+#include <QDebug>
+
+static QAtomicInt connectionCounter;
+
+static const char INSERT_TASK[] =
+    "INSERT OR REPLACE INTO tasks (id, partition, deadline, status, priority, category, completed_at, data) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
+
+static bool finish(QSqlDatabase& db, bool ok) {
+    if (ok) {
+        return db.commit();
+    }
+    db.rollback();
+    return false;
+}
+
+// Соединение для текущего потока: в главном — постоянное, в фоновых открывается
+// на одно обращение (соединение QtSql нельзя использовать из чужого потока)
+class SqliteStorage::Connection {
+public:
+    explicit Connection(const SqliteStorage* storage) {
+        bool owner = QThread::currentThread() == storage->ownerThread;
+        name = owner ? storage->connectionName
+                     : QString("pol-storage-tmp-%1").arg(connectionCounter.fetchAndAddRelaxed(1));
+        temporary = !owner;
+        if (QSqlDatabase::contains(name)) {
+            database = QSqlDatabase::database(name);
+            return;
+        }
+        database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(databasePath());
+        database.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        if (!database.open()) {
+            qWarning() << "Не удалось открыть базу:" << databasePath() << database.lastError().text();
+            return;
+        }
+        QSqlQuery pragma(database);
+        pragma.exec("PRAGMA journal_mode=WAL");
+        pragma.exec("PRAGMA synchronous=NORMAL");
+    }
+
+    ~Connection() {
+        if (!temporary) {
+            return;
+        }
+        database.close();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    QSqlDatabase& db() { return database; }
+    bool isOpen() const { return database.isOpen(); }
+
+private:
+    QSqlDatabase database;
+    QString name;
+    bool temporary;
+};
+
+SqliteStorage::SqliteStorage()
+    : ownerThread(QCoreApplication::instance() ? QCoreApplication::instance()->thread() : QThread::currentThread()),
+      connectionName(QString("pol-storage-%1").arg(connectionCounter.fetchAndAddRelaxed(1))),
+      ready(false) {
+    QDir().mkpath(JsonStorage::dataDirectory());
+    ready = createSchema();
+}
+
+SqliteStorage::~SqliteStorage() {
+    if (QThread::currentThread() == ownerThread && QSqlDatabase::contains(connectionName)) {
+        {
+            QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+QString SqliteStorage::databasePath() {
+    return JsonStorage::dataDirectory() + "/pol.sqlite";
+}
+
+bool SqliteStorage::exec(QSqlQuery& query) {
+    if (query.exec()) {
+        return true;
+    }
+    qWarning() << "Ошибка SQLite:" << query.lastError().text() << query.lastQuery();
+    return false;
+}
+
+bool SqliteStorage::createSchema() {
+    TRACE_SCOPE("SqliteStorage::createSchema");
+    Connection connection(this);
+    if (!connection.isOpen()) {
+        return false;
+    }
+    const char* statements[] = {
+        "CREATE TABLE IF NOT EXISTS tasks ("
+        " id INTEGER PRIMARY KEY,"
+        " partition INTEGER NOT NULL,"
+        " deadline TEXT,"
+        " status INTEGER NOT NULL,"
+        " priority INTEGER NOT NULL,"
+        " category TEXT NOT NULL,"
+        " completed_at TEXT,"           // только у выполненных, "yyyy-MM-ddTHH:mm:ss"
+        " data BLOB NOT NULL)",
+        "CREATE INDEX IF NOT EXISTS tasks_partition ON tasks(partition)",
+        "CREATE INDEX IF NOT EXISTS tasks_deadline ON tasks(deadline)",
+        "CREATE INDEX IF NOT EXISTS tasks_status ON tasks(status)",
+        "CREATE INDEX IF NOT EXISTS tasks_category ON tasks(category)",
+        "CREATE INDEX IF NOT EXISTS tasks_completed_at ON tasks(completed_at)",
+        "CREATE TABLE IF NOT EXISTS documents (name TEXT PRIMARY KEY, data BLOB NOT NULL)",
+        "CREATE TABLE IF NOT EXISTS lessons (lesson INTEGER PRIMARY KEY, words BLOB NOT NULL)",
+        "CREATE TABLE IF NOT EXISTS events (seq INTEGER PRIMARY KEY AUTOINCREMENT, data BLOB NOT NULL)",
+        "PRAGMA user_version = 1"
+    };
+    QSqlQuery query(connection.db());
+    for (const char* sql : statements) {
+        if (!query.prepare(sql) || !exec(query)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteStorage::insertTask(QSqlQuery& query, int key, const Task& task) {
+    bool completed = task.getStatus() == TaskStatus::Completed && !task.getCompletedAt().isNull();
+    query.bindValue(0, task.getId());
+    query.bindValue(1, key);
+    query.bindValue(2, task.getDeadline().isValid() ? IsoDate::formatDate(task.getDeadline()) : QVariant());
+    query.bindValue(3, static_cast<int>(task.getStatus()));
+    query.bindValue(4, static_cast<int>(task.getPriority()));
+    query.bindValue(5, task.getCategory());
+    query.bindValue(6, completed ? IsoDate::formatDateTime(task.getCompletedAt()) : QVariant());
+    query.bindValue(7, QJsonDocument(task.toJson()).toJson(QJsonDocument::Compact));
+    return exec(query);
+}
+
+bool SqliteStorage::readTaskRows(QSqlQuery& query, QList<Task>& out) {
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        out.append(Task::fromJson(QJsonDocument::fromJson(query.value(0).toByteArray()).object()));
+    }
+    return true;
+}
+
+QList<int> SqliteStorage::partitionKeys() {
+    QList<int> keys;
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT DISTINCT partition FROM tasks");
+    if (exec(query)) {
+        while (query.next()) {
+            keys.append(query.value(0).toInt());
+        }
+    }
+    return keys;
+}
+
+bool SqliteStorage::readPartition(int key, QList<Task>& out) {
+    TRACE_SCOPE("SqliteStorage::readPartition");
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT data FROM tasks WHERE partition = ?");
+    query.bindValue(0, key);
+    return readTaskRows(query, out);
+}
+
+bool SqliteStorage::writePartition(int key, const QList<Task>& tasks) {
+    TRACE_SCOPE("SqliteStorage::writePartition");
+    Connection connection(this);
+    QSqlDatabase& db = connection.db();
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM tasks WHERE partition = ?");
+    query.bindValue(0, key);
+    bool ok = exec(query);
+    query.prepare(INSERT_TASK);
+    for (int i = 0; ok && i < tasks.size(); ++i) {
+        ok = insertTask(query, key, tasks[i]);
+    }
+    return finish(db, ok);
+}
+
+bool SqliteStorage::removePartition(int key) {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("DELETE FROM tasks WHERE partition = ?");
+    query.bindValue(0, key);
+    return exec(query);
+}
+
+bool SqliteStorage::updatePartition(int key, const QList<Task>& tasks, const QSet<TaskId>& touched) {
+    TRACE_SCOPE("SqliteStorage::updatePartition");
+    Connection connection(this);
+    QSqlDatabase& db = connection.db();
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare(INSERT_TASK);
+    QSet<TaskId> removed = touched;
+    bool ok = true;
+    for (int i = 0; ok && i < tasks.size(); ++i) {
+        if (touched.contains(tasks[i].getId())) {
+            removed.remove(tasks[i].getId());
+            ok = insertTask(query, key, tasks[i]);
+        }
+    }
+    // Удалённые из раздела; задача, переехавшая в другой месяц, уже записана с новым разделом
+    query.prepare("DELETE FROM tasks WHERE id = ? AND partition = ?");
+    for (QSet<TaskId>::const_iterator it = removed.constBegin(); ok && it != removed.constEnd(); ++it) {
+        query.bindValue(0, *it);
+        query.bindValue(1, key);
+        ok = exec(query);
+    }
+    return finish(db, ok);
+}
+
+QByteArray SqliteStorage::readDocument(const QString& name) {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT data FROM documents WHERE name = ?");
+    query.bindValue(0, name);
+    if (exec(query) && query.next()) {
+        return query.value(0).toByteArray();
+    }
+    return QByteArray();
+}
+
+bool SqliteStorage::writeDocument(const QString& name, const QByteArray& data) {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    if (data.isEmpty()) {
+        query.prepare("DELETE FROM documents WHERE name = ?");
+        query.bindValue(0, name);
+    } else {
+        query.prepare("INSERT OR REPLACE INTO documents (name, data) VALUES (?, ?)");
+        query.bindValue(0, name);
+        query.bindValue(1, data);
+    }
+    return exec(query);
+}
+
+bool SqliteStorage::readLessons(QList<QList<EnglishWord>>& out) {
+    TRACE_SCOPE("SqliteStorage::readLessons");
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT lesson, words FROM lessons");
+    if (!exec(query)) {
+        return false;
+    }
+    QList<QList<EnglishWord>> lessons;
+    for (int i = 0; i < EnglishData::LESSON_COUNT; i++) {
+        lessons.append(QList<EnglishWord>());
+    }
+    bool any = false;
+    while (query.next()) {
+        int lesson = query.value(0).toInt();
+        if (lesson >= 0 && lesson < lessons.size()) {
+            lessons[lesson] = EnglishData::wordsFromJson(QJsonDocument::fromJson(query.value(1).toByteArray()).array());
+            any = true;
+        }
+    }
+    // Словаря ещё нет — как отсутствующий файл
+    if (!any) {
+        return false;
+    }
+    out = lessons;
+    return true;
+}
+
+bool SqliteStorage::writeLessons(const QList<QList<EnglishWord>>& lessons, const QList<int>& changed) {
+    Connection connection(this);
+    QSqlDatabase& db = connection.db();
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO lessons (lesson, words) VALUES (?, ?)");
+    bool ok = true;
+    for (int i = 0; ok && i < changed.size(); ++i) {
+        int lesson = changed[i];
+        if (lesson < 0 || lesson >= lessons.size()) {
+            continue;
+        }
+        query.bindValue(0, lesson);
+        query.bindValue(1, QJsonDocument(EnglishData::wordsToJson(lessons.at(lesson))).toJson(QJsonDocument::Compact));
+        ok = exec(query);
+    }
+    return finish(db, ok);
+}
+
+bool SqliteStorage::appendEvent(const QJsonObject& event) {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("INSERT INTO events (data) VALUES (?)");
+    query.bindValue(0, QJsonDocument(event).toJson(QJsonDocument::Compact));
+    return exec(query);
+}
+
+qint64 SqliteStorage::eventsEnd() {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT COALESCE(MAX(seq), 0) FROM events");
+    if (exec(query) && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+bool SqliteStorage::readEvents(qint64 from, QList<QJsonObject>& out) {
+    if (eventsEnd() < from) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT data FROM events WHERE seq > ? ORDER BY seq");
+    query.bindValue(0, from);
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        out.append(QJsonDocument::fromJson(query.value(0).toByteArray()).object());
+    }
+    return true;
+}
+
+bool SqliteStorage::clearEvents() {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("DELETE FROM events");
+    return exec(query);
+}
+
+bool SqliteStorage::selectTasks(TaskField field, const QVariant& value, QList<Task>& out) {
+    TRACE_SCOPE("SqliteStorage::selectTasks");
+    if (!ready) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    switch (field) {
+        case ByStatus: query.prepare("SELECT data FROM tasks WHERE status = ?"); break;
+        case ByPriority: query.prepare("SELECT data FROM tasks WHERE priority = ?"); break;
+        case ByCategory: query.prepare("SELECT data FROM tasks WHERE category = ?"); break;
+    }
+    query.bindValue(0, value);
+    return readTaskRows(query, out);
+}
+
+bool SqliteStorage::selectCategories(QStringList& out) {
+    if (!ready) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT DISTINCT category FROM tasks WHERE category <> ''");
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        out.append(query.value(0).toString());
+    }
+    out.sort();
+    return true;
+}
+
+bool SqliteStorage::countCompletedPerDay(const QDate& from, const QDate& to, QMap<QDate, int>& out) {
+    TRACE_SCOPE("SqliteStorage::countCompletedPerDay");
+    if (!ready) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    // Строки времени сравниваются как текст: диапазон идёт по индексу completed_at
+    query.prepare("SELECT substr(completed_at, 1, 10), COUNT(*) FROM tasks "
+                  "WHERE completed_at >= ? AND completed_at < ? GROUP BY 1");
+    query.bindValue(0, IsoDate::formatDate(from));
+    query.bindValue(1, IsoDate::formatDate(to.addDays(1)));
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        out.insert(IsoDate::parseDate(query.value(0).toString()), query.value(1).toInt());
+    }
+    return true;
+}
+
+bool SqliteStorage::countByCategory(QMap<QString, int>& out) {
+    if (!ready) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT category, COUNT(*) FROM tasks GROUP BY category");
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        out.insert(query.value(0).toString(), query.value(1).toInt());
+    }
+    return true;
+}
+
+bool SqliteStorage::countCompletedByWeekday(QMap<int, int>& out) {
+    if (!ready) {
+        return false;
+    }
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.prepare("SELECT CAST(strftime('%w', completed_at) AS INTEGER), COUNT(*) FROM tasks "
+                  "WHERE completed_at IS NOT NULL GROUP BY 1");
+    if (!exec(query)) {
+        return false;
+    }
+    while (query.next()) {
+        // SQLite: 0 — воскресенье; Qt: 1 — понедельник … 7 — воскресенье
+        int day = query.value(0).toInt();
+        out.insert(day == 0 ? 7 : day, query.value(1).toInt());
+    }
+    return true;
+}
+
+void SqliteStorage::checkpoint() {
+    Connection connection(this);
+    QSqlQuery query(connection.db());
+    query.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+}
@@ -0,0 +1,60 @@
+#ifndef SQLITESTORAGE_H
+#define SQLITESTORAGE_H
+
+#include "storagebackend.h"
+
+class QThread;
+class QSqlQuery;
+
+// Одна база pol.sqlite (QtSql, журнал WAL). Задача — строка с полями для выборок
+// (срок, статус, приоритет, категория, время выполнения — все с индексами) и полным
+// Task::toJson; правка задачи меняет только её строку. Уроки словаря — по строке на урок,
+// журнал геймификации — таблица с номером события, он же позиция журнала.
+class SqliteStorage : public StorageBackend {
+public:
+    SqliteStorage();
+    ~SqliteStorage();
+
+    Kind kind() const override { return Sqlite; }
+
+    QList<int> partitionKeys() override;
+    bool readPartition(int key, QList<Task>& out) override;
+    bool writePartition(int key, const QList<Task>& tasks) override;
+    bool removePartition(int key) override;
+    bool updatePartition(int key, const QList<Task>& tasks, const QSet<TaskId>& touched) override;
+
+    QByteArray readDocument(const QString& name) override;
+    bool writeDocument(const QString& name, const QByteArray& data) override;
+
+    bool readLessons(QList<QList<EnglishWord>>& out) override;
+    bool writeLessons(const QList<QList<EnglishWord>>& lessons, const QList<int>& changed) override;
+
+    bool appendEvent(const QJsonObject& event) override;
+    qint64 eventsEnd() override;
+    bool readEvents(qint64 from, QList<QJsonObject>& out) override;
+    bool clearEvents() override;
+
+    bool selectTasks(TaskField field, const QVariant& value, QList<Task>& out) override;
+    bool selectCategories(QStringList& out) override;
+    bool countCompletedPerDay(const QDate& from, const QDate& to, QMap<QDate, int>& out) override;
+    bool countByCategory(QMap<QString, int>& out) override;
+    bool countCompletedByWeekday(QMap<int, int>& out) override;
+
+    void checkpoint() override;
+
+    static QString databasePath();
+
+private:
+    class Connection;
+
+    QThread* ownerThread;       // поток с постоянным соединением (главный)
+    QString connectionName;
+    bool ready;                 // схема создана
+
+    bool createSchema();
+    static bool exec(QSqlQuery& query);
+    static bool insertTask(QSqlQuery& query, int key, const Task& task);
+    static bool readTaskRows(QSqlQuery& query, QList<Task>& out);
+};
+
+#endif // SQLITESTORAGE_H
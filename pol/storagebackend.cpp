@@ -0,0 +1,163 @@
+#include "storagebackend.h"
+#include "jsonstorage.h"
+#include "sqlitestorage.h"
+#include "appsettings.h"
+#include "trace.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QDebug>
+
+static QMutex instanceMutex;
+static StorageBackend* current = nullptr;
+
+static StorageBackend::Kind kindFromName(const QString& name) {
+    return name == "sqlite" ? StorageBackend::Sqlite : StorageBackend::Json;
+}
+
+QString StorageBackend::kindName(Kind kind) {
+    return kind == Sqlite ? "sqlite" : "json";
+}
+
+StorageBackend::Kind StorageBackend::activeKind() {
+    return kindFromName(AppSettings::value("storage/active", "json").toString());
+}
+
+void StorageBackend::setActiveKind(Kind kind) {
+    AppSettings::setValue("storage/active", kindName(kind));
+}
+
+StorageBackend* StorageBackend::create(Kind kind) {
+    if (kind == Sqlite) {
+        return new SqliteStorage();
+    }
+    return new JsonStorage();
+}
+
+StorageBackend* StorageBackend::instance() {
+    QMutexLocker locker(&instanceMutex);
+    if (current) {
+        return current;
+    }
+    Kind requested = kindFromName(AppSettings::value("storage/backend", "json").toString());
+    Kind active = activeKind();
+    current = create(requested);
+    if (requested != active) {
+        // Хранилище сменили в настройках — переносим данные один раз
+        StorageBackend* previous = create(active);
+        if (migrate(previous, current)) {
+            setActiveKind(requested);
+            delete previous;
+        } else {
+            qWarning() << "Не удалось перенести данные в хранилище" << kindName(requested)
+                       << "— остаётся" << kindName(active);
+            delete current;
+            current = previous;
+        }
+    }
+    return current;
+}
+
+void StorageBackend::shutdown() {
+    QMutexLocker locker(&instanceMutex);
+    delete current;
+    current = nullptr;
+}
+
+bool StorageBackend::migrate(StorageBackend* from, StorageBackend* to) {
+    TRACE_SCOPE("StorageBackend::migrate");
+    // Задачи: целевое хранилище повторяет исходное раздел в раздел
+    QList<int> keys = from->partitionKeys();
+    for (int key : to->partitionKeys()) {
+        if (!keys.contains(key) && !to->removePartition(key)) {
+            return false;
+        }
+    }
+    for (int key : keys) {
+        QList<Task> partition;
+        if (!from->readPartition(key, partition) || !to->writePartition(key, partition)) {
+            return false;
+        }
+    }
+
+    for (const QString& name : QStringList() << "recurrences" << "history" << "graph") {
+        if (!to->writeDocument(name, from->readDocument(name))) {
+            return false;
+        }
+    }
+
+    QList<QList<EnglishWord>> lessons;
+    if (from->readLessons(lessons)) {
+        QList<int> all;
+        for (int i = 0; i < lessons.size(); i++) {
+            all.append(i);
+        }
+        if (!to->writeLessons(lessons, all)) {
+            return false;
+        }
+    }
+
+    // Журнал геймификации: позиции у хранилищ свои, поэтому смещение в снимке
+    // пересчитывается — события до него вошли в снимок, после — дочитываются
+    QJsonObject snapshot = QJsonDocument::fromJson(from->readDocument("gamestats")).object();
+    qint64 offset = qint64(snapshot["ledgerOffset"].toDouble());
+    QList<QJsonObject> events;
+    QList<QJsonObject> tail;
+    from->readEvents(0, events);
+    from->readEvents(offset, tail);     // журнал короче снимка — хвоста нет
+    if (!to->clearEvents()) {
+        return false;
+    }
+    int head = events.size() - tail.size();
+    for (int i = 0; i < events.size(); i++) {
+        if (i == head && !snapshot.isEmpty()) {
+            snapshot["ledgerOffset"] = double(to->eventsEnd());
+        }
+        if (!to->appendEvent(events[i])) {
+            return false;
+        }
+    }
+    if (!snapshot.isEmpty()) {
+        if (head == events.size()) {
+            snapshot["ledgerOffset"] = double(to->eventsEnd());
+        }
+        if (!to->writeDocument("gamestats", QJsonDocument(snapshot).toJson())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StorageBackend::updatePartition(int key, const QList<Task>& tasks, const QSet<TaskId>& touched) {
+    Q_UNUSED(touched);
+    return tasks.isEmpty() ? removePartition(key) : writePartition(key, tasks);
+}
+
+bool StorageBackend::selectTasks(TaskField field, const QVariant& value, QList<Task>& out) {
+    Q_UNUSED(field);
+    Q_UNUSED(value);
+    Q_UNUSED(out);
+    return false;
+}
+
+bool StorageBackend::selectCategories(QStringList& out) {
+    Q_UNUSED(out);
+    return false;
+}
+
+bool StorageBackend::countCompletedPerDay(const QDate& from, const QDate& to, QMap<QDate, int>& out) {
+    Q_UNUSED(from);
+    Q_UNUSED(to);
+    Q_UNUSED(out);
+    return false;
+}
+
+bool StorageBackend::countByCategory(QMap<QString, int>& out) {
+    Q_UNUSED(out);
+    return false;
+}
+
+bool StorageBackend::countCompletedByWeekday(QMap<int, int>& out) {
+    Q_UNUSED(out);
+    return false;
+}
@@ -0,0 +1,76 @@
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QMap>
+#include <QDate>
+#include <QVariant>
+#include <QByteArray>
+#include <QJsonObject>
+#include "task.h"
+#include "englishdata.h"
+
+// Хранилище данных приложения: TaskManager, EnglishData и GameStats читают и пишут
+// только через него. JsonStorage — прежние файлы в AppData, SqliteStorage — одна база
+// pol.sqlite. Вид задаётся ключом storage/backend в settings.ini ("json" или "sqlite");
+// при его смене данные один раз переносятся из прежнего хранилища (storage/active).
+//
+// Чтения можно звать из фонового потока, запись — из главного.
+class StorageBackend {
+public:
+    enum Kind { Json, Sqlite };
+    enum TaskField { ByStatus, ByPriority, ByCategory };
+
+    virtual ~StorageBackend() {}
+    virtual Kind kind() const = 0;
+
+    static StorageBackend* instance();
+    static void shutdown();            // закрыть (восстановление из копии); instance() откроет заново
+    static Kind activeKind();          // в каком хранилище сейчас лежат данные
+    static void setActiveKind(Kind kind);
+    static QString kindName(Kind kind);
+
+    // Задачи по месяцам срока (ключ — TaskManager::partitionKey)
+    virtual QList<int> partitionKeys() = 0;
+    virtual bool readPartition(int key, QList<Task>& out) = 0;
+    virtual bool writePartition(int key, const QList<Task>& tasks) = 0;     // весь раздел
+    virtual bool removePartition(int key) = 0;
+    // Правка отдельных задач: tasks — весь раздел, touched — изменённые, добавленные
+    // и удалённые (их нет в tasks) задачи. По умолчанию раздел переписывается целиком
+    virtual bool updatePartition(int key, const QList<Task>& tasks, const QSet<TaskId>& touched);
+
+    // Небольшие документы целиком (правила повторения, история выполнения, снимок
+    // геймификации). Пустые данные — документа нет
+    virtual QByteArray readDocument(const QString& name) = 0;
+    virtual bool writeDocument(const QString& name, const QByteArray& data) = 0;
+
+    // Словарь по урокам: changed — какие уроки записать
+    virtual bool readLessons(QList<QList<EnglishWord>>& out) = 0;
+    virtual bool writeLessons(const QList<QList<EnglishWord>>& lessons, const QList<int>& changed) = 0;
+
+    // Журнал геймификации. Позиция — метка конца журнала, которую хранит снимок;
+    // readEvents отдаёт события после неё и false, если журнал короче (заменён)
+    virtual bool appendEvent(const QJsonObject& event) = 0;
+    virtual qint64 eventsEnd() = 0;
+    virtual bool readEvents(qint64 from, QList<QJsonObject>& out) = 0;
+    virtual bool clearEvents() = 0;
+
+    // Выборки и статистика внутри хранилища, без загрузки всех разделов в память.
+    // false — хранилище так не умеет, TaskManager считает сам. Несохранённых правок
+    // хранилище не видит: TaskManager обращается к нему, только когда их нет
+    virtual bool selectTasks(TaskField field, const QVariant& value, QList<Task>& out);
+    virtual bool selectCategories(QStringList& out);
+    virtual bool countCompletedPerDay(const QDate& from, const QDate& to, QMap<QDate, int>& out);
+    virtual bool countByCategory(QMap<QString, int>& out);
+    virtual bool countCompletedByWeekday(QMap<int, int>& out);
+
+    virtual void checkpoint() {}       // перед копированием файлов данных
+
+protected:
+    static StorageBackend* create(Kind kind);
+    static bool migrate(StorageBackend* from, StorageBackend* to);
+};
+
+#endif // STORAGEBACKEND_H
@@ -0,0 +1,183 @@
+#include "storewatcher.h"
+#include "taskmanager.h"
+#include "englishdata.h"
+#include "jsonstorage.h"
+#include "trace.h"
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+namespace {
+
+struct PartitionRead {
+    PartitionRead() : ok(false) {}
+    bool ok;
+    QList<Task> tasks;
+};
+
+struct EnglishRead {
+    EnglishRead() : ok(false) {}
+    bool ok;
+    QList<QList<EnglishWord>> lessons;
+};
+
+}
+
+StoreWatcher::StoreWatcher(TaskManager* taskManager, EnglishData* englishData, QObject* parent)
+    : QObject(parent), taskManager(taskManager), englishData(englishData),
+      englishPath(JsonStorage::englishPath()), englishWatched(false) {
+    watcher = new QFileSystemWatcher(this);
+    debounce = new QTimer(this);
+    debounce->setSingleShot(true);
+    debounce->setInterval(DEBOUNCE_MSECS);
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &StoreWatcher::onFileChanged);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &StoreWatcher::onDirectoryChanged);
+    connect(debounce, &QTimer::timeout, this, &StoreWatcher::processPending);
+
+    // Каталог — чтобы увидеть новые и удалённые разделы
+    QString dir = JsonStorage::taskDirectory();
+    QDir().mkpath(dir);
+    watcher->addPath(dir);
+    partitionFiles = listPartitionFiles();
+    if (!partitionFiles.isEmpty()) {
+        watcher->addPaths(partitionFiles.values());
+    }
+}
+
+void StoreWatcher::watchEnglish() {
+    if (englishWatched) {
+        return;
+    }
+    englishWatched = true;
+    // Файла словаря может ещё не быть: его появление видно по каталогу
+    watcher->addPath(QFileInfo(englishPath).absolutePath());
+    if (QFile::exists(englishPath)) {
+        watcher->addPath(englishPath);
+    }
+}
+
+QSet<QString> StoreWatcher::listPartitionFiles() const {
+    QSet<QString> files;
+    QDir dir(JsonStorage::taskDirectory());
+    for (const QString& name : dir.entryList(QStringList() << "*.json", QDir::Files)) {
+        if (JsonStorage::partitionKeyFromFileName(name) >= 0) {
+            files.insert(dir.filePath(name));
+        }
+    }
+    return files;
+}
+
+void StoreWatcher::onFileChanged(const QString& path) {
+    // Замена файла переименованием снимает наблюдение — ставим заново
+    if (QFile::exists(path) && !watcher->files().contains(path)) {
+        watcher->addPath(path);
+    }
+    schedule(path);
+}
+
+void StoreWatcher::onDirectoryChanged(const QString& path) {
+    if (englishWatched && path == QFileInfo(englishPath).absolutePath()
+        && QFile::exists(englishPath) && !watcher->files().contains(englishPath)) {
+        watcher->addPath(englishPath);
+        schedule(englishPath);
+    }
+    if (path != JsonStorage::taskDirectory()) {
+        return;
+    }
+    QSet<QString> current = listPartitionFiles();
+    for (const QString& file : current) {
+        if (!partitionFiles.contains(file)) {
+            watcher->addPath(file);
+            schedule(file);
+        }
+    }
+    for (const QString& file : partitionFiles) {
+        if (!current.contains(file)) {
+            schedule(file);
+        }
+    }
+    partitionFiles = current;
+}
+
+void StoreWatcher::schedule(const QString& path) {
+    pending.insert(path);
+    debounce->start();
+}
+
+void StoreWatcher::processPending() {
+    QSet<QString> paths;
+    paths.swap(pending);
+    for (const QString& path : paths) {
+        if (inFlight.contains(path)) {
+            pending.insert(path);
+        } else if (path == englishPath) {
+            reloadEnglish();
+        } else {
+            reloadPartition(path);
+        }
+    }
+}
+
+void StoreWatcher::finishRead(const QString& path) {
+    inFlight.remove(path);
+    if (pending.contains(path) && !debounce->isActive()) {
+        debounce->start();
+    }
+}
+
+void StoreWatcher::reloadPartition(const QString& path) {
+    int key = JsonStorage::partitionKeyFromFileName(path);
+    if (key < 0) {
+        return;
+    }
+    // Номер правки на момент чтения: если раздел успеют поменять локально, чтение устареет
+    quint64 revision = taskManager->partitionRevision(key);
+    inFlight.insert(path);
+    QFutureWatcher<PartitionRead>* reader = new QFutureWatcher<PartitionRead>(this);
+    connect(reader, &QFutureWatcherBase::finished, this, [this, reader, path, key, revision]() {
+        PartitionRead result = reader->result();
+        reader->deleteLater();
+        finishRead(path);
+        if (result.ok) {
+            taskManager->mergeExternalPartition(key, result.tasks, revision);
+        }
+    });
+    reader->setFuture(QtConcurrent::run([path]() {
+        TRACE_SCOPE("StoreWatcher::readPartition");
+        PartitionRead result;
+        // Удалённый файл — пустой раздел; недописанный не читается и ждёт следующего события
+        result.ok = !QFile::exists(path) || JsonStorage::readTaskFile(path, result.tasks);
+        return result;
+    }));
+}
+
+void StoreWatcher::reloadEnglish() {
+    if (!QFile::exists(englishPath)) {
+        return;
+    }
+    quint64 revision = englishData->getRevision();
+    QString path = englishPath;
+    inFlight.insert(path);
+    QFutureWatcher<EnglishRead>* reader = new QFutureWatcher<EnglishRead>(this);
+    connect(reader, &QFutureWatcherBase::finished, this, [this, reader, path, revision]() {
+        EnglishRead result = reader->result();
+        reader->deleteLater();
+        finishRead(path);
+        if (!result.ok) {
+            return;
+        }
+        QList<int> changedLessons = englishData->mergeLessons(result.lessons, revision);
+        if (!changedLessons.isEmpty()) {
+            emit englishChanged(changedLessons);
+        }
+    });
+    reader->setFuture(QtConcurrent::run([path]() {
+        EnglishRead result;
+        result.ok = JsonStorage::readLessonFile(path, result.lessons);
+        return result;
+    }));
+}
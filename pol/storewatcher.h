@@ -0,0 +1,56 @@
+#ifndef STOREWATCHER_H
+#define STOREWATCHER_H
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QList>
+
+class TaskManager;
+class EnglishData;
+class QFileSystemWatcher;
+class QTimer;
+
+// Подхватывает правки файлов данных извне (другой экземпляр, облачная папка, ручная
+// правка): разделы задач в AppData/tasks и english_vocabulary.json. Файл читается
+// в пуле потоков, в памяти заменяются только отличающиеся задачи и уроки.
+// Собственные сохранения дают пустую разницу и ничего не меняют.
+// Нужен только для хранилища JSON: базу SQLite правят лишь через приложение.
+class StoreWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    StoreWatcher(TaskManager* taskManager, EnglishData* englishData, QObject* parent = nullptr);
+
+    // Словарь отслеживается после его загрузки (она идёт в фоне)
+    void watchEnglish();
+
+signals:
+    void englishChanged(const QList<int>& lessonIndexes);
+
+private slots:
+    void onFileChanged(const QString& path);
+    void onDirectoryChanged(const QString& path);
+    void processPending();
+
+private:
+    static const int DEBOUNCE_MSECS = 300;   // пачка записей одного сохранения — одно чтение
+
+    TaskManager* taskManager;
+    EnglishData* englishData;
+    QFileSystemWatcher* watcher;
+    QTimer* debounce;
+    QString englishPath;
+    bool englishWatched;
+    QSet<QString> partitionFiles;   // известные файлы разделов
+    QSet<QString> pending;
+    QSet<QString> inFlight;         // читаются сейчас; новое событие ждёт окончания
+
+    void schedule(const QString& path);
+    void finishRead(const QString& path);
+    void reloadPartition(const QString& path);
+    void reloadEnglish();
+    QSet<QString> listPartitionFiles() const;
+};
+
+#endif // STOREWATCHER_H
@@ -0,0 +1,468 @@
+#include "syncengine.h"
+#include "taskmanager.h"
+#include "englishdata.h"
+#include "gamestats.h"
+#include "trace.h"
+#include "clock.h"
+#include "appsettings.h"
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QUuid>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QDebug>
+
+SyncEngine::SyncEngine(TaskManager* tasks, EnglishData* english, GameStats* stats, QObject* parent)
+    : QObject(parent), tasks(tasks), english(english), stats(stats),
+      lastClock(0), token(0), applyingRemote(false), statsApplied(false), network(nullptr), reply(nullptr) {
+    syncTimer = new QTimer(this);
+    syncTimer->setSingleShot(true);
+    syncTimer->setInterval(SYNC_DELAY_MSECS);
+    connect(syncTimer, &QTimer::timeout, this, &SyncEngine::sync);
+
+    intervalTimer = new QTimer(this);
+    intervalTimer->setInterval(SYNC_INTERVAL_MSECS);
+    connect(intervalTimer, &QTimer::timeout, this, &SyncEngine::sync);
+
+    saveTimer = new QTimer(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(SAVE_DELAY_MSECS);
+    connect(saveTimer, &QTimer::timeout, this, &SyncEngine::saveState);
+
+    if (QFile::exists(statePath())) {
+        loadState();
+        if (!AppSettings::value("sync/tracked", false).toBool()) {
+            // Пока синхронизация была выключена, правки не отслеживались
+            scanAll();
+        }
+    } else {
+        // Первый запуск синхронизации: всё текущее содержимое — локальные правки
+        device = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        scanAll();
+        saveState();
+    }
+    AppSettings::setValue("sync/tracked", true);
+
+    connect(tasks, &TaskManager::tasksChanged, this, &SyncEngine::onTasksChanged);
+    connect(tasks, &TaskManager::tasksReloaded, this, &SyncEngine::onTasksReloaded);
+    connect(tasks, &TaskManager::ruleListChanged, this, &SyncEngine::onRuleListChanged);
+}
+
+SyncEngine::~SyncEngine() {
+    if (reply) {
+        reply->disconnect(this);
+        reply->abort();
+    }
+    saveState();
+}
+
+void SyncEngine::markUntracked() {
+    if (AppSettings::value("sync/tracked", false).toBool()) {
+        AppSettings::setValue("sync/tracked", false);
+    }
+}
+
+void SyncEngine::setServerUrl(const QUrl& url) {
+    serverUrl = url;
+    if (serverUrl.isEmpty()) {
+        intervalTimer->stop();
+        return;
+    }
+    if (!network) {
+        network = new QNetworkAccessManager(this);
+    }
+    intervalTimer->start();
+    scheduleSync();
+}
+
+void SyncEngine::noteEnglishLesson(int lessonIndex) {
+    touch("english/" + english->lessonId(lessonIndex), english->lessonToJson(lessonIndex));
+}
+
+void SyncEngine::onTasksChanged(const QList<TaskId>& taskIds) {
+    // Пустой список разбирают onTasksReloaded и onRuleListChanged
+    if (!applyingRemote) {
+        touchTasks(taskIds);
+    }
+}
+
+void SyncEngine::onTasksReloaded() {
+    // Набор задач заменён целиком (импорт) — сверяем всё по хэшам
+    if (!applyingRemote) {
+        scanAll();
+    }
+}
+
+void SyncEngine::onRuleListChanged(const QList<TaskId>& taskIds) {
+    // Правка правил: сверяются только правила и задачи из того же пакета
+    if (!applyingRemote) {
+        touchTasks(taskIds);
+        scanRules();
+    }
+}
+
+void SyncEngine::touchTasks(const QList<TaskId>& taskIds) {
+    for (TaskId id : taskIds) {
+        const Task* task = tasks->getTask(id);
+        touch("task/" + QString::number(id), task ? QJsonValue(task->toJson()) : QJsonValue(),
+              task ? TaskManager::partitionKey(task->getDeadline()) : -1);
+    }
+}
+
+void SyncEngine::touch(const QString& key, const QJsonValue& value, int partition) {
+    bool deleted = value.isNull();
+    uint hash = deleted ? 0 : contentHash(value);
+    QHash<QString, Record>::iterator it = records.find(key);
+    bool fresh = it == records.end();
+    if (fresh) {
+        if (deleted) {
+            return;
+        }
+        it = records.insert(key, Record());
+    }
+    if (partition >= 0) {
+        it->partition = partition;
+    }
+    if (!fresh && it->deleted == deleted && it->hash == hash) {
+        return;
+    }
+    it->stamp = nextStamp();
+    it->hash = hash;
+    it->deleted = deleted;
+    pendingKeys.insert(key);
+    saveTimer->start();
+    scheduleSync();
+}
+
+void SyncEngine::scanAll() {
+    TRACE_SCOPE("SyncEngine::scanAll");
+    QSet<QString> present;
+    for (const Task& task : tasks->getAllTasks()) {
+        QString key = "task/" + QString::number(task.getId());
+        touch(key, task.toJson(), TaskManager::partitionKey(task.getDeadline()));
+        present.insert(key);
+    }
+    touchMissing("task/", present);
+    scanRules();
+    for (int i = 0; i < EnglishData::LESSON_COUNT; i++) {
+        QJsonArray words = english->lessonToJson(i);
+        QString key = "english/" + english->lessonId(i);
+        if (!words.isEmpty() || records.contains(key)) {
+            touch(key, words);
+        }
+    }
+}
+
+void SyncEngine::scanRules() {
+    QSet<QString> present;
+    for (const RecurrenceRule& rule : tasks->getRules()) {
+        QString key = "rule/" + QString::number(rule.getId());
+        touch(key, rule.toJson());
+        present.insert(key);
+    }
+    touchMissing("rule/", present);
+}
+
+void SyncEngine::touchMissing(const QString& prefix, const QSet<QString>& present) {
+    // Записи с этим префиксом, которых больше нет, — удаления
+    QStringList gone;
+    for (QHash<QString, Record>::const_iterator it = records.constBegin(); it != records.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && !it->deleted && !present.contains(it.key())) {
+            gone.append(it.key());
+        }
+    }
+    for (const QString& key : gone) {
+        touch(key, QJsonValue());
+    }
+}
+
+QJsonValue SyncEngine::currentValue(const QString& key) {
+    if (records.value(key).deleted) {
+        return QJsonValue();
+    }
+    if (key.startsWith("task/")) {
+        TaskId id = key.mid(5).toLongLong();
+        if (!ensureTaskResident(id)) {
+            return QJsonValue();
+        }
+        return tasks->getTask(id)->toJson();
+    }
+    if (key.startsWith("rule/")) {
+        int id = key.mid(5).toInt();
+        for (const RecurrenceRule& rule : tasks->getRules()) {
+            if (rule.getId() == id) {
+                return rule.toJson();
+            }
+        }
+        return QJsonValue();
+    }
+    if (key.startsWith("english/")) {
+        return english->lessonToJson(english->lessonIndex(key.mid(8)));
+    }
+    return QJsonValue();
+}
+
+bool SyncEngine::ensureTaskResident(TaskId taskId) {
+    if (tasks->getTask(taskId)) {
+        return true;
+    }
+    QHash<QString, Record>::const_iterator it = records.constFind("task/" + QString::number(taskId));
+    if (it == records.constEnd() || it->deleted) {
+        return false;
+    }
+    // Задача есть, но её месяц выгружен: раздел запомнен при последней правке
+    return tasks->findTask(taskId, it->partition) != nullptr;
+}
+
+void SyncEngine::sync() {
+    if (reply || serverUrl.isEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("SyncEngine::sync");
+    syncTimer->stop();
+
+    QJsonArray changes;
+    sentStamps.clear();
+    for (const QString& key : pendingKeys) {
+        SyncChange change;
+        change.key = key;
+        change.stamp = records.value(key).stamp;
+        change.value = currentValue(key);
+        changes.append(change.toJson());
+        sentStamps.insert(key, change.stamp);
+    }
+
+    QJsonObject body;
+    body["device"] = device;
+    body["since"] = double(token);
+    body["changes"] = changes;
+
+    QUrl url = serverUrl;
+    url.setPath(url.path().endsWith('/') ? url.path() + "sync" : url.path() + "/sync");
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    reply = network->post(request, QJsonDocument(body).toJson(QJsonDocument::Compact));
+    connect(reply, &QNetworkReply::finished, this, &SyncEngine::onSyncFinished);
+}
+
+void SyncEngine::onSyncFinished() {
+    QNetworkReply* finished = reply;
+    reply = nullptr;
+    finished->deleteLater();
+
+    if (finished->error() != QNetworkReply::NoError) {
+        qWarning() << "Синхронизация не удалась:" << finished->errorString();
+        emit syncFailed(finished->errorString());
+        return;
+    }
+    QJsonObject root = QJsonDocument::fromJson(finished->readAll()).object();
+    if (!root.contains("token")) {
+        emit syncFailed("Некорректный ответ сервера");
+        return;
+    }
+
+    // Отправленное принято; если запись успели снова изменить — она остаётся в очереди
+    int sent = sentStamps.size();
+    for (QHash<QString, SyncStamp>::const_iterator it = sentStamps.constBegin(); it != sentStamps.constEnd(); ++it) {
+        if (records.value(it.key()).stamp == it.value()) {
+            pendingKeys.remove(it.key());
+        }
+    }
+    sentStamps.clear();
+
+    int received = 0;
+    statsApplied = false;
+    {
+        // Чужие правки не отменяются локальной историей
+        TaskManager::Untracked untracked(tasks);
+        TaskManager::Batch batch(tasks);
+        for (const QJsonValue& value : root["changes"].toArray()) {
+            if (applyRemote(SyncChange::fromJson(value.toObject()))) {
+                received++;
+            }
+        }
+    }
+    token = qint64(root["token"].toDouble());
+    saveTimer->start();
+    if (statsApplied) {
+        emit statsChanged();
+    }
+    emit synced(sent, received);
+}
+
+bool SyncEngine::applyRemote(const SyncChange& change) {
+    if (change.key == "stats") {
+        // Итоги целиком от старых версий: теперь они выводятся из отметок задач
+        return false;
+    }
+    QHash<QString, Record>::const_iterator local = records.constFind(change.key);
+    if (local != records.constEnd() && !change.stamp.newerThan(local->stamp)) {
+        // Локальная правка новее — она уйдёт на сервер при следующем обмене
+        return false;
+    }
+    lastClock = qMax(lastClock, change.stamp.clock);
+
+    applyingRemote = true;
+    const QString& key = change.key;
+    int partition = -1;
+    if (key.startsWith("task/")) {
+        TaskId id = key.mid(5).toLongLong();
+        bool resident = ensureTaskResident(id);
+        const Task* current = resident ? tasks->getTask(id) : nullptr;
+        QDate wasDone = current && current->getStatus() == TaskStatus::Completed ? current->getCompletedAt().date() : QDate();
+        if (change.isDeletion()) {
+            tasks->deleteTask(id);
+        } else {
+            Task task = Task::fromJson(change.value.toObject());
+            partition = TaskManager::partitionKey(task.getDeadline());
+            QDate isDone;
+            if (task.getStatus() == TaskStatus::Completed) {
+                isDone = task.getCompletedAt().isValid() ? task.getCompletedAt().date() : Clock::currentDate();
+            }
+            if (resident) {
+                tasks->updateTask(task);
+            } else {
+                tasks->addTask(task);
+            }
+            applyCompletion(id, wasDone, isDone);
+        }
+    } else if (key.startsWith("rule/")) {
+        if (change.isDeletion()) {
+            tasks->deleteRule(key.mid(5).toInt());
+        } else {
+            tasks->setRule(RecurrenceRule::fromJson(change.value.toObject()));
+        }
+    } else if (key.startsWith("english/")) {
+        int lessonIndex = english->lessonIndex(key.mid(8));
+        if (lessonIndex >= 0) {
+            english->setLessonFromJson(lessonIndex, change.value.toArray());
+            english->saveLesson(lessonIndex);
+            emit englishChanged(lessonIndex);
+        }
+    }
+    applyingRemote = false;
+
+    // Хэш — по нашей сериализации, чтобы tasksChanged после пакета не принял запись за правку
+    Record& record = records[key];
+    record.stamp = change.stamp;
+    record.deleted = change.isDeletion();
+    if (partition >= 0) {
+        record.partition = partition;
+    }
+    QJsonValue stored = currentValue(key);
+    record.hash = record.deleted ? 0 : contentHash(stored);
+    pendingKeys.remove(key);
+    return true;
+}
+
+void SyncEngine::applyCompletion(TaskId taskId, const QDate& wasDone, const QDate& isDone) {
+    // Геймификация не синхронизируется итогами — каждое устройство ведёт её по отметкам
+    // задач, так что одновременные отметки на разных устройствах складываются
+    if (wasDone == isDone) {
+        return;
+    }
+    if (wasDone.isValid()) {
+        stats->removeTaskCompleted(taskId, wasDone);
+    }
+    if (isDone.isValid()) {
+        stats->addTaskCompleted(taskId, isDone);
+    }
+    statsApplied = true;
+}
+
+SyncStamp SyncEngine::nextStamp() {
+    lastClock = qMax(QDateTime::currentMSecsSinceEpoch(), lastClock + 1);
+    return SyncStamp(lastClock, device);
+}
+
+uint SyncEngine::contentHash(const QJsonValue& value) {
+    QJsonDocument doc = value.isArray() ? QJsonDocument(value.toArray()) : QJsonDocument(value.toObject());
+    return qHash(doc.toJson(QJsonDocument::Compact));
+}
+
+void SyncEngine::scheduleSync() {
+    if (!serverUrl.isEmpty() && !syncTimer->isActive()) {
+        syncTimer->start();
+    }
+}
+
+void SyncEngine::loadState() {
+    QFile file(statePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Не удалось открыть файл для чтения:" << file.fileName();
+        return;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    device = root["device"].toString();
+    if (device.isEmpty()) {
+        device = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    token = qint64(root["token"].toDouble());
+    lastClock = qint64(root["clock"].toDouble());
+    QJsonObject list = root["records"].toObject();
+    records.reserve(list.size());
+    for (QJsonObject::const_iterator it = list.constBegin(); it != list.constEnd(); ++it) {
+        if (it.key() == "stats") {
+            continue;   // запись итогов геймификации прежних версий
+        }
+        QJsonArray fields = it.value().toArray();   // [clock, device, hash, deleted, partition]
+        Record record;
+        record.stamp = SyncStamp(qint64(fields.at(0).toDouble()), fields.at(1).toString());
+        record.hash = uint(fields.at(2).toDouble());
+        record.deleted = fields.at(3).toBool();
+        record.partition = fields.at(4).toInt(-1);     // нет в файлах старых версий
+        records.insert(it.key(), record);
+    }
+    for (const QJsonValue& key : root["pending"].toArray()) {
+        if (records.contains(key.toString())) {
+            pendingKeys.insert(key.toString());
+        }
+    }
+}
+
+void SyncEngine::saveState() {
+    saveTimer->stop();
+    QJsonObject list;
+    for (QHash<QString, Record>::const_iterator it = records.constBegin(); it != records.constEnd(); ++it) {
+        QJsonArray fields;
+        fields.append(double(it->stamp.clock));
+        fields.append(it->stamp.device);
+        fields.append(double(it->hash));
+        fields.append(it->deleted);
+        fields.append(it->partition);
+        list.insert(it.key(), fields);
+    }
+    QJsonArray pending;
+    for (const QString& key : pendingKeys) {
+        pending.append(key);
+    }
+    QJsonObject root;
+    root["device"] = device;
+    root["token"] = double(token);
+    root["clock"] = double(lastClock);
+    root["records"] = list;
+    root["pending"] = pending;
+
+    QString path = statePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Не удалось открыть файл для записи:" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+}
+
+QString SyncEngine::statePath() const {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/sync/state.json";
+}
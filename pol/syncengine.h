@@ -0,0 +1,105 @@
+#ifndef SYNCENGINE_H
+#define SYNCENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QUrl>
+#include "syncprotocol.h"
+#include "task.h"
+
+class TaskManager;
+class EnglishData;
+class GameStats;
+class QTimer;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Синхронизация задач, словаря и геймификации с сервером (см. syncprotocol.h).
+// Для каждой записи хранится метка последней правки и хэш содержимого;
+// на сервер уходят только записи, изменённые после прошлого обмена,
+// а с сервера приходят только изменения после сохранённого токена.
+class SyncEngine : public QObject {
+    Q_OBJECT
+
+public:
+    SyncEngine(TaskManager* tasks, EnglishData* english, GameStats* stats, QObject* parent = nullptr);
+    ~SyncEngine();
+
+    // Синхронизация выключена в этом запуске: при включении всё сверяется заново
+    static void markUntracked();
+
+    void setServerUrl(const QUrl& url);         // пустой адрес — синхронизация выключена
+    QUrl getServerUrl() const { return serverUrl; }
+    int pendingCount() const { return pendingKeys.size(); }
+    bool isSyncing() const { return reply != nullptr; }
+
+public slots:
+    void sync();
+    void noteEnglishLesson(int lessonIndex);    // локальная правка урока
+
+signals:
+    void synced(int sent, int received);
+    void syncFailed(const QString& error);
+    void englishChanged(int lessonIndex);       // урок пришёл с сервера
+    void statsChanged();                        // пришли чужие отметки задач — итоги пересчитаны
+
+private slots:
+    void onTasksChanged(const QList<TaskId>& taskIds);
+    void onTasksReloaded();
+    void onRuleListChanged(const QList<TaskId>& taskIds);
+    void onSyncFinished();
+
+private:
+    struct Record {
+        Record() : hash(0), deleted(false), partition(-1) {}
+        SyncStamp stamp;
+        uint hash;          // хэш содержимого: правка без изменений не считается
+        bool deleted;
+        int partition;      // раздел задачи (TaskManager::partitionKey), -1 — неизвестен
+    };
+
+    static const int SYNC_DELAY_MSECS = 3000;       // пауза после правки перед обменом
+    static const int SYNC_INTERVAL_MSECS = 60 * 1000;
+    static const int SAVE_DELAY_MSECS = 2000;
+
+    TaskManager* tasks;
+    EnglishData* english;
+    GameStats* stats;
+
+    QString device;
+    qint64 lastClock;
+    qint64 token;
+    QHash<QString, Record> records;
+    QSet<QString> pendingKeys;
+    bool applyingRemote;
+    bool statsApplied;
+
+    QUrl serverUrl;
+    QNetworkAccessManager* network;
+    QNetworkReply* reply;
+    QHash<QString, SyncStamp> sentStamps;
+
+    QTimer* syncTimer;
+    QTimer* intervalTimer;
+    QTimer* saveTimer;
+
+    void touch(const QString& key, const QJsonValue& value, int partition = -1);
+    void touchTasks(const QList<TaskId>& taskIds);
+    void scanAll();
+    void scanRules();
+    void touchMissing(const QString& prefix, const QSet<QString>& present);
+    QJsonValue currentValue(const QString& key);
+    bool applyRemote(const SyncChange& change);
+    void applyCompletion(TaskId taskId, const QDate& wasDone, const QDate& isDone);
+    bool ensureTaskResident(TaskId taskId);
+    SyncStamp nextStamp();
+    static uint contentHash(const QJsonValue& value);
+
+    void scheduleSync();
+    void loadState();
+    void saveState();
+    QString statePath() const;
+};
+
+#endif // SYNCENGINE_H
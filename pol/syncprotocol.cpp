@@ -0,0 +1,22 @@
+#include "syncprotocol.h"
+
+QJsonObject SyncChange::toJson() const {
+    QJsonObject json;
+    json["key"] = key;
+    json["clock"] = double(stamp.clock);
+    json["device"] = stamp.device;
+    json["value"] = value;
+    return json;
+}
+
+SyncChange SyncChange::fromJson(const QJsonObject& json) {
+    SyncChange change;
+    change.key = json["key"].toString();
+    change.stamp.clock = qint64(json["clock"].toDouble());
+    change.stamp.device = json["device"].toString();
+    change.value = json["value"];
+    if (change.value.isUndefined()) {
+        change.value = QJsonValue();
+    }
+    return change;
+}
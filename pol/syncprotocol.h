@@ -0,0 +1,43 @@
+#ifndef SYNCPROTOCOL_H
+#define SYNCPROTOCOL_H
+
+#include <QString>
+#include <QJsonObject>
+#include <QJsonValue>
+
+// Протокол синхронизации (общий для приложения и pol-sync-server).
+//
+// Запись — одна задача ("task/<id>"), правило ("rule/<id>") или урок английского
+// ("english/<A1.1>"); геймификацию каждое устройство выводит из отметок задач. Каждая правка записи получает
+// метку (логические часы, устройство); при конфликте побеждает большая метка,
+// поэтому все участники сходятся к одному результату независимо от порядка обмена.
+//
+// POST /sync  {"device", "since": токен, "changes": [изменение, ...]}
+//          -> {"token": новый токен, "changes": [записи, изменённые после since другими]}
+
+struct SyncStamp {
+    SyncStamp() : clock(0) {}
+    SyncStamp(qint64 clock, const QString& device) : clock(clock), device(device) {}
+
+    qint64 clock;       // мс с эпохи, но не меньше последней увиденной метки + 1
+    QString device;
+
+    bool newerThan(const SyncStamp& other) const {
+        return clock != other.clock ? clock > other.clock : device > other.device;
+    }
+    bool operator==(const SyncStamp& other) const { return clock == other.clock && device == other.device; }
+    bool operator!=(const SyncStamp& other) const { return !(*this == other); }
+};
+
+struct SyncChange {
+    QString key;
+    SyncStamp stamp;
+    QJsonValue value;   // Null — запись удалена
+
+    bool isDeletion() const { return value.isNull(); }
+
+    QJsonObject toJson() const;
+    static SyncChange fromJson(const QJsonObject& json);
+};
+
+#endif // SYNCPROTOCOL_H
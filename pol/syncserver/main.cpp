@@ -0,0 +1,28 @@
+#include "syncserver.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+   QCoreApplication a(argc, argv);
+   QCoreApplication::setApplicationName("pol-sync-server");
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription("Локальный сервер синхронизации задач");
+   parser.addHelpOption();
+   QCommandLineOption portOption("port", "Порт (по умолчанию 8765).", "port", "8765");
+   QCommandLineOption dataOption("data", "Файл для хранения записей; без него — только в памяти.", "file");
+   parser.addOption(portOption);
+   parser.addOption(dataOption);
+   parser.process(a);
+
+   SyncServer server(parser.value(dataOption));
+   if (!server.listen(QHostAddress::LocalHost, parser.value(portOption).toUShort())) {
+       qCritical() << "Не удалось открыть порт" << parser.value(portOption);
+       return 1;
+   }
+   qInfo() << "Сервер синхронизации: http://127.0.0.1:" + QString::number(server.serverPort());
+   return a.exec();
+}
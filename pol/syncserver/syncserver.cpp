@@ -0,0 +1,188 @@
+#include "syncserver.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+static const int MAX_REQUEST_BYTES = 64 * 1024 * 1024;
+
+SyncServer::SyncServer(const QString& storagePath, QObject* parent)
+    : QObject(parent), server(new QTcpServer(this)), storagePath(storagePath), sequence(0) {
+    connect(server, &QTcpServer::newConnection, this, &SyncServer::onNewConnection);
+    if (!storagePath.isEmpty()) {
+        load();
+    }
+}
+
+bool SyncServer::listen(const QHostAddress& address, quint16 port) {
+    return server->listen(address, port);
+}
+
+quint16 SyncServer::serverPort() const {
+    return server->serverPort();
+}
+
+void SyncServer::onNewConnection() {
+    while (QTcpSocket* socket = server->nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, &SyncServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void SyncServer::onReadyRead() {
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+    QByteArray& buffer = buffers[socket];
+    buffer.append(socket->readAll());
+    if (buffer.size() > MAX_REQUEST_BYTES) {
+        respond(socket, 413, "{}");
+        return;
+    }
+
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+    QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    int contentLength = 0;
+    for (int i = 1; i < lines.size(); i++) {
+        QByteArray line = lines[i].trimmed();
+        if (line.toLower().startsWith("content-length:")) {
+            contentLength = line.mid(15).trimmed().toInt();
+        }
+    }
+    if (buffer.size() < headerEnd + 4 + contentLength) {
+        return;     // тело ещё не дошло
+    }
+    QByteArray body = buffer.mid(headerEnd + 4, contentLength);
+    buffer.clear();
+
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+    if (method == "POST" && path == "/sync") {
+        int status = 200;
+        QByteArray answer = handleSync(body, status);
+        respond(socket, status, answer);
+    } else if (method == "GET" && path == "/status") {
+        QJsonObject info;
+        info["token"] = double(sequence);
+        info["records"] = records.size();
+        respond(socket, 200, QJsonDocument(info).toJson(QJsonDocument::Compact));
+    } else {
+        respond(socket, 404, "{}");
+    }
+}
+
+QByteArray SyncServer::handleSync(const QByteArray& body, int& status) {
+    QJsonDocument doc = QJsonDocument::fromJson(body);
+    if (!doc.isObject()) {
+        status = 400;
+        return "{}";
+    }
+    QJsonObject request = doc.object();
+    QString device = request["device"].toString();
+    qint64 since = qint64(request["since"].toDouble());
+
+    bool changed = false;
+    for (const QJsonValue& value : request["changes"].toArray()) {
+        if (merge(SyncChange::fromJson(value.toObject()))) {
+            changed = true;
+        }
+    }
+    if (changed && !storagePath.isEmpty()) {
+        save();
+    }
+
+    // Всё, что изменилось после токена клиента, кроме его собственных правок
+    QJsonArray changes;
+    for (QMap<qint64, QString>::const_iterator it = log.upperBound(since); it != log.constEnd(); ++it) {
+        const SyncChange& change = records[it.value()].change;
+        if (change.stamp.device != device) {
+            changes.append(change.toJson());
+        }
+    }
+    QJsonObject answer;
+    answer["token"] = double(sequence);
+    answer["changes"] = changes;
+    return QJsonDocument(answer).toJson(QJsonDocument::Compact);
+}
+
+bool SyncServer::merge(const SyncChange& change) {
+    if (change.key.isEmpty()) {
+        return false;
+    }
+    QHash<QString, Stored>::iterator it = records.find(change.key);
+    if (it != records.end()) {
+        if (!change.stamp.newerThan(it->change.stamp)) {
+            return false;
+        }
+        log.remove(it->sequence);
+    } else {
+        it = records.insert(change.key, Stored());
+    }
+    it->change = change;
+    it->sequence = ++sequence;
+    log.insert(sequence, change.key);
+    return true;
+}
+
+void SyncServer::respond(QTcpSocket* socket, int status, const QByteArray& body) {
+    QByteArray reason = status == 200 ? "OK" : status == 400 ? "Bad Request"
+                      : status == 404 ? "Not Found" : "Payload Too Large";
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + " " + reason + "\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+    socket->write(head);
+    socket->write(body);
+    socket->disconnectFromHost();
+}
+
+void SyncServer::load() {
+    QFile file(storagePath);
+    if (!file.exists()) {
+        return;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Не удалось открыть файл для чтения:" << file.fileName();
+        return;
+    }
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+    for (const QJsonValue& value : root["records"].toArray()) {
+        QJsonObject json = value.toObject();
+        Stored stored;
+        stored.change = SyncChange::fromJson(json);
+        stored.sequence = qint64(json["sequence"].toDouble());
+        records.insert(stored.change.key, stored);
+        log.insert(stored.sequence, stored.change.key);
+        sequence = qMax(sequence, stored.sequence);
+    }
+}
+
+void SyncServer::save() const {
+    QJsonArray list;
+    for (QMap<qint64, QString>::const_iterator it = log.constBegin(); it != log.constEnd(); ++it) {
+        const Stored& stored = records[it.value()];
+        QJsonObject json = stored.change.toJson();
+        json["sequence"] = double(stored.sequence);
+        list.append(json);
+    }
+    QJsonObject root;
+    root["records"] = list;
+    QFile file(storagePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Не удалось открыть файл для записи:" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+}
@@ -0,0 +1,50 @@
+#ifndef SYNCSERVER_H
+#define SYNCSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QHostAddress>
+#include "syncprotocol.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+// Минимальный HTTP-сервер синхронизации. Хранит последнюю версию каждой записи
+// и журнал по возрастающему номеру: ответ содержит только записи новее токена клиента.
+class SyncServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SyncServer(const QString& storagePath = QString(), QObject* parent = nullptr);
+
+    bool listen(const QHostAddress& address, quint16 port);
+    quint16 serverPort() const;
+    qint64 currentToken() const { return sequence; }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    struct Stored {
+        Stored() : sequence(0) {}
+        SyncChange change;
+        qint64 sequence;
+    };
+
+    QTcpServer* server;
+    QString storagePath;
+    QHash<QString, Stored> records;
+    QMap<qint64, QString> log;      // номер изменения -> ключ записи
+    qint64 sequence;
+    QHash<QTcpSocket*, QByteArray> buffers;
+
+    QByteArray handleSync(const QByteArray& body, int& status);
+    bool merge(const SyncChange& change);
+    void respond(QTcpSocket* socket, int status, const QByteArray& body);
+    void load();
+    void save() const;
+};
+
+#endif // SYNCSERVER_H
@@ -0,0 +1,21 @@
+# Локальный сервер синхронизации для проверки без облака:
+#   pol-sync-server --port 8765 --data sync-server.json
+# В приложении адрес задаётся ключом sync/url в settings.ini (http://127.0.0.1:8765).
+QT += core network
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = pol-sync-server
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    main.cpp \
+    syncserver.cpp \
+    ../syncprotocol.cpp
+
+HEADERS += \
+    syncserver.h \
+    ../syncprotocol.h
@@ -1,49 +1,116 @@
 #include "task.h"
+#include "clock.h"
+#include "isodate.h"
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QColor>
+#include <QRandomGenerator>
 
-int Task::nextId = 1;
+static const qint64 ID_EPOCH_MSECS = Q_INT64_C(1704067200000);   // 2024-01-01T00:00:00Z
+static const int ID_NODE_BITS = 12;
+static const int ID_SEQUENCE_BITS = 10;
 
 Task::Task()
-    : id(nextId++), priority(Priority::Medium), status(TaskStatus::Pending),
-      createdAt(QDateTime::currentDateTime()) {
+    : id(0), priority(Priority::Medium), status(TaskStatus::Pending),
+      createdAt(Clock::currentDateTime()), recurrenceId(0), parentId(0) {
+}
+
+Task::Task(Unstamped)
+    : id(0), priority(Priority::Medium), status(TaskStatus::Pending), recurrenceId(0), parentId(0) {
 }
 
 Task::Task(const QString& title, const QString& description, const QDate& deadline,
            Priority priority, const QString& category)
-    : id(nextId++), title(title), description(description), deadline(deadline),
+    : id(0), title(title), description(description), deadline(deadline),
       priority(priority), category(category), status(TaskStatus::Pending),
-      createdAt(QDateTime::currentDateTime()) {
+      createdAt(Clock::currentDateTime()), recurrenceId(0), parentId(0) {
+}
+
+TaskId Task::generateId() {
+    // Состояние своё у каждого потока: общий счётчик и блокировки не нужны
+    struct Generator {
+        qint64 lastMsecs;
+        quint32 node;
+        quint32 sequence;
+    };
+    static thread_local Generator gen = { -1, QRandomGenerator::system()->bounded(1u << ID_NODE_BITS), 0 };
+
+    qint64 msecs = Clock::currentDateTime().toMSecsSinceEpoch() - ID_EPOCH_MSECS;
+    if (msecs <= gen.lastMsecs) {
+        // Та же миллисекунда или часы ушли назад: продолжаем от последнего id
+        if (++gen.sequence >= (1u << ID_SEQUENCE_BITS)) {
+            gen.lastMsecs++;
+            gen.sequence = 0;
+        }
+        msecs = gen.lastMsecs;
+    } else {
+        gen.lastMsecs = msecs;
+        gen.sequence = 0;
+    }
+    return (msecs << (ID_NODE_BITS + ID_SEQUENCE_BITS)) | (qint64(gen.node) << ID_SEQUENCE_BITS) | gen.sequence;
+}
+
+// В JSON время хранится с точностью до секунды
+static bool sameSecond(const QDateTime& a, const QDateTime& b) {
+    if (!a.isValid() || !b.isValid()) {
+        return a.isValid() == b.isValid();
+    }
+    return a.toMSecsSinceEpoch() / 1000 == b.toMSecsSinceEpoch() / 1000;
+}
+
+bool Task::operator==(const Task& other) const {
+    return id == other.id && title == other.title && description == other.description
+        && deadline == other.deadline && priority == other.priority && category == other.category
+        && status == other.status && sameSecond(createdAt, other.createdAt)
+        && sameSecond(completedAt, other.completedAt)
+        && recurrenceId == other.recurrenceId && occurrenceDate == other.occurrenceDate
+        && parentId == other.parentId && blockedBy == other.blockedBy;
+}
+
+TaskId Task::idFromJson(const QJsonValue& value) {
+    // Строкой: double в JSON точен только до 2^53
+    return value.isString() ? value.toString().toLongLong() : qint64(value.toDouble());
 }
 
 void Task::setStatus(TaskStatus status) {
     this->status = status;
     if (status == TaskStatus::Completed && completedAt.isNull()) {
-        completedAt = QDateTime::currentDateTime();
+        completedAt = Clock::currentDateTime();
     } else if (status == TaskStatus::Pending) {
         completedAt = QDateTime();
     }
 }
 
 bool Task::isOverdue() const {
+    return isOverdue(Clock::currentDate());
+}
+
+bool Task::isDueToday() const {
+    return isDueToday(Clock::currentDate());
+}
+
+bool Task::isDueThisWeek() const {
+    return isDueThisWeek(Clock::currentDate());
+}
+
+bool Task::isOverdue(const QDate& today) const {
     if (status == TaskStatus::Completed) {
         return false;
     }
-    return deadline < QDate::currentDate();
+    return deadline < today;
 }
 
-bool Task::isDueToday() const {
+bool Task::isDueToday(const QDate& today) const {
     if (status == TaskStatus::Completed) {
         return false;
     }
-    return deadline == QDate::currentDate();
+    return deadline == today;
 }
 
-bool Task::isDueThisWeek() const {
+bool Task::isDueThisWeek(const QDate& today) const {
     if (status == TaskStatus::Completed) {
         return false;
     }
-    QDate today = QDate::currentDate();
     QDate weekEnd = today.addDays(7 - today.dayOfWeek());
     return deadline >= today && deadline <= weekEnd;
 }
@@ -76,37 +143,56 @@ QColor Task::priorityColor() const {
 
 QJsonObject Task::toJson() const {
     QJsonObject json;
-    json["id"] = id;
+    json["id"] = QString::number(id);
     json["title"] = title;
     json["description"] = description;
-    json["deadline"] = deadline.toString(Qt::ISODate);
+    json["deadline"] = IsoDate::formatDate(deadline);
     json["priority"] = static_cast<int>(priority);
     json["category"] = category;
     json["status"] = static_cast<int>(status);
-    json["createdAt"] = createdAt.toString(Qt::ISODate);
+    json["createdAt"] = IsoDate::formatDateTime(createdAt);
     if (!completedAt.isNull()) {
-        json["completedAt"] = completedAt.toString(Qt::ISODate);
+        json["completedAt"] = IsoDate::formatDateTime(completedAt);
+    }
+    if (recurrenceId != 0) {
+        json["recurrenceId"] = recurrenceId;
+        json["occurrenceDate"] = IsoDate::formatDate(occurrenceDate);
+    }
+    if (parentId != 0) {
+        json["parentId"] = QString::number(parentId);
+    }
+    if (!blockedBy.isEmpty()) {
+        QJsonArray ids;
+        for (TaskId blocker : blockedBy) {
+            ids.append(QString::number(blocker));
+        }
+        json["blockedBy"] = ids;
     }
     return json;
 }
 
 Task Task::fromJson(const QJsonObject& json) {
-    Task task;
-    task.id = json["id"].toInt();
+    Task task(NoTimestamp);
+    task.id = idFromJson(json["id"]);
     task.title = json["title"].toString();
     task.description = json["description"].toString();
-    task.deadline = QDate::fromString(json["deadline"].toString(), Qt::ISODate);
+    task.deadline = IsoDate::parseDate(json["deadline"].toString());
     task.priority = static_cast<Priority>(json["priority"].toInt());
     task.category = json["category"].toString();
     task.status = static_cast<TaskStatus>(json["status"].toInt());
-    task.createdAt = QDateTime::fromString(json["createdAt"].toString(), Qt::ISODate);
+    task.createdAt = IsoDate::parseDateTime(json["createdAt"].toString());
     if (json.contains("completedAt")) {
-        task.completedAt = QDateTime::fromString(json["completedAt"].toString(), Qt::ISODate);
+        task.completedAt = IsoDate::parseDateTime(json["completedAt"].toString());
     }
-
-    // Обновляем nextId, чтобы избежать конфликтов
-    if (task.id >= Task::nextId) {
-        Task::nextId = task.id + 1;
+    if (json.contains("recurrenceId")) {
+        task.recurrenceId = json["recurrenceId"].toInt();
+        task.occurrenceDate = IsoDate::parseDate(json["occurrenceDate"].toString());
+    }
+    if (json.contains("parentId")) {
+        task.parentId = idFromJson(json["parentId"]);
+    }
+    for (const QJsonValue& blocker : json["blockedBy"].toArray()) {
+        task.blockedBy.append(idFromJson(blocker));
     }
 
     return task;
@@ -6,6 +6,11 @@
 #include <QDateTime>
 #include <QJsonObject>
 #include <QColor>
+#include <QList>
+
+// Идентификатор задачи: 64 бита, растёт со временем создания и уникален между
+// устройствами без общего счётчика (см. Task::generateId). 0 — ещё не назначен.
+typedef qint64 TaskId;
 
 enum class Priority {
     Low = 0,
@@ -25,7 +30,7 @@ public:
          Priority priority = Priority::Medium, const QString& category = "");
 
     // Геттеры
-    int getId() const { return id; }
+    TaskId getId() const { return id; }
     QString getTitle() const { return title; }
     QString getDescription() const { return description; }
     QDate getDeadline() const { return deadline; }
@@ -34,6 +39,11 @@ public:
     TaskStatus getStatus() const { return status; }
     QDateTime getCreatedAt() const { return createdAt; }
     QDateTime getCompletedAt() const { return completedAt; }
+    int getRecurrenceId() const { return recurrenceId; }       // 0 — обычная задача
+    QDate getOccurrenceDate() const { return occurrenceDate; }  // дата вхождения правила
+    TaskId getParentId() const { return parentId; }             // 0 — не подзадача
+    QList<TaskId> getBlockedBy() const { return blockedBy; }   // что нужно выполнить раньше
+    bool hasLinks() const { return parentId != 0 || !blockedBy.isEmpty(); }
 
     // Сеттеры
     void setTitle(const QString& title) { this->title = title; }
@@ -42,22 +52,40 @@ public:
     void setPriority(Priority priority) { this->priority = priority; }
     void setCategory(const QString& category) { this->category = category; }
     void setStatus(TaskStatus status);
-    void setId(int id) { this->id = id; }
+    void setId(TaskId id) { this->id = id; }
+    void setRecurrence(int ruleId, const QDate& date) { recurrenceId = ruleId; occurrenceDate = date; }
+    void setParentId(TaskId parentId) { this->parentId = parentId; }
+    void setBlockedBy(const QList<TaskId>& taskIds) { blockedBy = taskIds; }
 
     // Утилиты
     bool isOverdue() const;
     bool isDueToday() const;
     bool isDueThisWeek() const;
+    bool isOverdue(const QDate& today) const;
+    bool isDueToday(const QDate& today) const;
+    bool isDueThisWeek(const QDate& today) const;
     QString priorityToString() const;
     QString statusToString() const;
     QColor priorityColor() const;
 
+    // Совпадение всех полей (сравнение с версией из файла при внешней правке)
+    bool operator==(const Task& other) const;
+    bool operator!=(const Task& other) const { return !(*this == other); }
+
     // JSON сериализация
     QJsonObject toJson() const;
     static Task fromJson(const QJsonObject& json);
 
+    // Новый id: [42 бита — мс с 2024-01-01][12 бит — случайный узел потока][10 бит — номер в мс]
+    static TaskId generateId();
+    static TaskId idFromJson(const QJsonValue& value);   // строка или число (старые файлы)
+
 private:
-    int id;
+    // Для fromJson: createdAt всё равно придёт из JSON, часы на каждую запись не читаются
+    enum Unstamped { NoTimestamp };
+    explicit Task(Unstamped);
+
+    TaskId id;
     QString title;
     QString description;
     QDate deadline;
@@ -66,8 +94,10 @@ private:
     TaskStatus status;
     QDateTime createdAt;
     QDateTime completedAt;
-
-    static int nextId;
+    int recurrenceId;
+    QDate occurrenceDate;
+    TaskId parentId;
+    QList<TaskId> blockedBy;
 };
 
 #endif // TASK_H
@@ -0,0 +1,140 @@
+#include "taskdialog.h"
+#include <QFormLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QTextEdit>
+#include <QDateEdit>
+#include <QComboBox>
+#include <QListWidget>
+#include <QSet>
+
+TaskDialog::TaskDialog(QWidget* parent) : QDialog(parent) {
+    setObjectName("taskDialog");
+    setMinimumWidth(520);
+
+    QFormLayout* form = new QFormLayout(this);
+    form->setSpacing(14);
+    form->setContentsMargins(24, 24, 24, 24);
+
+    titleEdit = new QLineEdit(this);
+    titleEdit->setPlaceholderText("Введите название задачи");
+    descriptionEdit = new QTextEdit(this);
+    descriptionEdit->setPlaceholderText("Описание (необязательно)");
+    descriptionEdit->setMaximumHeight(100);
+    deadlineEdit = new QDateEdit(this);
+    deadlineEdit->setCalendarPopup(true);
+    deadlineEdit->setDisplayFormat("dd.MM.yyyy");
+    priorityCombo = new QComboBox(this);
+    priorityCombo->addItem("Низкий", static_cast<int>(Priority::Low));
+    priorityCombo->addItem("Средний", static_cast<int>(Priority::Medium));
+    priorityCombo->addItem("Высокий", static_cast<int>(Priority::High));
+    categoryEdit = new QLineEdit(this);
+    categoryEdit->setPlaceholderText("Например: Английский, Молитва");
+    parentCombo = new QComboBox(this);
+    blockersList = new QListWidget(this);
+    blockersList->setMaximumHeight(120);
+
+    form->addRow("Название:", titleEdit);
+    form->addRow("Описание:", descriptionEdit);
+    form->addRow("Срок:", deadlineEdit);
+    form->addRow("Приоритет:", priorityCombo);
+    form->addRow("Категория:", categoryEdit);
+    form->addRow("Подзадача для:", parentCombo);
+    form->addRow("Сначала выполнить:", blockersList);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    if (QPushButton* cancelBtn = buttons->button(QDialogButtonBox::Cancel)) {
+        cancelBtn->setObjectName("cancelButton");
+    }
+    form->addRow(buttons);
+
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+}
+
+static QString linkLabel(const Task& task) {
+    return task.getTitle() + " — " + task.getDeadline().toString("dd.MM");
+}
+
+void TaskDialog::setLinkCandidates(const QList<Task>& candidates) {
+    parentCombo->clear();
+    parentCombo->addItem("—", QVariant::fromValue<qint64>(0));
+    blockersList->clear();
+    for (const Task& candidate : candidates) {
+        parentCombo->addItem(linkLabel(candidate), QVariant::fromValue<qint64>(candidate.getId()));
+        QListWidgetItem* item = new QListWidgetItem(linkLabel(candidate), blockersList);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+        item->setData(Qt::UserRole, QVariant::fromValue<qint64>(candidate.getId()));
+    }
+}
+
+void TaskDialog::setTask(const Task* task, const QDate& defaultDeadline) {
+    setWindowTitle(task ? "Редактировать задачу" : "Новая задача");
+    if (task) {
+        titleEdit->setText(task->getTitle());
+        descriptionEdit->setPlainText(task->getDescription());
+        deadlineEdit->setDate(task->getDeadline());
+        priorityCombo->setCurrentIndex(static_cast<int>(task->getPriority()));
+        categoryEdit->setText(task->getCategory());
+    } else {
+        titleEdit->clear();
+        descriptionEdit->clear();
+        deadlineEdit->setDate(defaultDeadline);
+        priorityCombo->setCurrentIndex(0);
+        categoryEdit->clear();
+    }
+
+    // Сама задача не может быть своим родителем или зависимостью
+    TaskId id = task ? task->getId() : 0;
+    QList<TaskId> blockers = task ? task->getBlockedBy() : QList<TaskId>();
+    int self = id != 0 ? parentCombo->findData(QVariant::fromValue<qint64>(id)) : -1;
+    if (self > 0) {
+        parentCombo->removeItem(self);
+    }
+    TaskId parentId = task ? task->getParentId() : 0;
+    int parent = parentCombo->findData(QVariant::fromValue<qint64>(parentId));
+    if (parent < 0) {
+        // Родитель вне списка (другой месяц) — оставляем связь как есть
+        parentCombo->addItem(QString("Задача #%1").arg(parentId), QVariant::fromValue<qint64>(parentId));
+        parent = parentCombo->count() - 1;
+    }
+    parentCombo->setCurrentIndex(parent);
+    for (int row = blockersList->count() - 1; row >= 0; --row) {
+        QListWidgetItem* item = blockersList->item(row);
+        TaskId itemId = item->data(Qt::UserRole).toLongLong();
+        if (id != 0 && itemId == id) {
+            delete item;
+            continue;
+        }
+        item->setCheckState(blockers.contains(itemId) ? Qt::Checked : Qt::Unchecked);
+    }
+    titleEdit->setFocus();
+}
+
+void TaskDialog::applyTo(Task& task) const {
+    task.setTitle(titleEdit->text());
+    task.setDescription(descriptionEdit->toPlainText());
+    task.setDeadline(deadlineEdit->date());
+    task.setPriority(static_cast<Priority>(priorityCombo->currentData().toInt()));
+    task.setCategory(categoryEdit->text());
+    task.setParentId(parentCombo->currentData().toLongLong());
+    // Связи с задачами вне списка (другие месяцы) сохраняются как были
+    QList<TaskId> blockers;
+    QSet<TaskId> listed;
+    for (int row = 0; row < blockersList->count(); ++row) {
+        QListWidgetItem* item = blockersList->item(row);
+        TaskId itemId = item->data(Qt::UserRole).toLongLong();
+        listed.insert(itemId);
+        if (item->checkState() == Qt::Checked) {
+            blockers.append(itemId);
+        }
+    }
+    for (TaskId blocker : task.getBlockedBy()) {
+        if (!listed.contains(blocker) && !blockers.contains(blocker)) {
+            blockers.append(blocker);
+        }
+    }
+    task.setBlockedBy(blockers);
+}
@@ -0,0 +1,36 @@
+#ifndef TASKDIALOG_H
+#define TASKDIALOG_H
+
+#include <QDialog>
+#include "task.h"
+
+class QLineEdit;
+class QTextEdit;
+class QDateEdit;
+class QComboBox;
+class QListWidget;
+
+// Диалог создания/редактирования задачи. Создаётся один раз и переиспользуется:
+// форма и стили не строятся заново при каждом открытии.
+class TaskDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit TaskDialog(QWidget* parent = nullptr);
+
+    // Задачи для выбора родителя и зависимостей; вызывается перед setTask
+    void setLinkCandidates(const QList<Task>& candidates);
+    void setTask(const Task* task, const QDate& defaultDeadline);  // nullptr — новая задача
+    void applyTo(Task& task) const;                                // записать поля формы в задачу
+
+private:
+    QLineEdit* titleEdit;
+    QTextEdit* descriptionEdit;
+    QDateEdit* deadlineEdit;
+    QComboBox* priorityCombo;
+    QLineEdit* categoryEdit;
+    QComboBox* parentCombo;
+    QListWidget* blockersList;     // отмеченные — задачи, которые нужно выполнить раньше
+};
+
+#endif // TASKDIALOG_H
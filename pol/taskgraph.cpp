@@ -0,0 +1,248 @@
+#include "taskgraph.h"
+#include <QJsonArray>
+
+bool TaskGraph::isOpen(TaskId taskId) const {
+    QHash<TaskId, Node>::const_iterator it = nodes.constFind(taskId);
+    return it != nodes.constEnd() && it->exists && !it->completed;
+}
+
+bool TaskGraph::isKnown(TaskId taskId) const {
+    QHash<TaskId, Node>::const_iterator it = nodes.constFind(taskId);
+    return it != nodes.constEnd() && it->exists;
+}
+
+bool TaskGraph::isBlocked(TaskId taskId) const {
+    QHash<TaskId, Node>::const_iterator it = nodes.constFind(taskId);
+    return it != nodes.constEnd() && it->openBlockers > 0;
+}
+
+TaskGraph::Progress TaskGraph::progress(TaskId taskId) const {
+    Progress result = { 0, 0 };
+    QHash<TaskId, Node>::const_iterator it = nodes.constFind(taskId);
+    if (it != nodes.constEnd()) {
+        result.done = it->doneChildren;
+        result.total = it->children.size();
+    }
+    return result;
+}
+
+void TaskGraph::addBlockers(TaskId taskId, int delta, QSet<TaskId>& affected) {
+    Node& node = nodes[taskId];
+    bool wasBlocked = node.openBlockers > 0;
+    node.openBlockers += delta;
+    if (wasBlocked != (node.openBlockers > 0)) {
+        affected.insert(taskId);
+    }
+}
+
+void TaskGraph::update(const Task& task, QSet<TaskId>& affected, QList<TaskId>* unknown) {
+    TaskId id = task.getId();
+    TaskId parent = task.getParentId() == id ? 0 : task.getParentId();
+    QList<TaskId> blockedBy;
+    for (TaskId blocker : task.getBlockedBy()) {
+        if (blocker != 0 && blocker != id && !blockedBy.contains(blocker)) {
+            blockedBy.append(blocker);
+        }
+    }
+
+    Node& node = nodes[id];
+    bool wasOpen = node.exists && !node.completed;
+    bool wasDone = node.exists && node.completed;
+    bool done = task.getStatus() == TaskStatus::Completed;
+    node.exists = true;
+    node.completed = done;
+
+    // Смена отметки: блокировка зависящих и прогресс родителя
+    if (wasOpen != !done) {
+        for (TaskId dependent : node.dependents) {
+            addBlockers(dependent, done ? -1 : 1, affected);
+        }
+    }
+    TaskId oldParent = node.parent;
+    if (oldParent != parent || wasDone != done) {
+        if (oldParent != 0) {
+            Node& p = nodes[oldParent];
+            p.children.removeOne(id);
+            p.doneChildren -= wasDone ? 1 : 0;
+            affected.insert(oldParent);
+        }
+        if (parent != 0) {
+            Node& p = nodes[parent];
+            p.children.append(id);
+            p.doneChildren += done ? 1 : 0;
+            affected.insert(parent);
+            if (unknown && oldParent != parent && !p.exists) {
+                unknown->append(parent);
+            }
+        }
+        nodes[id].parent = parent;
+    }
+
+    // Изменившиеся рёбра «ждёт выполнения»
+    QList<TaskId> oldBlockers = nodes[id].blockedBy;
+    for (TaskId blocker : oldBlockers) {
+        if (!blockedBy.contains(blocker)) {
+            nodes[blocker].dependents.removeOne(id);
+            if (isOpen(blocker)) {
+                addBlockers(id, -1, affected);
+            }
+            dropIfUnused(blocker);
+        }
+    }
+    for (TaskId blocker : blockedBy) {
+        if (!oldBlockers.contains(blocker)) {
+            Node& b = nodes[blocker];
+            b.dependents.append(id);
+            if (b.exists && !b.completed) {
+                addBlockers(id, 1, affected);
+            } else if (unknown && !b.exists) {
+                unknown->append(blocker);
+            }
+        }
+    }
+    nodes[id].blockedBy = blockedBy;
+
+    if (oldParent != parent && oldParent != 0) {
+        dropIfUnused(oldParent);
+    }
+    dropIfUnused(id);
+    affected.remove(id);
+}
+
+void TaskGraph::remove(TaskId taskId, QSet<TaskId>& affected) {
+    if (!nodes.contains(taskId)) {
+        return;
+    }
+    // Удалённая задача больше никого не блокирует; её подзадачи остаются со ссылкой на неё
+    Node& node = nodes[taskId];
+    bool wasOpen = node.exists && !node.completed;
+    bool wasDone = node.exists && node.completed;
+    if (wasOpen) {
+        for (TaskId dependent : node.dependents) {
+            addBlockers(dependent, -1, affected);
+        }
+    }
+    TaskId parent = node.parent;
+    QList<TaskId> blockers = node.blockedBy;
+    node.exists = false;
+    node.completed = false;
+    node.parent = 0;
+    node.blockedBy.clear();
+    node.openBlockers = 0;
+
+    if (parent != 0) {
+        Node& p = nodes[parent];
+        p.children.removeOne(taskId);
+        p.doneChildren -= wasDone ? 1 : 0;
+        affected.insert(parent);
+        dropIfUnused(parent);
+    }
+    for (TaskId blocker : blockers) {
+        nodes[blocker].dependents.removeOne(taskId);
+        dropIfUnused(blocker);
+    }
+    dropIfUnused(taskId);
+    affected.remove(taskId);
+}
+
+void TaskGraph::dropIfUnused(TaskId taskId) {
+    QHash<TaskId, Node>::iterator it = nodes.find(taskId);
+    if (it != nodes.end() && it->parent == 0 && it->blockedBy.isEmpty()
+        && it->children.isEmpty() && it->dependents.isEmpty()) {
+        nodes.erase(it);
+    }
+}
+
+bool TaskGraph::createsCycle(TaskId taskId, TaskId blockerId) const {
+    // Цикл, если blockerId сам (через цепочку) ждёт taskId
+    QList<TaskId> stack;
+    QSet<TaskId> visited;
+    stack.append(blockerId);
+    while (!stack.isEmpty()) {
+        TaskId current = stack.takeLast();
+        if (current == taskId) {
+            return true;
+        }
+        if (visited.contains(current)) {
+            continue;
+        }
+        visited.insert(current);
+        QHash<TaskId, Node>::const_iterator it = nodes.constFind(current);
+        if (it != nodes.constEnd()) {
+            stack.append(it->blockedBy);
+        }
+    }
+    return false;
+}
+
+bool TaskGraph::createsParentCycle(TaskId taskId, TaskId parentId) const {
+    int steps = nodes.size() + 1;     // защита от цикла, пришедшего из старых данных
+    for (TaskId current = parentId; current != 0 && steps-- > 0; current = nodes.value(current).parent) {
+        if (current == taskId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QJsonObject TaskGraph::toJson() const {
+    QJsonObject obj;
+    for (QHash<TaskId, Node>::const_iterator it = nodes.constBegin(); it != nodes.constEnd(); ++it) {
+        if (!it->exists) {
+            continue;
+        }
+        QJsonObject node;
+        if (it->parent != 0) {
+            node["p"] = QString::number(it->parent);
+        }
+        if (!it->blockedBy.isEmpty()) {
+            QJsonArray blockers;
+            for (TaskId blocker : it->blockedBy) {
+                blockers.append(QString::number(blocker));
+            }
+            node["b"] = blockers;
+        }
+        if (it->completed) {
+            node["c"] = true;
+        }
+        obj[QString::number(it.key())] = node;
+    }
+    return obj;
+}
+
+void TaskGraph::fromJson(const QJsonObject& obj) {
+    // Сначала узлы, затем обратные рёбра и счётчики одним проходом
+    nodes.clear();
+    nodes.reserve(obj.size());
+    QList<TaskId> ids;
+    for (QJsonObject::const_iterator it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        TaskId id = it.key().toLongLong();
+        QJsonObject o = it.value().toObject();
+        Node& node = nodes[id];
+        node.exists = true;
+        node.completed = o["c"].toBool();
+        node.parent = Task::idFromJson(o["p"]);
+        for (const QJsonValue& blocker : o["b"].toArray()) {
+            node.blockedBy.append(Task::idFromJson(blocker));
+        }
+        ids.append(id);
+    }
+    for (TaskId id : ids) {
+        const Node node = nodes.value(id);
+        if (node.parent != 0) {
+            Node& p = nodes[node.parent];
+            p.children.append(id);
+            p.doneChildren += node.completed ? 1 : 0;
+        }
+        for (TaskId blocker : node.blockedBy) {
+            nodes[blocker].dependents.append(id);
+        }
+    }
+    for (TaskId id : ids) {
+        int open = 0;
+        for (TaskId blocker : nodes.value(id).blockedBy) {
+            open += isOpen(blocker) ? 1 : 0;
+        }
+        nodes[id].openBlockers = open;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include "task.h"
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QJsonObject>
+
+// Связи задач: подзадачи и «ждёт выполнения». В графе только задачи со связями и те,
+// на кого ссылаются; у каждой — число невыполненных блокирующих и выполненных подзадач.
+// Отметка или правка задачи меняет счётчики только её соседей, весь граф не пересчитывается.
+// Ведётся TaskManager и сохраняется рядом с разделами, как CompletionHistory.
+class TaskGraph {
+public:
+    struct Progress {
+        int done;
+        int total;
+    };
+
+    bool contains(TaskId taskId) const { return nodes.contains(taskId); }
+    bool isKnown(TaskId taskId) const;      // состояние задачи передано в update, а не только ссылка
+    // Состояние задачи после правки; в affected — соседи, у которых сменилась
+    // блокировка или прогресс подзадач
+    // unknown — задачи, на которые появилась ссылка, но чьё состояние графу ещё не передано
+    void update(const Task& task, QSet<TaskId>& affected, QList<TaskId>* unknown = nullptr);
+    void remove(TaskId taskId, QSet<TaskId>& affected);
+    void clear() { nodes.clear(); }
+
+    bool isBlocked(TaskId taskId) const;     // есть невыполненная задача, которую она ждёт
+    Progress progress(TaskId taskId) const;
+    QList<TaskId> children(TaskId taskId) const { return nodes.value(taskId).children; }
+    QList<TaskId> dependents(TaskId taskId) const { return nodes.value(taskId).dependents; }
+
+    // Замкнёт ли связь цикл. Обход идёт только вверх от новой блокирующей задачи
+    // (или по цепочке родителей), а не по всему графу
+    bool createsCycle(TaskId taskId, TaskId blockerId) const;
+    bool createsParentCycle(TaskId taskId, TaskId parentId) const;
+
+    QJsonObject toJson() const;             // {"id": {"p": "родитель", "b": ["id", ...], "c": true}, ...}
+    void fromJson(const QJsonObject& obj);
+
+private:
+    struct Node {
+        Node() : parent(0), exists(false), completed(false), openBlockers(0), doneChildren(0) {}
+        TaskId parent;
+        QList<TaskId> blockedBy;
+        QList<TaskId> dependents;   // обратные рёбра blockedBy
+        QList<TaskId> children;
+        bool exists;                // задача есть, а не только ссылка на неё
+        bool completed;
+        int openBlockers;           // существующих невыполненных среди blockedBy
+        int doneChildren;
+    };
+
+    QHash<TaskId, Node> nodes;
+
+    bool isOpen(TaskId taskId) const;
+    void addBlockers(TaskId taskId, int delta, QSet<TaskId>& affected);
+    void dropIfUnused(TaskId taskId);
+};
+
+#endif // TASKGRAPH_H
@@ -1,60 +1,590 @@
 #include "taskmanager.h"
+#include "storagebackend.h"
+#include "jsonstorage.h"
+#include "trace.h"
+#include "clock.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QDir>
 #include <QStandardPaths>
 #include <QDebug>
+#include <QTimer>
+#include <QDateTime>
+#include <algorithm>
 
-TaskManager::TaskManager() {
+TaskManager::TaskManager(QObject* parent, LoadMode mode)
+    : QObject(parent), rulesDirty(false), overdueValid(false), nearValid(false),
+      historyDirty(false), graphDirty(false), undoBudget(UNDO_BUDGET_BYTES), replaying(false), untrackedDepth(0),
+      untrackedChanged(false), batchDepth(0), batchNeedsSave(false), batchFullReload(false) {
     // Используем папку AppData для хранения данных
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir().mkpath(appDataPath);
     dataFile = appDataPath + "/tasks.json";
+    accessClock.start();
 
-    loadFromFile();
+    if (mode == LoadNow) {
+        loadFromFile();
+    }
+
+    evictTimer = new QTimer(this);
+    evictTimer->setInterval(EVICT_CHECK_MSECS);
+    connect(evictTimer, &QTimer::timeout, this, [this]() {
+        evictIdlePartitions(EVICT_IDLE_MSECS);
+    });
+    evictTimer->start();
+
+    rolloverTimer = new QTimer(this);
+    rolloverTimer->setSingleShot(true);
+    rolloverTimer->setTimerType(Qt::PreciseTimer);
+    connect(rolloverTimer, &QTimer::timeout, this, &TaskManager::checkDay);
+    armRollover();
 }
 
 TaskManager::~TaskManager() {
     saveToFile();
 }
 
-void TaskManager::addTask(const Task& task) {
+TaskId TaskManager::addTask(const Task& task) {
+    int key = partitionKey(task.getDeadline());
+    loadPartition(key);
     tasks.append(task);
-    saveToFile();
+    if (tasks.last().getId() == 0) {
+        tasks.last().setId(Task::generateId());
+    }
+    TaskId id = tasks.last().getId();
+    dropCyclicLinks(tasks.last());
+    noteUndo(id);
+    rebuildIndex(tasks.size() - 1);
+    markDirty(key, id);
+    changed(id);
+    return id;
 }
 
 void TaskManager::updateTask(const Task& task) {
-    for (int i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].getId() == task.getId()) {
-            tasks[i] = task;
-            saveToFile();
-            return;
+    // Копия: task может указывать внутрь tasks, а загрузка раздела её перемещает
+    Task updated = task;
+    int i = indexById.value(updated.getId(), -1);
+    if (i < 0) {
+        return;
+    }
+    dropCyclicLinks(updated);
+    int oldKey = partitionKey(tasks[i].getDeadline());
+    int newKey = partitionKey(updated.getDeadline());
+    if (updated.getRecurrenceId() != 0 && updated.getDeadline() != updated.getOccurrenceDate()) {
+        // Перенесённое вхождение больше не должно появляться на исходную дату
+        skipOccurrence(updated);
+    }
+    loadPartition(newKey);
+    noteUndo(updated.getId());
+    tasks[i] = updated;
+    markDirty(oldKey, updated.getId());
+    markDirty(newKey, updated.getId());
+    changed(updated.getId());
+}
+
+void TaskManager::deleteTask(TaskId taskId) {
+    int i = indexById.value(taskId, -1);
+    if (i < 0) {
+        return;
+    }
+    noteUndo(taskId);
+    markDirty(partitionKey(tasks[i].getDeadline()), taskId);
+    if (tasks[i].getRecurrenceId() != 0) {
+        skipOccurrence(tasks[i]);
+        occurrenceIds.remove(qMakePair(tasks[i].getRecurrenceId(), tasks[i].getOccurrenceDate().toJulianDay()));
+    }
+    tasks.removeAt(i);
+    indexById.remove(taskId);
+    rebuildIndex(i);
+    changed(taskId);
+}
+
+Task* TaskManager::getTask(TaskId taskId) {
+    int i = indexById.value(taskId, -1);
+    return i < 0 ? nullptr : &tasks[i];
+}
+
+void TaskManager::forEachTask(const std::function<void(const Task&)>& visit) const {
+    TRACE_SCOPE("TaskManager::forEachTask");
+    // Копия: visit может менять набор задач
+    QList<Task> resident = tasks;
+    for (const Task& task : resident) {
+        visit(task);
+    }
+    // Невыгруженные разделы не бывают грязными: перед выгрузкой они сохраняются
+    QList<int> keys;
+    for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        if (!it->loaded) {
+            keys.append(it.key());
+        }
+    }
+    for (int key : keys) {
+        QList<Task> stored;
+        StorageBackend::instance()->readPartition(key, stored);
+        for (const Task& task : stored) {
+            visit(task);
         }
     }
 }
 
-void TaskManager::deleteTask(int taskId) {
-    for (int i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].getId() == taskId) {
+Task* TaskManager::findTask(TaskId taskId, int partitionHint) {
+    Task* task = getTask(taskId);
+    if (task || taskId == 0) {
+        return task;
+    }
+    if (partitions.contains(partitionHint) && !partitions.value(partitionHint).loaded) {
+        loadPartition(partitionHint);
+        if ((task = getTask(taskId))) {
+            return task;
+        }
+    }
+    // Раздел по id не вычислить: поднимаем невыгруженные по одному, начиная с новых
+    QList<int> keys = partitions.keys();
+    for (int i = keys.size() - 1; i >= 0; --i) {
+        if (!partitions.value(keys[i]).loaded) {
+            loadPartition(keys[i]);
+            if ((task = getTask(taskId))) {
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void TaskManager::beginBatch() {
+    batchDepth++;
+}
+
+void TaskManager::commitBatch() {
+    if (batchDepth == 0) {
+        return;
+    }
+    if (--batchDepth > 0) {
+        return;
+    }
+    closeUndoStep();
+    if (batchNeedsSave) {
+        saveToFile();
+    }
+    QList<TaskId> ids = batchChangedIds.values();
+    bool fullReload = batchFullReload;
+    batchChangedIds.clear();
+    batchNeedsSave = false;
+    batchFullReload = false;
+    if (fullReload) {
+        emit ruleListChanged(ids);
+        emit tasksChanged(QList<TaskId>());
+    } else if (!ids.isEmpty()) {
+        emit tasksChanged(ids);
+    }
+}
+
+void TaskManager::noteUndo(TaskId taskId) {
+    if (replaying) {
+        return;
+    }
+    if (untrackedDepth > 0) {
+        untrackedChanged = true;
+        return;
+    }
+    if (!openStep.before.contains(taskId)) {
+        int i = indexById.value(taskId, -1);
+        openStep.before.insert(taskId, i < 0 ? Task() : tasks[i]);
+    }
+}
+
+void TaskManager::noteUndoRules() {
+    if (replaying) {
+        return;
+    }
+    if (untrackedDepth > 0) {
+        untrackedChanged = true;
+        return;
+    }
+    if (!openStep.rulesTouched) {
+        openStep.rulesTouched = true;
+        openStep.rulesBefore = rules;      // общий буфер до первой правки
+    }
+}
+
+void TaskManager::closeUndoStep() {
+    if (openStep.before.isEmpty() && !openStep.rulesTouched) {
+        return;
+    }
+    UndoStep step = openStep;
+    openStep = UndoStep();
+    bool same = !step.rulesTouched;
+    for (QHash<TaskId, Task>::const_iterator it = step.before.constBegin(); it != step.before.constEnd(); ++it) {
+        int i = indexById.value(it.key(), -1);
+        Task after = i < 0 ? Task() : tasks[i];
+        same = same && after.getId() == it->getId() && (after.getId() == 0 || after == *it);
+        step.bytes += taskBytes(*it) + taskBytes(after);
+        step.after.insert(it.key(), after);
+    }
+    if (same) {
+        return;
+    }
+    if (step.rulesTouched) {
+        step.rulesAfter = rules;
+        step.bytes += (step.rulesBefore.size() + step.rulesAfter.size()) * 256;
+    }
+    undoSteps.append(step);
+    redoSteps.clear();
+    trimUndo();
+    emit undoStateChanged();
+}
+
+qint64 TaskManager::undoHistoryBytes() const {
+    qint64 bytes = 0;
+    for (const UndoStep& step : undoSteps) {
+        bytes += step.bytes;
+    }
+    for (const UndoStep& step : redoSteps) {
+        bytes += step.bytes;
+    }
+    return bytes;
+}
+
+void TaskManager::setUndoBudget(qint64 bytes) {
+    undoBudget = bytes;
+    trimUndo();
+    emit undoStateChanged();
+}
+
+void TaskManager::trimUndo() {
+    // Сначала отбрасываются самые старые шаги отмены, затем самые дальние шаги повтора
+    qint64 bytes = undoHistoryBytes();
+    while (bytes > undoBudget && !undoSteps.isEmpty()) {
+        bytes -= undoSteps.takeFirst().bytes;
+    }
+    while (bytes > undoBudget && !redoSteps.isEmpty()) {
+        bytes -= redoSteps.takeFirst().bytes;
+    }
+}
+
+void TaskManager::clearUndo() {
+    openStep = UndoStep();
+    if (undoSteps.isEmpty() && redoSteps.isEmpty()) {
+        return;
+    }
+    undoSteps.clear();
+    redoSteps.clear();
+    emit undoStateChanged();
+}
+
+void TaskManager::endUntracked() {
+    if (--untrackedDepth == 0 && untrackedChanged) {
+        untrackedChanged = false;
+        clearUndo();
+    }
+}
+
+bool TaskManager::undo() {
+    if (undoSteps.isEmpty() || batchDepth > 0) {
+        return false;
+    }
+    UndoStep step = undoSteps.takeLast();
+    replayStep(step, true);
+    redoSteps.append(step);
+    emit undoStateChanged();
+    return true;
+}
+
+bool TaskManager::redo() {
+    if (redoSteps.isEmpty() || batchDepth > 0) {
+        return false;
+    }
+    UndoStep step = redoSteps.takeLast();
+    replayStep(step, false);
+    undoSteps.append(step);
+    emit undoStateChanged();
+    return true;
+}
+
+void TaskManager::replayStep(const UndoStep& step, bool backwards) {
+    TRACE_SCOPE("TaskManager::replayStep");
+    const QHash<TaskId, Task>& from = backwards ? step.after : step.before;
+    const QHash<TaskId, Task>& to = backwards ? step.before : step.after;
+    replaying = true;
+    {
+        Batch batch(this);
+        for (QHash<TaskId, Task>::const_iterator it = to.constBegin(); it != to.constEnd(); ++it) {
+            restoreTask(it.key(), from.value(it.key()), *it);
+        }
+        if (step.rulesTouched) {
+            rules = backwards ? step.rulesBefore : step.rulesAfter;
+            rulesChanged();
+        }
+    }
+    replaying = false;
+
+    // Отметки выполнения отдаются владельцу: геймификация ведётся вне TaskManager
+    for (QHash<TaskId, Task>::const_iterator it = to.constBegin(); it != to.constEnd(); ++it) {
+        const Task& was = from.value(it.key());
+        bool wasCompleted = was.getId() != 0 && was.getStatus() == TaskStatus::Completed;
+        bool isCompleted = it->getId() != 0 && it->getStatus() == TaskStatus::Completed;
+        if (wasCompleted != isCompleted) {
+            emit statusRestored(it.key(), isCompleted ? TaskStatus::Completed : TaskStatus::Pending,
+                                (isCompleted ? *it : was).getCompletedAt().date());
+        }
+    }
+}
+
+void TaskManager::restoreTask(TaskId taskId, const Task& current, const Task& state) {
+    // Разделы могли выгрузиться после правки; skipOccurrence не нужен — правила восстанавливаются целиком
+    if (current.getId() != 0) {
+        loadPartition(partitionKey(current.getDeadline()));
+    }
+    if (state.getId() != 0) {
+        loadPartition(partitionKey(state.getDeadline()));
+    }
+    int i = indexById.value(taskId, -1);
+    if (i >= 0) {
+        markDirty(partitionKey(tasks[i].getDeadline()), taskId);
+        if (tasks[i].getRecurrenceId() != 0) {
+            occurrenceIds.remove(qMakePair(tasks[i].getRecurrenceId(), tasks[i].getOccurrenceDate().toJulianDay()));
+        }
+        if (state.getId() == 0) {
             tasks.removeAt(i);
-            saveToFile();
-            return;
+            indexById.remove(taskId);
+            rebuildIndex(i);
+        } else {
+            tasks[i] = state;
+            if (state.getRecurrenceId() != 0) {
+                occurrenceIds.insert(qMakePair(state.getRecurrenceId(), state.getOccurrenceDate().toJulianDay()), taskId);
+            }
+        }
+    } else if (state.getId() != 0) {
+        tasks.append(state);
+        rebuildIndex(tasks.size() - 1);
+    }
+    if (state.getId() != 0) {
+        markDirty(partitionKey(state.getDeadline()), taskId);
+    }
+    changed(taskId);
+}
+
+qint64 TaskManager::taskBytes(const Task& task) {
+    // Объект задачи, узел списка и записи индексов плюс символы строк UTF-16
+    return 256 + (task.getTitle().size() + task.getDescription().size() + task.getCategory().size()) * 2;
+}
+
+int TaskManager::addRule(const RecurrenceRule& rule) {
+    int maxId = 0;
+    for (const RecurrenceRule& r : rules) {
+        maxId = qMax(maxId, r.getId());
+    }
+    RecurrenceRule added = rule;
+    added.setId(maxId + 1);
+    noteUndoRules();
+    rules.append(added);
+    rulesChanged();
+    return added.getId();
+}
+
+void TaskManager::updateRule(const RecurrenceRule& rule) {
+    int i = ruleIndex(rule.getId());
+    if (i < 0) {
+        return;
+    }
+    noteUndoRules();
+    rules[i] = rule;
+    rulesChanged();
+}
+
+void TaskManager::setRule(const RecurrenceRule& rule) {
+    int i = ruleIndex(rule.getId());
+    noteUndoRules();
+    if (i < 0) {
+        rules.append(rule);
+    } else {
+        rules[i] = rule;
+    }
+    rulesChanged();
+}
+
+void TaskManager::deleteRule(int ruleId) {
+    // Уже сохранённые вхождения остаются в истории как обычные задачи
+    int i = ruleIndex(ruleId);
+    if (i < 0) {
+        return;
+    }
+    noteUndoRules();
+    rules.removeAt(i);
+    rulesChanged();
+}
+
+TaskId TaskManager::materializeOccurrence(int ruleId, const QDate& date) {
+    int r = ruleIndex(ruleId);
+    if (r < 0 || !rules[r].occursOn(date)) {
+        return 0;
+    }
+    loadPartition(partitionKey(date));
+    TaskId existing = occurrenceIds.value(qMakePair(ruleId, date.toJulianDay()), 0);
+    if (existing != 0) {
+        return existing;
+    }
+    return addTask(rules[r].makeOccurrence(date));
+}
+
+int TaskManager::rescheduleOverdueTasks(const QDate& newDeadline) {
+    Batch batch(this);
+    int newKey = partitionKey(newDeadline);
+    loadPartition(newKey);
+    loadOverduePartitions();
+    // changed() перекладывает задачи между корзинами, поэтому идём по копии
+    QList<TaskId> ids = overdueIds.keys();
+    int count = 0;
+    for (TaskId id : ids) {
+        int i = indexById.value(id, -1);
+        if (i < 0) {
+            continue;   // раздел не нашёлся в хранилище (удалён извне)
         }
+        if (tasks[i].getRecurrenceId() != 0 && tasks[i].getOccurrenceDate() != newDeadline) {
+            // Как в updateTask: перенесённое вхождение не должно вернуться на исходную дату
+            skipOccurrence(tasks[i]);
+        }
+        noteUndo(id);
+        markDirty(partitionKey(tasks[i].getDeadline()), id);
+        markDirty(newKey, id);
+        tasks[i].setDeadline(newDeadline);
+        changed(id);
+        count++;
     }
+    return count;
 }
 
-Task* TaskManager::getTask(int taskId) {
+int TaskManager::setStatusForDate(const QDate& date, TaskStatus status) {
+    Batch batch(this);
+    int key = partitionKey(date);
+    loadPartition(key);
+    int count = 0;
+    if (status == TaskStatus::Completed) {
+        for (const RecurrenceRule& rule : rules) {
+            if (rule.occursOn(date)) {
+                materializeOccurrence(rule.getId(), date);
+            }
+        }
+    }
     for (int i = 0; i < tasks.size(); ++i) {
-        if (tasks[i].getId() == taskId) {
-            return &tasks[i];
+        if (tasks[i].getDeadline() == date && tasks[i].getStatus() != status) {
+            noteUndo(tasks[i].getId());
+            markDirty(key, tasks[i].getId());
+            tasks[i].setStatus(status);
+            changed(tasks[i].getId());
+            count++;
+        }
+    }
+    return count;
+}
+
+void TaskManager::rebuildIndex(int from) const {
+    if (from == 0) {
+        indexById.clear();
+        indexById.reserve(tasks.size());
+        occurrenceIds.clear();
+    }
+    for (int i = from; i < tasks.size(); ++i) {
+        const Task& task = tasks[i];
+        indexById.insert(task.getId(), i);
+        if (task.getRecurrenceId() != 0) {
+            occurrenceIds.insert(qMakePair(task.getRecurrenceId(), task.getOccurrenceDate().toJulianDay()), task.getId());
+        }
+    }
+}
+
+void TaskManager::rulesChanged() {
+    rulesDirty = true;
+    if (batchDepth > 0) {
+        batchNeedsSave = true;
+        batchFullReload = true;
+        return;
+    }
+    closeUndoStep();
+    saveToFile();
+    emit ruleListChanged(QList<TaskId>());
+    emit tasksChanged(QList<TaskId>());
+}
+
+int TaskManager::ruleIndex(int ruleId) const {
+    for (int i = 0; i < rules.size(); ++i) {
+        if (rules[i].getId() == ruleId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void TaskManager::skipOccurrence(const Task& task) {
+    int r = ruleIndex(task.getRecurrenceId());
+    if (r >= 0 && rules[r].occursOn(task.getOccurrenceDate())) {
+        noteUndoRules();
+        rules[r].skipDate(task.getOccurrenceDate());
+        rulesDirty = true;
+    }
+}
+
+void TaskManager::changed(TaskId taskId) {
+    rebucket(taskId);
+    trackCompletion(taskId);
+    QList<TaskId> ids = trackLinks(taskId);
+    ids.prepend(taskId);
+    if (batchDepth > 0) {
+        for (TaskId id : ids) {
+            batchChangedIds.insert(id);
+        }
+        batchNeedsSave = true;
+        return;
+    }
+    closeUndoStep();
+    saveToFile();
+    emit tasksChanged(ids);
+}
+
+QList<Task> TaskManager::getAllTasks() const {
+    TRACE_SCOPE("TaskManager::getAllTasks");
+    ensureAllLoaded();
+    return tasks;
+}
+
+QList<Task> TaskManager::getTasksForDate(const QDate& date) const {
+    return getTasksInRange(date, date);
+}
+
+QList<Task> TaskManager::getTasksInRange(const QDate& from, const QDate& to) const {
+    TRACE_SCOPE("TaskManager::getTasksInRange");
+    ensureLoaded(from, to);
+    QList<Task> result;
+    for (const Task& task : tasks) {
+        if (task.getDeadline() >= from && task.getDeadline() <= to) {
+            result.append(task);
+        }
+    }
+    appendOccurrences(result, from, to);
+    return result;
+}
+
+void TaskManager::appendOccurrences(QList<Task>& result, const QDate& from, const QDate& to) const {
+    // Невыполненные вхождения правил существуют только здесь, id у них 0.
+    // Разделы диапазона уже загружены, так что occurrenceIds для него полон.
+    for (const RecurrenceRule& rule : rules) {
+        for (const QDate& date : rule.occurrencesBetween(from, to)) {
+            if (!occurrenceIds.contains(qMakePair(rule.getId(), date.toJulianDay()))) {
+                result.append(rule.makeOccurrence(date));
+            }
         }
     }
-    return nullptr;
 }
 
 QList<Task> TaskManager::getTasksByStatus(TaskStatus status) const {
+    TRACE_SCOPE("TaskManager::getTasksByStatus");
     QList<Task> result;
+    if (storageIsCurrent() &&
+        StorageBackend::instance()->selectTasks(StorageBackend::ByStatus, static_cast<int>(status), result)) {
+        return result;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (task.getStatus() == status) {
             result.append(task);
@@ -64,7 +594,13 @@ QList<Task> TaskManager::getTasksByStatus(TaskStatus status) const {
 }
 
 QList<Task> TaskManager::getTasksByPriority(Priority priority) const {
+    TRACE_SCOPE("TaskManager::getTasksByPriority");
     QList<Task> result;
+    if (storageIsCurrent() &&
+        StorageBackend::instance()->selectTasks(StorageBackend::ByPriority, static_cast<int>(priority), result)) {
+        return result;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (task.getPriority() == priority) {
             result.append(task);
@@ -74,7 +610,13 @@ QList<Task> TaskManager::getTasksByPriority(Priority priority) const {
 }
 
 QList<Task> TaskManager::getTasksByCategory(const QString& category) const {
+    TRACE_SCOPE("TaskManager::getTasksByCategory");
     QList<Task> result;
+    if (storageIsCurrent() &&
+        StorageBackend::instance()->selectTasks(StorageBackend::ByCategory, category, result)) {
+        return result;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (task.getCategory() == category) {
             result.append(task);
@@ -84,37 +626,45 @@ QList<Task> TaskManager::getTasksByCategory(const QString& category) const {
 }
 
 QList<Task> TaskManager::getOverdueTasks() const {
-    QList<Task> result;
-    for (const Task& task : tasks) {
-        if (task.isOverdue()) {
-            result.append(task);
-        }
+    TRACE_SCOPE("TaskManager::getOverdueTasks");
+    loadOverduePartitions();
+    QSet<TaskId> ids;
+    ids.reserve(overdueIds.size());
+    for (QHash<TaskId, int>::const_iterator it = overdueIds.constBegin(); it != overdueIds.constEnd(); ++it) {
+        ids.insert(it.key());
     }
-    return result;
+    return bucketTasks(ids);
 }
 
 QList<Task> TaskManager::getTodayTasks() const {
-    QList<Task> result;
-    for (const Task& task : tasks) {
-        if (task.isDueToday()) {
-            result.append(task);
-        }
+    TRACE_SCOPE("TaskManager::getTodayTasks");
+    if (!nearValid) {
+        rebuildNear();
     }
+    ensureLoaded(day.getToday(), day.getWeekEnd());
+    QList<Task> result = bucketTasks(todayIds);
+    appendOccurrences(result, day.getToday(), day.getToday());
     return result;
 }
 
 QList<Task> TaskManager::getWeekTasks() const {
-    QList<Task> result;
-    for (const Task& task : tasks) {
-        if (task.isDueThisWeek() && !task.isDueToday()) {
-            result.append(task);
-        }
+    TRACE_SCOPE("TaskManager::getWeekTasks");
+    if (!nearValid) {
+        rebuildNear();
     }
+    ensureLoaded(day.getToday(), day.getWeekEnd());
+    QList<Task> result = bucketTasks(weekIds);
+    appendOccurrences(result, day.getToday().addDays(1), day.getWeekEnd());
     return result;
 }
 
 QStringList TaskManager::getCategories() const {
+    TRACE_SCOPE("TaskManager::getCategories");
     QStringList categories;
+    if (storageIsCurrent() && StorageBackend::instance()->selectCategories(categories)) {
+        return categories;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (!task.getCategory().isEmpty() && !categories.contains(task.getCategory())) {
             categories.append(task.getCategory());
@@ -125,55 +675,158 @@ QStringList TaskManager::getCategories() const {
 }
 
 bool TaskManager::saveToFile(const QString& filename) {
-    QJsonArray jsonArray;
-    for (const Task& task : tasks) {
-        jsonArray.append(task.toJson());
+    TRACE_SCOPE("TaskManager::saveToFile");
+    if (!filename.isEmpty()) {
+        ensureAllLoaded();
+        return JsonStorage::writeTaskFile(filename, tasks);
     }
 
-    QJsonDocument doc(jsonArray);
-    QFile file(filename.isEmpty() ? dataFile : filename);
-
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Не удалось открыть файл для записи:" << file.fileName();
-        return false;
+    // Записываем только изменённые разделы: правленые задачи или раздел целиком
+    QMap<int, QList<Task>> dirtyTasks;
+    for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        if (it->dirty) {
+            dirtyTasks.insert(it.key(), QList<Task>());
+        }
+    }
+    if (!dirtyTasks.isEmpty()) {
+        for (const Task& task : tasks) {
+            QMap<int, QList<Task>>::iterator it = dirtyTasks.find(partitionKey(task.getDeadline()));
+            if (it != dirtyTasks.end()) {
+                it->append(task);
+            }
+        }
     }
 
-    file.write(doc.toJson());
-    file.close();
-    return true;
+    StorageBackend* storage = StorageBackend::instance();
+    bool ok = true;
+    for (QMap<int, QList<Task>>::const_iterator it = dirtyTasks.constBegin(); it != dirtyTasks.constEnd(); ++it) {
+        Partition& p = partitions[it.key()];
+        if (it->isEmpty()) {
+            storage->removePartition(it.key());
+            partitions.remove(it.key());
+        } else if (p.rewrite ? storage->writePartition(it.key(), it.value())
+                             : storage->updatePartition(it.key(), it.value(), p.touched)) {
+            p.dirty = false;
+            p.rewrite = false;
+            p.touched.clear();
+        } else {
+            ok = false;
+        }
+    }
+    if (rulesDirty && saveRules()) {
+        rulesDirty = false;
+    }
+    if (historyDirty) {
+        saveHistory();
+    }
+    if (graphDirty) {
+        saveGraph();
+    }
+    return ok;
 }
 
 bool TaskManager::loadFromFile(const QString& filename) {
-    QFile file(filename.isEmpty() ? dataFile : filename);
-
-    if (!file.exists()) {
-        return false;
+    TRACE_SCOPE("TaskManager::loadFromFile");
+    if (!filename.isEmpty()) {
+        // Импорт: файл полностью заменяет текущий набор задач
+        QList<Task> imported;
+        if (!JsonStorage::readTaskFile(filename, imported)) {
+            return false;
+        }
+        for (Task& task : imported) {
+            if (task.getId() == 0) {
+                task.setId(Task::generateId());
+            }
+        }
+        ensureAllLoaded();
+        for (QMap<int, Partition>::iterator it = partitions.begin(); it != partitions.end(); ++it) {
+            it->dirty = true;
+            it->rewrite = true;
+        }
+        tasks = imported;
+        rebuildIndex();
+        invalidateBuckets();
+        // Набор заменён целиком — историю собираем заново по нему
+        history.clear();
+        completedDays.clear();
+        noteResidentCompletions(0);
+        for (qint64 day : completedDays) {
+            history.add(QDate::fromJulianDay(day), 1);
+        }
+        historyDirty = true;
+        graph.clear();
+        feedGraph(tasks, false);
+        feedGraph(tasks, true);
+        for (const Task& task : tasks) {
+            Partition& p = partitions[partitionKey(task.getDeadline())];
+            p.loaded = true;
+            p.dirty = true;
+            p.rewrite = true;
+            p.lastAccess = accessClock.elapsed();
+        }
+        saveToFile();
+        clearUndo();
+        emit tasksReloaded();
+        emit tasksChanged(QList<TaskId>());
+        return true;
     }
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Не удалось открыть файл для чтения:" << file.fileName();
-        return false;
+    loadPreloaded(preload());
+    return true;
+}
+
+TaskManager::Preload TaskManager::preload() {
+    TRACE_SCOPE("TaskManager::preload");
+    StorageBackend* storage = StorageBackend::instance();
+    Preload data;
+    data.keys = storage->partitionKeys();
+    for (int key : data.keys) {
+        if (isEager(key)) {
+            storage->readPartition(key, data.eager[key]);
+        }
     }
+    data.rules = storage->readDocument("recurrences");
+    data.history = storage->readDocument("history");
+    data.graph = storage->readDocument("graph");
+    return data;
+}
 
-    QByteArray data = file.readAll();
-    file.close();
+void TaskManager::loadPreloaded(const Preload& data) {
+    TRACE_SCOPE("TaskManager::loadPreloaded");
+    clearUndo();
+    tasks.clear();
+    indexById.clear();
+    partitions.clear();
+    rules.clear();
+    completedDays.clear();
+    invalidateBuckets();
 
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull() || !doc.isArray()) {
-        return false;
+    for (int key : data.keys) {
+        partitions[key];
+    }
+    // Старый tasks.json раскладывается по разделам — прочитанные заранее разделы тогда не годятся
+    bool migrated = partitions.isEmpty() && migrateLegacyFile();
+    if (migrated) {
+        scanPartitions();
     }
+    loadRules(data.rules);
+    loadHistory(data.history);
+    loadGraph(data.graph);
 
-    tasks.clear();
-    QJsonArray jsonArray = doc.array();
-    for (const QJsonValue& value : jsonArray) {
-        if (value.isObject()) {
-            tasks.append(Task::fromJson(value.toObject()));
+    for (int key : partitions.keys()) {
+        if (!isEager(key) || partitions.value(key).loaded) {
+            continue;   // раздел мог подгрузиться вместе с задачей не из своего месяца
+        }
+        if (!migrated && data.eager.contains(key)) {
+            installPartition(key, data.eager.value(key));
+        } else {
+            loadPartition(key);
         }
     }
 
-    // Если задач нет — добавляем задачи по умолчанию: английский и молитва
-    if (tasks.isEmpty()) {
-        QDate today = QDate::currentDate();
+    // Если задач нет — добавляем ежедневные задачи по умолчанию: английский и молитва
+    if (partitions.isEmpty() && rules.isEmpty()) {
+        QDate today = Clock::currentDate();
         Task englishTask(
             QStringLiteral("Английский"),
             QStringLiteral("Практика английского: слова, грамматика или чтение"),
@@ -188,16 +841,103 @@ bool TaskManager::loadFromFile(const QString& filename) {
             Priority::High,
             QStringLiteral("Молитва")
         );
-        tasks.append(englishTask);
-        tasks.append(prayerTask);
+        RecurrenceRule englishRule(englishTask, RecurrenceKind::Daily, today);
+        englishRule.setId(1);
+        RecurrenceRule prayerRule(prayerTask, RecurrenceKind::Daily, today);
+        prayerRule.setId(2);
+        rules.append(englishRule);
+        rules.append(prayerRule);
+        rulesDirty = true;
         saveToFile();
     }
 
-    return true;
+    emit tasksReloaded();
+    emit tasksChanged(QList<TaskId>());
+}
+
+int TaskManager::partitionKey(const QDate& deadline) {
+    if (!deadline.isValid()) {
+        return 0;
+    }
+    return deadline.year() * 100 + deadline.month();
+}
+
+int TaskManager::loadedPartitionCount() const {
+    int count = 0;
+    for (const Partition& p : partitions) {
+        if (p.loaded) {
+            count++;
+        }
+    }
+    return count;
+}
+
+qint64 TaskManager::residentBytes() const {
+    qint64 bytes = 0;
+    for (const Task& task : tasks) {
+        bytes += taskBytes(task);
+    }
+    return bytes;
+}
+
+int TaskManager::evictIdlePartitions(int idleMsecs) {
+    TRACE_SCOPE("TaskManager::evictIdlePartitions");
+    if (batchDepth > 0) {
+        return 0;
+    }
+
+    qint64 now = accessClock.elapsed();
+    QSet<int> victims;
+    for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        if (it->loaded && !isEager(it.key()) && now - it->lastAccess >= idleMsecs) {
+            victims.insert(it.key());
+        }
+    }
+    if (victims.isEmpty()) {
+        return 0;
+    }
+
+    // Несохранённые изменения сначала пишем на диск; не сохранилось — не выгружаем
+    saveToFile();
+    // Опустевшие разделы saveToFile удаляет из partitions — их тоже пропускаем
+    for (QSet<int>::iterator it = victims.begin(); it != victims.end();) {
+        QMap<int, Partition>::const_iterator partition = partitions.constFind(*it);
+        if (partition != partitions.constEnd() && partition->dirty) {
+            it = victims.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QList<Task> kept;
+    kept.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        if (!victims.contains(partitionKey(task.getDeadline()))) {
+            kept.append(task);
+        } else {
+            completedDays.remove(task.getId());
+        }
+    }
+    tasks = kept;
+    rebuildIndex();
+    for (int key : victims) {
+        QMap<int, Partition>::iterator partition = partitions.find(key);
+        if (partition != partitions.end()) {
+            partition->loaded = false;
+        }
+    }
+    return victims.size();
 }
 
 int TaskManager::getCompletedTodayCount() const {
-    QDate today = QDate::currentDate();
+    TRACE_SCOPE("TaskManager::getCompletedTodayCount");
+    QDate today = Clock::currentDate();
+    QMap<QDate, int> perDay;
+    if (storageIsCurrent() && StorageBackend::instance()->countCompletedPerDay(today, today, perDay)) {
+        return perDay.value(today);
+    }
+    // Выполнить можно и задачу со старым сроком — нужны все разделы
+    ensureAllLoaded();
     int count = 0;
     for (const Task& task : tasks) {
         if (task.getStatus() == TaskStatus::Completed &&
@@ -209,9 +949,18 @@ int TaskManager::getCompletedTodayCount() const {
 }
 
 int TaskManager::getCompletedThisWeekCount() const {
-    QDate today = QDate::currentDate();
+    TRACE_SCOPE("TaskManager::getCompletedThisWeekCount");
+    QDate today = Clock::currentDate();
     QDate weekStart = today.addDays(-today.dayOfWeek() + 1);
     int count = 0;
+    QMap<QDate, int> perDay;
+    if (storageIsCurrent() && StorageBackend::instance()->countCompletedPerDay(weekStart, weekStart.addDays(6), perDay)) {
+        for (int dayCount : perDay) {
+            count += dayCount;
+        }
+        return count;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (task.getStatus() == TaskStatus::Completed &&
             !task.getCompletedAt().isNull() &&
@@ -223,14 +972,25 @@ int TaskManager::getCompletedThisWeekCount() const {
 }
 
 QMap<QDate, int> TaskManager::getDailyCompletionStats(int days) const {
+    TRACE_SCOPE("TaskManager::getDailyCompletionStats");
     QMap<QDate, int> stats;
-    QDate today = QDate::currentDate();
+    QDate today = Clock::currentDate();
 
     // Инициализируем все даты нулями
     for (int i = 0; i < days; ++i) {
         stats[today.addDays(-i)] = 0;
     }
 
+    QMap<QDate, int> perDay;
+    if (days > 0 && storageIsCurrent() &&
+        StorageBackend::instance()->countCompletedPerDay(today.addDays(1 - days), today, perDay)) {
+        for (QMap<QDate, int>::const_iterator it = perDay.constBegin(); it != perDay.constEnd(); ++it) {
+            stats[it.key()] = it.value();
+        }
+        return stats;
+    }
+    ensureAllLoaded();
+
     // Подсчитываем выполненные задачи
     for (const Task& task : tasks) {
         if (task.getStatus() == TaskStatus::Completed && !task.getCompletedAt().isNull()) {
@@ -245,7 +1005,16 @@ QMap<QDate, int> TaskManager::getDailyCompletionStats(int days) const {
 }
 
 QMap<QString, int> TaskManager::getCategoryStats() const {
+    TRACE_SCOPE("TaskManager::getCategoryStats");
     QMap<QString, int> stats;
+    QMap<QString, int> counts;
+    if (storageIsCurrent() && StorageBackend::instance()->countByCategory(counts)) {
+        for (QMap<QString, int>::const_iterator it = counts.constBegin(); it != counts.constEnd(); ++it) {
+            stats[it.key().isEmpty() ? "Без категории" : it.key()] += it.value();
+        }
+        return stats;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         QString category = task.getCategory().isEmpty() ? "Без категории" : task.getCategory();
         stats[category]++;
@@ -254,7 +1023,12 @@ QMap<QString, int> TaskManager::getCategoryStats() const {
 }
 
 QMap<int, int> TaskManager::getPriorityStats() const {
+    TRACE_SCOPE("TaskManager::getPriorityStats");
     QMap<int, int> stats; // день недели (1-7) -> количество выполненных
+    if (storageIsCurrent() && StorageBackend::instance()->countCompletedByWeekday(stats)) {
+        return stats;
+    }
+    ensureAllLoaded();
     for (const Task& task : tasks) {
         if (task.getStatus() == TaskStatus::Completed && !task.getCompletedAt().isNull()) {
             int dayOfWeek = task.getCompletedAt().date().dayOfWeek();
@@ -264,12 +1038,579 @@ QMap<int, int> TaskManager::getPriorityStats() const {
     return stats;
 }
 
-void TaskManager::ensureDataFile() {
-    QFileInfo fileInfo(dataFile);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists()) {
-        dir.mkpath(".");
+bool TaskManager::storageIsCurrent() const {
+    // Выборку можно отдать хранилищу, только если в нём уже всё, что в памяти
+    if (batchDepth > 0) {
+        return false;
+    }
+    for (const Partition& p : partitions) {
+        if (p.dirty) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TaskManager::invalidateBuckets() {
+    overdueIds.clear();
+    todayIds.clear();
+    weekIds.clear();
+    overdueValid = false;
+    nearValid = false;
+}
+
+void TaskManager::rebuildOverdue() const {
+    // Просроченные могут быть в любом прошлом месяце: невыгруженные разделы читаются
+    // без установки в память — запоминаются только id и раздел
+    TRACE_SCOPE("TaskManager::rebuildOverdue");
+    overdueIds.clear();
+    for (const Task& task : tasks) {
+        if (day.classify(task) == DayContext::Overdue) {
+            overdueIds.insert(task.getId(), partitionKey(task.getDeadline()));
+        }
+    }
+    int last = partitionKey(day.getToday());
+    StorageBackend* storage = StorageBackend::instance();
+    for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        if (it->loaded || it.key() == 0 || it.key() > last) {
+            continue;
+        }
+        QList<Task> stored;
+        storage->readPartition(it.key(), stored);
+        for (const Task& task : stored) {
+            if (day.classify(task) == DayContext::Overdue) {
+                overdueIds.insert(task.getId(), it.key());
+            }
+        }
+    }
+    overdueValid = true;
+}
+
+void TaskManager::loadOverduePartitions() const {
+    if (!overdueValid) {
+        rebuildOverdue();
+    }
+    // Поднимаем только месяцы, где есть выгруженные просроченные задачи
+    QSet<int> keys;
+    for (QHash<TaskId, int>::const_iterator it = overdueIds.constBegin(); it != overdueIds.constEnd(); ++it) {
+        if (!indexById.contains(it.key())) {
+            keys.insert(it.value());
+        }
+    }
+    for (int key : keys) {
+        if (partitions.contains(key)) {
+            loadPartition(key);
+        }
+    }
+}
+
+void TaskManager::rebuildNear() const {
+    ensureLoaded(day.getToday(), day.getWeekEnd());
+    todayIds.clear();
+    weekIds.clear();
+    for (const Task& task : tasks) {
+        DayContext::Bucket bucket = day.classify(task);
+        if (bucket == DayContext::Today) {
+            todayIds.insert(task.getId());
+        } else if (bucket == DayContext::ThisWeek) {
+            weekIds.insert(task.getId());
+        }
+    }
+    nearValid = true;
+}
+
+void TaskManager::rebucket(TaskId taskId) const {
+    overdueIds.remove(taskId);
+    todayIds.remove(taskId);
+    weekIds.remove(taskId);
+    int i = indexById.value(taskId, -1);
+    if (i < 0) {
+        return;
+    }
+    switch (day.classify(tasks[i])) {
+        case DayContext::Overdue:
+            if (overdueValid) overdueIds.insert(taskId, partitionKey(tasks[i].getDeadline()));
+            break;
+        case DayContext::Today:
+            if (nearValid) todayIds.insert(taskId);
+            break;
+        case DayContext::ThisWeek:
+            if (nearValid) weekIds.insert(taskId);
+            break;
+        default:
+            break;
+    }
+}
+
+QList<Task> TaskManager::bucketTasks(const QSet<TaskId>& ids) const {
+    QList<Task> result;
+    result.reserve(ids.size());
+    for (TaskId id : ids) {
+        // Разделы корзины поднимает вызывающий (loadOverduePartitions, ensureLoaded)
+        int i = indexById.value(id, -1);
+        if (i >= 0) {
+            result.append(tasks[i]);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Task& a, const Task& b) {
+        return a.getDeadline() != b.getDeadline() ? a.getDeadline() < b.getDeadline() : a.getId() < b.getId();
+    });
+    return result;
+}
+
+void TaskManager::checkDay() {
+    TRACE_SCOPE("TaskManager::checkDay");
+    DayContext next;
+    if (next.getToday() == day.getToday()) {
+        armRollover();
+        return;
+    }
+
+    DayContext previous = day;
+    day = next;
+    if (previous.getToday().daysTo(next.getToday()) == 1 && nearValid) {
+        // Вчерашние невыполненные становятся просроченными
+        if (overdueValid) {
+            int key = partitionKey(previous.getToday());
+            for (TaskId taskId : todayIds) {
+                overdueIds.insert(taskId, key);
+            }
+        }
+        todayIds.clear();
+        if (next.getWeekStart() == previous.getWeekStart()) {
+            for (QSet<TaskId>::iterator it = weekIds.begin(); it != weekIds.end();) {
+                int i = indexById.value(*it, -1);
+                if (i >= 0 && tasks[i].getDeadline() == next.getToday()) {
+                    todayIds.insert(*it);
+                    it = weekIds.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        } else {
+            // Началась новая неделя: собираем её по разделам этой недели
+            rebuildNear();
+        }
+    } else {
+        // Пропущено несколько дней (сон, смена часов) — пересчитываем с нуля по запросу
+        invalidateBuckets();
+    }
+
+    emit dayChanged(day.getToday());
+    armRollover();
+}
+
+void TaskManager::armRollover() {
+    QDateTime midnight(day.getToday().addDays(1), QTime(0, 0));
+    qint64 msecs = Clock::currentDateTime().msecsTo(midnight) + 500;
+    // Не дольше часа: после сна устройства или перевода часов проверим заново
+    rolloverTimer->start(static_cast<int>(qBound<qint64>(1000, msecs, 60 * 60 * 1000)));
+}
+
+bool TaskManager::isEager(int key) {
+    if (key == 0) {
+        return true;
+    }
+    QDate today = Clock::currentDate();
+    return key >= partitionKey(today) && key <= partitionKey(today.addMonths(EAGER_MONTHS_AHEAD));
+}
+
+void TaskManager::scanPartitions() {
+    for (int key : StorageBackend::instance()->partitionKeys()) {
+        partitions[key];
     }
 }
 
+void TaskManager::loadPartition(int key) const {
+    TRACE_SCOPE("TaskManager::loadPartition");
+    Partition& p = partitions[key];
+    p.lastAccess = accessClock.elapsed();
+    if (p.loaded) {
+        return;
+    }
+    QList<Task> loaded;
+    StorageBackend::instance()->readPartition(key, loaded);
+    installPartition(key, loaded);
+}
+
+QList<int> TaskManager::missingPartitions(const QDate& from, const QDate& to) const {
+    QList<int> keys;
+    for (QMap<int, Partition>::const_iterator it = partitions.lowerBound(partitionKey(from));
+         it != partitions.constEnd() && it.key() <= partitionKey(to); ++it) {
+        if (!it->loaded) {
+            keys.append(it.key());
+        }
+    }
+    return keys;
+}
+
+void TaskManager::adoptPartition(int key, const QList<Task>& loaded) {
+    QMap<int, Partition>::const_iterator it = partitions.constFind(key);
+    // Пока файл читался, раздел могли загрузить или изменить — тогда чтение лишнее
+    if (it == partitions.constEnd() || it->loaded) {
+        return;
+    }
+    installPartition(key, loaded);
+}
+
+void TaskManager::installPartition(int key, const QList<Task>& loaded) const {
+    Partition& p = partitions[key];
+    p.loaded = true;
+    p.lastAccess = accessClock.elapsed();
+    int from = tasks.size();
+    for (const Task& task : loaded) {
+        // Задача, попавшая не в свой раздел (ручная правка файла), переедет при сохранении
+        int actualKey = partitionKey(task.getDeadline());
+        if (actualKey != key) {
+            markDirty(key);
+            loadPartition(actualKey);
+            markDirty(actualKey);
+        }
+    }
+    tasks.append(loaded);
+    rebuildIndex(from);
+    noteResidentCompletions(from);
+}
 
+void TaskManager::ensureLoaded(const QDate& from, const QDate& to) const {
+    int first = partitionKey(from);
+    int last = partitionKey(to);
+    QList<int> keys;
+    for (QMap<int, Partition>::const_iterator it = partitions.lowerBound(first);
+         it != partitions.constEnd() && it.key() <= last; ++it) {
+        keys.append(it.key());
+    }
+    for (int key : keys) {
+        loadPartition(key);
+    }
+}
+
+void TaskManager::ensureAllLoaded() const {
+    QList<int> keys = partitions.keys();
+    for (int key : keys) {
+        loadPartition(key);
+    }
+}
+
+qint64 TaskManager::completedDay(const Task& task) {
+    if (task.getStatus() != TaskStatus::Completed || !task.getCompletedAt().isValid()) {
+        return 0;
+    }
+    return task.getCompletedAt().date().toJulianDay();
+}
+
+void TaskManager::trackCompletion(TaskId taskId) {
+    int i = indexById.value(taskId, -1);
+    qint64 now = i >= 0 ? completedDay(tasks[i]) : 0;
+    qint64 before = completedDays.value(taskId, 0);
+    if (now == before) {
+        return;
+    }
+    if (before != 0) {
+        QDate day = QDate::fromJulianDay(before);
+        history.add(day, -1);
+        emit completionCountChanged(day, history.count(day));
+    }
+    if (now != 0) {
+        QDate day = QDate::fromJulianDay(now);
+        history.add(day, 1);
+        completedDays.insert(taskId, now);
+        emit completionCountChanged(day, history.count(day));
+    } else {
+        completedDays.remove(taskId);
+    }
+    historyDirty = true;
+}
+
+void TaskManager::noteResidentCompletions(int from) const {
+    // Прочитанные с диска задачи уже учтены в history.json — только запоминаем день
+    for (int i = from; i < tasks.size(); ++i) {
+        qint64 day = completedDay(tasks[i]);
+        if (day != 0) {
+            completedDays.insert(tasks[i].getId(), day);
+        }
+    }
+}
+
+void TaskManager::loadHistory(const QByteArray& data) {
+    TRACE_SCOPE("TaskManager::loadHistory");
+    if (data.isEmpty()) {
+        rebuildHistory();
+        return;
+    }
+    history.fromJson(QJsonDocument::fromJson(data).object()["days"].toObject());
+}
+
+void TaskManager::rebuildHistory() {
+    TRACE_SCOPE("TaskManager::rebuildHistory");
+    // Один раз (первый запуск, восстановление из копии): проходим все разделы,
+    // не оставляя их в памяти
+    history.clear();
+    StorageBackend* storage = StorageBackend::instance();
+    for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+        QList<Task> partitionTasks;
+        storage->readPartition(it.key(), partitionTasks);
+        for (const Task& task : partitionTasks) {
+            qint64 day = completedDay(task);
+            if (day != 0) {
+                history.add(QDate::fromJulianDay(day), 1);
+            }
+        }
+    }
+    historyDirty = true;
+}
+
+bool TaskManager::saveHistory() {
+    TRACE_SCOPE("TaskManager::saveHistory");
+    QJsonObject root;
+    root["version"] = 1;
+    root["days"] = history.toJson();
+    if (!StorageBackend::instance()->writeDocument("history", QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        return false;
+    }
+    historyDirty = false;
+    return true;
+}
+
+void TaskManager::dropCyclicLinks(Task& task) const {
+    // Ссылки на себя и связи, замыкающие цикл (например, после одновременной правки на двух устройствах)
+    TaskId id = task.getId();
+    if (task.getParentId() != 0 && (task.getParentId() == id || graph.createsParentCycle(id, task.getParentId()))) {
+        qWarning() << "Связь с родительской задачей образует цикл и не сохранена:" << id;
+        task.setParentId(0);
+    }
+    QList<TaskId> blockers;
+    for (TaskId blocker : task.getBlockedBy()) {
+        if (blocker == id || blockers.contains(blocker) || graph.createsCycle(id, blocker)) {
+            qWarning() << "Зависимость образует цикл и не сохранена:" << id << "->" << blocker;
+            continue;
+        }
+        blockers.append(blocker);
+    }
+    if (blockers.size() != task.getBlockedBy().size()) {
+        task.setBlockedBy(blockers);
+    }
+}
+
+QList<TaskId> TaskManager::trackLinks(TaskId taskId) {
+    int i = indexById.value(taskId, -1);
+    if (!graph.contains(taskId) && (i < 0 || !tasks[i].hasLinks())) {
+        return QList<TaskId>();     // большинство задач без связей
+    }
+    QSet<TaskId> affected;
+    if (i < 0) {
+        graph.remove(taskId, affected);
+    } else {
+        QList<TaskId> unknown;
+        graph.update(tasks[i], affected, &unknown);
+        // Новая ссылка на задачу вне графа: нужна её отметка. Обычно она в памяти
+        // (выбрана в диалоге); иначе — редкий случай синхронизации — читаем все разделы
+        for (TaskId ref : unknown) {
+            int r = indexById.value(ref, -1);
+            if (r < 0) {
+                ensureAllLoaded();
+                r = indexById.value(ref, -1);
+            }
+            if (r >= 0) {
+                graph.update(tasks[r], affected);
+            }
+        }
+    }
+    graphDirty = true;
+    // Только задачи в памяти: для подписчиков tasksChanged отсутствующий id означает удаление
+    QList<TaskId> resident;
+    for (TaskId id : affected) {
+        if (id != taskId && indexById.contains(id)) {
+            resident.append(id);
+        }
+    }
+    return resident;
+}
+
+void TaskManager::feedGraph(const QList<Task>& some, bool referencedOnly) {
+    // Два прохода: задачи со связями, затем те, на кого они ссылаются
+    QSet<TaskId> ignored;
+    for (const Task& task : some) {
+        if (referencedOnly ? graph.contains(task.getId()) && !graph.isKnown(task.getId()) : task.hasLinks()) {
+            graph.update(task, ignored);
+        }
+    }
+    graphDirty = true;
+}
+
+void TaskManager::loadGraph(const QByteArray& data) {
+    TRACE_SCOPE("TaskManager::loadGraph");
+    graph.clear();
+    if (!data.isEmpty()) {
+        graph.fromJson(QJsonDocument::fromJson(data).object()["nodes"].toObject());
+        return;
+    }
+    // Один раз (первый запуск с подзадачами, старая резервная копия): разделы читаются
+    // и не остаются в памяти
+    StorageBackend* storage = StorageBackend::instance();
+    for (int pass = 0; pass < 2; pass++) {
+        for (QMap<int, Partition>::const_iterator it = partitions.constBegin(); it != partitions.constEnd(); ++it) {
+            QList<Task> partitionTasks;
+            storage->readPartition(it.key(), partitionTasks);
+            feedGraph(partitionTasks, pass == 1);
+        }
+    }
+    graphDirty = true;
+}
+
+bool TaskManager::saveGraph() {
+    TRACE_SCOPE("TaskManager::saveGraph");
+    QJsonObject root;
+    root["version"] = 1;
+    root["nodes"] = graph.toJson();
+    if (!StorageBackend::instance()->writeDocument("graph", QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        return false;
+    }
+    graphDirty = false;
+    return true;
+}
+
+void TaskManager::markDirty(int key, TaskId taskId) const {
+    Partition& p = partitions[key];
+    p.loaded = true;
+    p.dirty = true;
+    p.lastAccess = accessClock.elapsed();
+    p.revision++;
+    if (taskId == 0) {
+        p.rewrite = true;
+    } else {
+        p.touched.insert(taskId);
+    }
+}
+
+QList<TaskId> TaskManager::mergeExternalPartition(int key, const QList<Task>& fresh, quint64 revision) {
+    TRACE_SCOPE("TaskManager::mergeExternalPartition");
+    QMap<int, Partition>::iterator p = partitions.find(key);
+    if (p == partitions.end()) {
+        if (fresh.isEmpty()) {
+            return QList<TaskId>();
+        }
+        p = partitions.insert(key, Partition());
+        if (!isEager(key)) {
+            return QList<TaskId>();     // прочитается при первом обращении
+        }
+        p->loaded = true;
+    }
+    // Невыгруженный раздел перечитается при обращении; после чтения файла были
+    // локальные правки — файл уже перезаписан ими, а чтение устарело
+    if (!p->loaded || p->dirty || p->revision != revision || batchDepth > 0) {
+        return QList<TaskId>();
+    }
+    p->lastAccess = accessClock.elapsed();
+
+    QHash<TaskId, int> incoming;
+    incoming.reserve(fresh.size());
+    for (int i = 0; i < fresh.size(); ++i) {
+        incoming.insert(fresh[i].getId(), i);
+    }
+
+    QList<TaskId> changedIds;
+    QSet<TaskId> removed;
+    for (int i = 0; i < tasks.size(); ++i) {
+        Task& task = tasks[i];
+        if (partitionKey(task.getDeadline()) != key) {
+            continue;
+        }
+        QHash<TaskId, int>::iterator it = incoming.find(task.getId());
+        if (it == incoming.end()) {
+            removed.insert(task.getId());
+            changedIds.append(task.getId());
+            continue;
+        }
+        if (task != fresh[it.value()]) {
+            task = fresh[it.value()];
+            changedIds.append(task.getId());
+        }
+        incoming.erase(it);
+    }
+    for (QHash<TaskId, int>::const_iterator it = incoming.constBegin(); it != incoming.constEnd(); ++it) {
+        const Task& task = fresh[it.value()];
+        int i = indexById.value(task.getId(), -1);
+        if (i >= 0) {
+            // Задачу перенесли из другого месяца: её старый раздел придёт отдельным событием
+            if (tasks[i] == task) {
+                continue;
+            }
+            tasks[i] = task;
+        } else {
+            tasks.append(task);
+        }
+        changedIds.append(task.getId());
+    }
+    if (changedIds.isEmpty()) {
+        return changedIds;
+    }
+
+    if (!removed.isEmpty()) {
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [&removed, key](const Task& task) {
+            return removed.contains(task.getId()) && partitionKey(task.getDeadline()) == key;
+        }), tasks.end());
+    }
+    rebuildIndex();
+    for (TaskId taskId : QList<TaskId>(changedIds)) {
+        rebucket(taskId);
+        trackCompletion(taskId);
+        changedIds.append(trackLinks(taskId));
+    }
+    if (historyDirty) {
+        saveHistory();
+    }
+    if (graphDirty) {
+        saveGraph();
+    }
+    clearUndo();
+    // Файл уже содержит эти данные — сохранять нечего
+    emit tasksChanged(changedIds);
+    return changedIds;
+}
+
+bool TaskManager::migrateLegacyFile() {
+    TRACE_SCOPE("TaskManager::migrateLegacyFile");
+    // Раньше всё лежало в одном tasks.json: в AppData или (из-за пути по умолчанию)
+    // в рабочем каталоге. Раскладываем его по разделам один раз.
+    QString legacy = QFile::exists(dataFile) ? dataFile : QString("tasks.json");
+    QList<Task> legacyTasks;
+    if (!JsonStorage::readTaskFile(legacy, legacyTasks)) {
+        return false;
+    }
+
+    tasks = legacyTasks;
+    rebuildIndex();
+    for (const Task& task : tasks) {
+        markDirty(partitionKey(task.getDeadline()));
+    }
+    if (!saveToFile()) {
+        return false;
+    }
+    QFile::remove(legacy + ".bak");
+    QFile::rename(legacy, legacy + ".bak");
+
+    tasks.clear();
+    indexById.clear();
+    partitions.clear();
+    return true;
+}
+
+void TaskManager::loadRules(const QByteArray& data) {
+    TRACE_SCOPE("TaskManager::loadRules");
+    QJsonArray arr = QJsonDocument::fromJson(data).array();
+    for (const QJsonValue& value : arr) {
+        if (value.isObject()) {
+            rules.append(RecurrenceRule::fromJson(value.toObject()));
+        }
+    }
+}
+
+bool TaskManager::saveRules() {
+    TRACE_SCOPE("TaskManager::saveRules");
+    QJsonArray arr;
+    for (const RecurrenceRule& rule : rules) {
+        arr.append(rule.toJson());
+    }
+    return StorageBackend::instance()->writeDocument("recurrences", QJsonDocument(arr).toJson());
+}
@@ -2,21 +2,99 @@
 #define TASKMANAGER_H
 
 #include "task.h"
+#include "recurrence.h"
+#include "daycontext.h"
+#include "completionhistory.h"
+#include "taskgraph.h"
+#include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <QString>
 #include <QDate>
+#include <QMap>
+#include <QElapsedTimer>
+#include <functional>
+
+class QTimer;
+
+class TaskManager : public QObject {
+    Q_OBJECT
 
-class TaskManager {
 public:
-    TaskManager();
+    // LoadLater — загрузку вызывает владелец (например, preload в пуле потоков при запуске)
+    enum LoadMode { LoadNow, LoadLater };
+
+    explicit TaskManager(QObject* parent = nullptr, LoadMode mode = LoadNow);
     ~TaskManager();
 
     // Управление задачами
-    void addTask(const Task& task);
+    TaskId addTask(const Task& task);       // id 0 — назначается новый
     void updateTask(const Task& task);
-    void deleteTask(int taskId);
-    Task* getTask(int taskId);
-    QList<Task> getAllTasks() const { return tasks; }
+    void deleteTask(TaskId taskId);
+    Task* getTask(TaskId taskId);          // правки — копией через updateTask, иначе их не отменить
+    // То же с подгрузкой, если задача в выгруженном разделе: сначала partitionHint (ключ
+    // partitionKey, если известен), затем остальные невыгруженные от новых к старым до первого совпадения
+    Task* findTask(TaskId taskId, int partitionHint = -1);
+    QList<Task> getAllTasks() const;
+    QList<Task> getTasksForDate(const QDate& date) const;
+    QList<Task> getTasksInRange(const QDate& from, const QDate& to) const;
+    // Все сохранённые задачи по одной: выгруженные разделы читаются по очереди
+    // и в память не ставятся — для потокового вывода без полной загрузки
+    void forEachTask(const std::function<void(const Task&)>& visit) const;
+
+    // Пакетные изменения: всё между beginBatch() и commitBatch() сохраняется
+    // одним saveToFile() и сообщается одним сигналом tasksChanged
+    void beginBatch();
+    void commitBatch();
+    bool inBatch() const { return batchDepth > 0; }
+
+    class Batch {
+    public:
+        explicit Batch(TaskManager* manager) : manager(manager) { manager->beginBatch(); }
+        ~Batch() { manager->commitBatch(); }
+    private:
+        TaskManager* manager;
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+
+    // Отмена и повтор. Шаг — одна правка вне пакета или весь пакет; в шаге хранятся
+    // состояния только затронутых задач до и после (строки Qt разделяются с рабочими копиями)
+    // и список правил, если он менялся. История ограничена объёмом, а не числом шагов:
+    // старые шаги отбрасываются, когда сумма превышает бюджет
+    bool canUndo() const { return !undoSteps.isEmpty(); }
+    bool canRedo() const { return !redoSteps.isEmpty(); }
+    bool undo();
+    bool redo();
+    void clearUndo();
+    qint64 undoHistoryBytes() const;
+    void setUndoBudget(qint64 bytes);
+
+    // Правки не от пользователя этого устройства (синхронизация): в историю не попадают,
+    // а история после них очищается — отменённый шаг перезаписал бы чужую правку
+    class Untracked {
+    public:
+        explicit Untracked(TaskManager* manager) : manager(manager) { manager->untrackedDepth++; }
+        ~Untracked() { manager->endUntracked(); }
+    private:
+        TaskManager* manager;
+        Untracked(const Untracked&) = delete;
+        Untracked& operator=(const Untracked&) = delete;
+    };
+
+    // Повторяющиеся задачи: правило хранится один раз, вхождения добавляются
+    // в getTasksForDate/getTasksInRange; выполненные вхождения сохраняются как обычные задачи
+    int addRule(const RecurrenceRule& rule);
+    void updateRule(const RecurrenceRule& rule);
+    void deleteRule(int ruleId);
+    void setRule(const RecurrenceRule& rule);     // вставить или заменить, сохраняя id (синхронизация)
+    QList<RecurrenceRule> getRules() const { return rules; }
+    TaskId materializeOccurrence(int ruleId, const QDate& date);
+
+    // Массовые операции (выполняются одним пакетом)
+    int rescheduleOverdueTasks(const QDate& newDeadline);
+    int setStatusForDate(const QDate& date, TaskStatus status);
 
     // Фильтрация
     QList<Task> getTasksByStatus(TaskStatus status) const;
@@ -26,12 +104,59 @@ public:
     QList<Task> getTodayTasks() const;
     QList<Task> getWeekTasks() const;
 
+    // Текущий день: снимок обновляется в полночь, задачи перераспределяются
+    // между просроченными/сегодня/неделей без полного пересчёта
+    const DayContext& getDayContext() const { return day; }
+    void checkDay();    // сменился ли день сейчас (по таймеру; симулятор — после сдвига Clock)
+
     // Получение категорий
     QStringList getCategories() const;
 
-    // Сохранение и загрузка
-    bool saveToFile(const QString& filename = "tasks.json");
-    bool loadFromFile(const QString& filename = "tasks.json");
+    // Сохранение и загрузка. Без имени файла — помесячные разделы в StorageBackend
+    // (пишутся только изменённые задачи), с именем — весь набор одним JSON-файлом (экспорт/импорт)
+    bool saveToFile(const QString& filename = QString());
+    bool loadFromFile(const QString& filename = QString());
+
+    // Загрузка при запуске в два шага: preload только читает хранилище и не трогает
+    // TaskManager — его можно звать в пуле потоков; loadPreloaded в главном потоке ставит
+    // прочитанное на место и делает записи первого запуска (перенос tasks.json, правила по умолчанию).
+    // loadFromFile() без имени — то же самое подряд
+    struct Preload {
+        QList<int> keys;                    // все разделы хранилища
+        QMap<int, QList<Task>> eager;       // прочитанные разделы текущих месяцев
+        QByteArray rules;
+        QByteArray history;
+        QByteArray graph;
+    };
+    static Preload preload();
+    void loadPreloaded(const Preload& data);
+
+    // Разделы по месяцу срока: текущий и ближайшие загружаются сразу,
+    // старые — при первом обращении, давно не используемые выгружаются
+    static int partitionKey(const QDate& deadline);
+    int loadedPartitionCount() const;
+    int evictIdlePartitions(int idleMsecs);
+    qint64 residentBytes() const;      // оценка для MemoryBudget
+
+    // Правки файлов разделов извне (см. StoreWatcher). Файл читается в фоновом потоке;
+    // mergeExternalPartition применяет только отличающиеся задачи,
+    // если с момента чтения раздел не менялся локально (revision)
+    quint64 partitionRevision(int key) const { return partitions.value(key).revision; }
+    QList<TaskId> mergeExternalPartition(int key, const QList<Task>& fresh, quint64 revision);
+
+    // Фоновая подгрузка (см. AgendaModel): какие разделы диапазона ещё не в памяти;
+    // они читаются StorageBackend::readPartition в пуле потоков, результат принимает adoptPartition
+    QList<int> missingPartitions(const QDate& from, const QDate& to) const;
+    void adoptPartition(int key, const QList<Task>& loaded);
+
+    // Выполнено по дням за всё время (включая невыгруженные месяцы)
+    const CompletionHistory& getCompletionHistory() const { return history; }
+
+    // Подзадачи и зависимости (Task::setParentId/setBlockedBy, сохраняются через updateTask).
+    // Связь, которая замкнула бы цикл, при сохранении отбрасывается — проверять заранее
+    // через TaskGraph::createsCycle/createsParentCycle. Задачи, у которых сменилась
+    // блокировка или прогресс подзадач, приходят в tasksChanged вместе с изменённой
+    const TaskGraph& getTaskGraph() const { return graph; }
 
     // Статистика
     int getCompletedTodayCount() const;
@@ -40,12 +165,131 @@ public:
     QMap<QString, int> getCategoryStats() const;
     QMap<int, int> getPriorityStats() const; // день недели -> количество выполненных
 
+signals:
+    // Изменённые задачи (включая удалённые); пустой список — перезагрузка всего набора
+    // или правка правил. Перед ним приходит tasksReloaded или ruleListChanged — какой из случаев
+    void tasksChanged(const QList<TaskId>& taskIds);
+    void tasksReloaded();
+    // taskIds — задачи, изменённые в одном пакете с правилами (в tasksChanged их не будет)
+    void ruleListChanged(const QList<TaskId>& taskIds);
+    void dayChanged(const QDate& today);
+    void completionCountChanged(const QDate& day, int count);
+    void undoStateChanged();
+    // Отмена или повтор сменили отметку задачи; day — день добавляемой или снимаемой отметки
+    void statusRestored(TaskId taskId, TaskStatus status, const QDate& day);
+
 private:
-    QList<Task> tasks;
-    QString dataFile;
+    struct Partition {
+        Partition() : loaded(false), dirty(false), rewrite(false), lastAccess(0), revision(0) {}
+        bool loaded;
+        bool dirty;
+        bool rewrite;           // записать раздел целиком, а не только touched
+        QSet<TaskId> touched;   // изменённые, добавленные и удалённые задачи с прошлой записи
+        qint64 lastAccess;
+        quint64 revision;   // растёт при каждой локальной правке
+    };
+
+    struct UndoStep {
+        UndoStep() : rulesTouched(false), bytes(0) {}
+        QHash<TaskId, Task> before;     // Task() — задачи не было
+        QHash<TaskId, Task> after;
+        bool rulesTouched;
+        QList<RecurrenceRule> rulesBefore;
+        QList<RecurrenceRule> rulesAfter;
+        qint64 bytes;
+    };
+
+    static const int EAGER_MONTHS_AHEAD = 2;
+    static const qint64 UNDO_BUDGET_BYTES = 2 * 1024 * 1024;
+    static const int EVICT_IDLE_MSECS = 5 * 60 * 1000;
+    static const int EVICT_CHECK_MSECS = 60 * 1000;
+
+    // Резидентные задачи из загруженных разделов
+    mutable QList<Task> tasks;
+    mutable QHash<TaskId, int> indexById;   // id -> позиция в tasks
+    mutable QHash<QPair<int, qint64>, TaskId> occurrenceIds;   // (правило, julian day) -> id вхождения
+    mutable QMap<int, Partition> partitions;
+    QList<RecurrenceRule> rules;
+    bool rulesDirty;
+    QElapsedTimer accessClock;
+    QTimer* evictTimer;
+
+    // Кэш классификации по DayContext (только сохранённые задачи)
+    DayContext day;
+    mutable QHash<TaskId, int> overdueIds;     // id -> раздел; выгрузка раздела список не сбрасывает
+    mutable QSet<TaskId> todayIds;
+    mutable QSet<TaskId> weekIds;
+    mutable bool overdueValid;
+    mutable bool nearValid;     // todayIds и weekIds
+    QTimer* rolloverTimer;
+    // История выполнения: счётчики по дням и день отметки для резидентных задач,
+    // чтобы при снятии отметки или удалении знать, из какого дня вычесть
+    CompletionHistory history;
+    mutable QHash<TaskId, qint64> completedDays;
+    bool historyDirty;
+    TaskGraph graph;
+    bool graphDirty;
 
-    void ensureDataFile();
+    QString dataFile;       // старый единый tasks.json
+
+    UndoStep openStep;          // собирается до конца правки или пакета
+    QList<UndoStep> undoSteps;
+    QList<UndoStep> redoSteps;
+    qint64 undoBudget;
+    bool replaying;
+    int untrackedDepth;
+    bool untrackedChanged;
+
+    int batchDepth;
+    QSet<TaskId> batchChangedIds;
+    bool batchNeedsSave;
+    bool batchFullReload;
+
+    void noteUndo(TaskId taskId);
+    void noteUndoRules();
+    void closeUndoStep();
+    void trimUndo();
+    void endUntracked();
+    void replayStep(const UndoStep& step, bool backwards);
+    void restoreTask(TaskId taskId, const Task& current, const Task& state);
+    static qint64 taskBytes(const Task& task);
+
+    void rebuildIndex(int from = 0) const;
+    void changed(TaskId taskId);
+    void invalidateBuckets();
+    void rebuildOverdue() const;
+    void rebuildNear() const;
+    void rebucket(TaskId taskId) const;
+    QList<Task> bucketTasks(const QSet<TaskId>& ids) const;
+    void loadOverduePartitions() const;
+    void appendOccurrences(QList<Task>& result, const QDate& from, const QDate& to) const;
+    void armRollover();
+    void rulesChanged();
+    int ruleIndex(int ruleId) const;
+    void skipOccurrence(const Task& task);
+    void loadRules(const QByteArray& data);
+    bool saveRules();
+
+    static bool isEager(int key);
+    void scanPartitions();
+    void loadPartition(int key) const;
+    void installPartition(int key, const QList<Task>& loaded) const;
+    void ensureLoaded(const QDate& from, const QDate& to) const;
+    void ensureAllLoaded() const;
+    void markDirty(int key, TaskId taskId = 0) const;     // 0 — раздел целиком
+    bool migrateLegacyFile();
+    void trackCompletion(TaskId taskId);
+    void noteResidentCompletions(int from) const;
+    void loadHistory(const QByteArray& data);
+    void rebuildHistory();
+    bool saveHistory();
+    void dropCyclicLinks(Task& task) const;
+    QList<TaskId> trackLinks(TaskId taskId);
+    void feedGraph(const QList<Task>& some, bool referencedOnly);
+    void loadGraph(const QByteArray& data);
+    bool saveGraph();
+    static qint64 completedDay(const Task& task);
+    bool storageIsCurrent() const;
 };
 
 #endif // TASKMANAGER_H
-
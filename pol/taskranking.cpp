@@ -0,0 +1,133 @@
+#include "taskranking.h"
+#include "taskmanager.h"
+#include "appsettings.h"
+#include "clock.h"
+
+// Оценка: приоритет весит больше всего, затем срок — чем ближе (и чем дольше просрочка), тем выше
+static const int PRIORITY_POINTS = 60;
+static const int NEAR_DAYS = 14;
+static const int NEAR_POINTS_PER_DAY = 10;
+static const int OVERDUE_POINTS = 150;
+static const int OVERDUE_POINTS_PER_DAY = 5;
+static const int OVERDUE_MAX_DAYS = 30;
+
+bool TaskRanking::Key::operator<(const Key& other) const {
+    if (score != other.score) {
+        return score > other.score;
+    }
+    if (deadlineDay != other.deadlineDay) {
+        return deadlineDay < other.deadlineDay;
+    }
+    return taskId < other.taskId;
+}
+
+TaskRanking::TaskRanking(TaskManager* taskManager, QObject* parent)
+    : QObject(parent), taskManager(taskManager) {
+    loadCategoryWeights();
+    connect(taskManager, &TaskManager::tasksChanged, this, &TaskRanking::onTasksChanged);
+    connect(taskManager, &TaskManager::dayChanged, this, &TaskRanking::rebuild);
+}
+
+int TaskRanking::scoreFor(const Task& task, const QDate& today, int categoryWeight) {
+    int score = static_cast<int>(task.getPriority()) * PRIORITY_POINTS + categoryWeight;
+    qint64 days = today.daysTo(task.getDeadline());
+    if (days < 0) {
+        score += OVERDUE_POINTS + static_cast<int>(qMin<qint64>(-days, OVERDUE_MAX_DAYS)) * OVERDUE_POINTS_PER_DAY;
+    } else if (days < NEAR_DAYS) {
+        score += static_cast<int>(NEAR_DAYS - days) * NEAR_POINTS_PER_DAY;
+    }
+    return score;
+}
+
+void TaskRanking::loadCategoryWeights() {
+    categoryWeights.clear();
+    QString spec = AppSettings::value("ranking/categoryWeights").toString();
+    for (const QString& entry : spec.split(',')) {
+        int colon = entry.lastIndexOf(':');
+        bool ok = false;
+        int weight = colon > 0 ? entry.mid(colon + 1).trimmed().toInt(&ok) : 0;
+        if (ok) {
+            categoryWeights.insert(entry.left(colon).trimmed(), weight);
+        }
+    }
+}
+
+void TaskRanking::setCategoryWeight(const QString& category, int weight) {
+    if (categoryWeights.value(category) == weight) {
+        return;
+    }
+    categoryWeights.insert(category, weight);
+    rebuild();
+}
+
+QList<TaskId> TaskRanking::top(int k) const {
+    QList<TaskId> result;
+    for (QMap<Key, TaskId>::const_iterator it = order.constBegin(); it != order.constEnd() && result.size() < k; ++it) {
+        result.append(it.value());
+    }
+    return result;
+}
+
+void TaskRanking::rebuild() {
+    // Оценка зависит от «сегодня», поэтому при смене дня пересчитывается всё
+    order.clear();
+    keys.clear();
+    today = Clock::currentDate();
+    for (const Task& task : taskManager->getTasksInRange(today.addDays(-OVERDUE_DAYS_BACK), today.addDays(DAYS_AHEAD))) {
+        place(task);
+    }
+    emit rankingChanged();
+}
+
+void TaskRanking::onTasksChanged(const QList<TaskId>& taskIds) {
+    if (!today.isValid()) {
+        return;     // ещё не построен
+    }
+    if (taskIds.isEmpty()) {
+        rebuild();
+        return;
+    }
+    bool changed = false;
+    for (TaskId taskId : taskIds) {
+        const Task* task = taskManager->getTask(taskId);
+        bool wasRanked = keys.contains(taskId);     // могло смениться название в списке
+        changed = (task ? place(*task) : unplace(taskId)) || wasRanked || changed;
+    }
+    if (changed) {
+        emit rankingChanged();
+    }
+}
+
+bool TaskRanking::place(const Task& task) {
+    TaskId taskId = task.getId();
+    qint64 days = today.daysTo(task.getDeadline());
+    if (taskId == 0 || task.getStatus() != TaskStatus::Pending || !task.getDeadline().isValid()
+        || days < -OVERDUE_DAYS_BACK || days > DAYS_AHEAD
+        || taskManager->getTaskGraph().isBlocked(taskId)) {
+        return unplace(taskId);
+    }
+    Key key = { scoreFor(task, today, categoryWeights.value(task.getCategory())),
+                task.getDeadline().toJulianDay(), taskId };
+    QHash<TaskId, Key>::iterator it = keys.find(taskId);
+    if (it != keys.end()) {
+        if (it->score == key.score && it->deadlineDay == key.deadlineDay) {
+            return false;
+        }
+        order.remove(*it);
+        *it = key;
+    } else {
+        keys.insert(taskId, key);
+    }
+    order.insert(key, taskId);
+    return true;
+}
+
+bool TaskRanking::unplace(TaskId taskId) {
+    QHash<TaskId, Key>::iterator it = keys.find(taskId);
+    if (it == keys.end()) {
+        return false;
+    }
+    order.remove(*it);
+    keys.erase(it);
+    return true;
+}
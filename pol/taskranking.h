@@ -0,0 +1,61 @@
+#ifndef TASKRANKING_H
+#define TASKRANKING_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QDate>
+#include "task.h"
+
+class TaskManager;
+
+// «Что делать дальше»: невыполненные задачи упорядочены по оценке из приоритета,
+// близости срока, давности просрочки и веса категории. Оценки лежат в упорядоченном
+// дереве (QMap): правка задачи — O(log n), первые k мест читаются за O(k) без сортировки.
+// Целиком пересчитывается только при смене дня. Не ранжируются вхождения правил
+// (id 0), задачи без срока, заблокированные и просроченные больше OVERDUE_DAYS_BACK дней назад.
+class TaskRanking : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TaskRanking(TaskManager* taskManager, QObject* parent = nullptr);
+
+    QList<TaskId> top(int k) const;
+    int rankedCount() const { return keys.size(); }
+
+    // Веса категорий из settings.ini: ranking/categoryWeights = "Работа:20, Дом:5"
+    void setCategoryWeight(const QString& category, int weight);
+    static int scoreFor(const Task& task, const QDate& today, int categoryWeight);
+
+public slots:
+    void rebuild();
+
+signals:
+    void rankingChanged();
+
+private slots:
+    void onTasksChanged(const QList<TaskId>& taskIds);
+
+private:
+    struct Key {
+        int score;
+        qint64 deadlineDay;
+        TaskId taskId;
+        bool operator<(const Key& other) const;     // выше оценка — раньше
+    };
+
+    static const int OVERDUE_DAYS_BACK = 60;
+    static const int DAYS_AHEAD = 90;
+
+    TaskManager* taskManager;
+    QMap<Key, TaskId> order;
+    QHash<TaskId, Key> keys;
+    QHash<QString, int> categoryWeights;
+    QDate today;
+
+    bool place(const Task& task);      // true — порядок изменился
+    bool unplace(TaskId taskId);
+    void loadCategoryWeights();
+};
+
+#endif // TASKRANKING_H
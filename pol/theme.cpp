@@ -0,0 +1,274 @@
+#include "theme.h"
+#include "trace.h"
+#include <QApplication>
+#include <QPalette>
+#include <QFont>
+
+// Вся фиолетовая тема одной таблицей стилей: Qt разбирает её один раз при запуске,
+// виджеты выбираются по objectName и свойству role вместо собственных setStyleSheet.
+static const char* const STYLE_SHEET = R"(
+    QMainWindow { background-color: #f5f3ff; }
+    QWidget { background-color: #f5f3ff; font-family: 'Segoe UI', sans-serif; }
+
+    QFrame#headerFrame {
+        background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
+            stop:0 #7c3aed, stop:1 #6d28d9);
+        border-radius: 12px;
+        padding: 16px;
+    }
+    QLabel#dateLabel {
+        color: #f5f3ff;
+        font-size: 16pt;
+        font-weight: bold;
+        letter-spacing: 0.5px;
+    }
+    QDateEdit#dateSelector {
+        background-color: rgba(255,255,255,0.95);
+        color: #0d0d0d;
+        border: none;
+        border-radius: 8px;
+        padding: 8px 12px;
+        font-size: 12pt;
+        min-width: 120px;
+    }
+    QDateEdit#dateSelector:hover { background-color: white; }
+    QDateEdit#dateSelector::drop-down {
+        border: none;
+        background: transparent;
+    }
+
+    QTableWidget#tasksTable {
+        background-color: white;
+        border-radius: 12px;
+        border: 1px solid #c4b5fd;
+        gridline-color: #ddd6fe;
+        padding: 4px;
+        alternate-background-color: #faf5ff;
+    }
+    QTableWidget#tasksTable::item {
+        padding: 12px 8px;
+        font-size: 11pt;
+        color: #0d0d0d;
+    }
+    QTableWidget#tasksTable::item:selected {
+        background-color: #ede9fe;
+        color: #0d0d0d;
+    }
+    QHeaderView::section {
+        background: #ede9fe;
+        color: #0d0d0d;
+        padding: 14px 8px;
+        border: none;
+        border-bottom: 2px solid #c4b5fd;
+        border-right: 1px solid #ddd6fe;
+        font-weight: bold;
+        font-size: 11pt;
+    }
+    QHeaderView::section:first { border-top-left-radius: 8px; }
+    QHeaderView::section:last { border-top-right-radius: 8px; }
+    QTableWidget#tasksTable QTableCornerButton::section {
+        background: #ede9fe;
+        border-top-left-radius: 8px;
+    }
+
+    QPushButton#addButton {
+        background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
+            stop:0 #8b5cf6, stop:1 #7c3aed);
+        color: white;
+        border: none;
+        border-radius: 10px;
+        padding: 14px 28px;
+        font-size: 13pt;
+        font-weight: bold;
+    }
+    QPushButton#addButton:hover {
+        background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
+            stop:0 #a78bfa, stop:1 #8b5cf6);
+    }
+    QPushButton#addButton:pressed {
+        background: #6d28d9;
+    }
+
+    QScrollBar:vertical {
+        background: #ede9fe;
+        width: 10px;
+        border-radius: 5px;
+        margin: 2px;
+    }
+    QScrollBar::handle:vertical {
+        background: #c4b5fd;
+        border-radius: 5px;
+        min-height: 30px;
+    }
+    QScrollBar::handle:vertical:hover { background: #a78bfa; }
+    QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical { height: 0; }
+
+    QTabWidget#tabWidget::pane {
+        border: 1px solid #c4b5fd;
+        border-radius: 12px;
+        background: #ffffff;
+        top: -1px;
+    }
+    QTabWidget#tabWidget QTabBar::tab {
+        background: #ede9fe;
+        color: #5b21b6;
+        padding: 14px 20px;
+        margin-right: 2px;
+        border-top-left-radius: 8px;
+        border-top-right-radius: 8px;
+        font-weight: bold;
+        font-size: 12pt;
+        min-width: 80px;
+    }
+    QTabWidget#tabWidget QTabBar::tab:selected {
+        background: #ffffff;
+        color: #6d28d9;
+        border: 1px solid #c4b5fd;
+        border-bottom: none;
+    }
+    QTabWidget#tabWidget QTabBar::tab:hover:!selected {
+        background: #ddd6fe;
+        color: #5b21b6;
+    }
+
+    QFrame#gameFrame {
+        background: qlineargradient(x1:0, y1:0, x2:1, y2:0,
+            stop:0 #2563eb, stop:1 #1d4ed8);
+        border-radius: 12px;
+        padding: 12px;
+    }
+    QLabel#levelLabel { color: #0d0d0d; font-size: 14pt; font-weight: bold; }
+    QLabel#streakLabel { color: #0d0d0d; font-size: 12pt; font-weight: bold; }
+    QProgressBar#xpBar {
+        border: 1px solid #1e40af;
+        border-radius: 8px;
+        background: rgba(255,255,255,0.85);
+        text-align: center;
+        color: #0d0d0d;
+        font-weight: bold;
+        font-size: 11pt;
+    }
+    QProgressBar#xpBar::chunk { background: #93c5fd; border-radius: 6px; }
+
+    QLabel[role="sectionTitle"] { font-weight: bold; font-size: 12pt; color: #0d0d0d; }
+    QComboBox#englishLevelCombo, QComboBox#prayerGospelCombo {
+        background: white;
+        color: #0d0d0d;
+        border-radius: 8px;
+        border: 1px solid #c4b5fd;
+        padding: 8px;
+    }
+    QListWidget#englishLessonList, QListWidget#prayerChapterList {
+        background: white;
+        color: #0d0d0d;
+        border-radius: 8px;
+        border: 1px solid #c4b5fd;
+        padding: 4px;
+    }
+    QTableWidget#englishWordsTable {
+        background: white;
+        color: #0d0d0d;
+        border-radius: 8px;
+        border: 1px solid #e2e8f0;
+    }
+    QPushButton#englishAddWordBtn {
+        background: #4c6ef5;
+        color: white;
+        border-radius: 8px;
+        padding: 8px 16px;
+        font-weight: bold;
+    }
+    QPushButton#englishRemoveWordBtn {
+        background: #e2e8f0;
+        color: #0d0d0d;
+        border-radius: 8px;
+        padding: 8px 16px;
+    }
+
+    QLabel#prayerImageLabel {
+        background: #f8fafc;
+        border: 2px dashed #cbd5e1;
+        border-radius: 12px;
+        color: #0d0d0d;
+        font-size: 11pt;
+    }
+    QPushButton#prayerAddImageBtn {
+        background: #475569;
+        color: #f8fafc;
+        border-radius: 8px;
+        padding: 10px 20px;
+        font-weight: bold;
+    }
+    QPushButton#prayerAddImageBtn:hover { background: #334155; }
+    QTextEdit#prayerChapterText {
+        background: #faf5ff;
+        color: #0d0d0d;
+        border-radius: 8px;
+        border: 1px solid #c4b5fd;
+        padding: 12px;
+        font-size: 11pt;
+    }
+
+    QDialog#taskDialog { background-color: #f8fafc; }
+    QDialog#taskDialog QLabel { color: #0d0d0d; font-size: 11pt; font-weight: bold; }
+    QDialog#taskDialog QLineEdit, QDialog#taskDialog QTextEdit,
+    QDialog#taskDialog QDateEdit, QDialog#taskDialog QComboBox {
+        background-color: white;
+        color: #0d0d0d;
+        border: 2px solid #e2e8f0;
+        border-radius: 8px;
+        padding: 10px 12px;
+        font-size: 11pt;
+        selection-background-color: #e8f0fe;
+    }
+    QDialog#taskDialog QLineEdit:focus, QDialog#taskDialog QTextEdit:focus,
+    QDialog#taskDialog QDateEdit:focus, QDialog#taskDialog QComboBox:focus {
+        border-color: #5c7cfa;
+    }
+    QDialog#taskDialog QComboBox::drop-down { border: none; padding-right: 8px; }
+    QDialog#taskDialog QComboBox QAbstractItemView { background: white; border-radius: 8px; }
+    QDialog#taskDialog QPushButton {
+        background: qlineargradient(x1:0, y1:0, x2:0, y2:1,
+            stop:0 #5c7cfa, stop:1 #4c6ef5);
+        color: white;
+        border: none;
+        border-radius: 8px;
+        padding: 10px 20px;
+        font-weight: bold;
+        font-size: 11pt;
+    }
+    QDialog#taskDialog QPushButton:hover { background: #4c6ef5; }
+    QDialog#taskDialog QPushButton#cancelButton {
+        background: #e2e8f0;
+        color: #0d0d0d;
+    }
+    QDialog#taskDialog QPushButton#cancelButton:hover { background: #cbd5e1; }
+)";
+
+void Theme::apply(QApplication& app) {
+    TRACE_SCOPE("Theme::apply");
+    app.setFont(QFont("Segoe UI"));
+    app.setPalette(palette());
+    app.setStyleSheet(QString::fromUtf8(STYLE_SHEET));
+}
+
+QPalette Theme::palette() {
+    // Палитра для того, что рисуется без таблицы стилей (всплывающие календари, подсказки)
+    QPalette pal;
+    pal.setColor(QPalette::Window, QColor("#f5f3ff"));
+    pal.setColor(QPalette::WindowText, QColor("#0d0d0d"));
+    pal.setColor(QPalette::Base, Qt::white);
+    pal.setColor(QPalette::AlternateBase, QColor("#faf5ff"));
+    pal.setColor(QPalette::Text, QColor("#0d0d0d"));
+    pal.setColor(QPalette::Button, QColor("#ede9fe"));
+    pal.setColor(QPalette::ButtonText, QColor("#0d0d0d"));
+    pal.setColor(QPalette::Highlight, QColor("#ede9fe"));
+    pal.setColor(QPalette::HighlightedText, QColor("#0d0d0d"));
+    pal.setColor(QPalette::ToolTipBase, Qt::white);
+    pal.setColor(QPalette::ToolTipText, QColor("#0d0d0d"));
+    return pal;
+}
+
+void Theme::setRole(QWidget* widget, const char* role) {
+    widget->setProperty("role", QString::fromLatin1(role));
+}
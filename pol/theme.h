@@ -0,0 +1,19 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QPalette>
+
+class QApplication;
+class QWidget;
+
+// Оформление приложения: палитра, шрифт и единая таблица стилей
+class Theme {
+public:
+    static void apply(QApplication& app);             // один раз при запуске, до создания окон
+    static void setRole(QWidget* widget, const char* role);  // role="sectionTitle" и т.п. для селекторов
+
+private:
+    static QPalette palette();
+};
+
+#endif // THEME_H
@@ -0,0 +1,9 @@
+# Ядро и утилита командной строки без интерфейса. Собираются отдельно от приложения:
+#   qmake tools.pro && make && ./cli/pol-cli --help
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    core \
+    cli
+
+cli.depends = core
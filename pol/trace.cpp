@@ -0,0 +1,114 @@
+#include "trace.h"
+#include "appsettings.h"
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <chrono>
+
+std::atomic<bool> Trace::enabled(false);
+QString Trace::outputPath;
+
+static const int TRACE_CAPACITY = 16384;   // событий на поток; старые перезаписываются
+
+struct TraceEvent {
+    const char* name;
+    qint64 start;
+    qint64 duration;
+};
+
+struct TraceBuffer {
+    TraceEvent events[TRACE_CAPACITY];
+    std::atomic<quint64> written;
+    int threadId;
+};
+
+// Буферы живут до конца процесса, чтобы события завершившихся потоков попали в дамп
+static QMutex registryMutex;
+static QList<TraceBuffer*> registry;
+static thread_local TraceBuffer* localBuffer = nullptr;
+
+static TraceBuffer* threadBuffer() {
+    if (!localBuffer) {
+        TraceBuffer* buffer = new TraceBuffer;
+        buffer->written.store(0, std::memory_order_relaxed);
+        QMutexLocker lock(&registryMutex);
+        buffer->threadId = registry.size() + 1;
+        registry.append(buffer);
+        localBuffer = buffer;
+    }
+    return localBuffer;
+}
+
+void Trace::initFromEnvironment() {
+    QString path = QString::fromLocal8Bit(qgetenv("POL_TRACE"));
+    if (path.isEmpty()) {
+        path = AppSettings::value("debug/traceFile").toString();
+    }
+    if (!path.isEmpty()) {
+        outputPath = path;
+        setEnabled(true);
+    }
+}
+
+void Trace::finish() {
+    if (isEnabled() && !outputPath.isEmpty()) {
+        if (dump(outputPath)) {
+            qInfo() << "Трасса сохранена:" << outputPath;
+        }
+    }
+}
+
+qint64 Trace::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char* name, qint64 startNs, qint64 durationNs) {
+    TraceBuffer* buffer = threadBuffer();
+    quint64 n = buffer->written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[n % TRACE_CAPACITY];
+    event.name = name;
+    event.start = startNs;
+    event.duration = durationNs;
+    buffer->written.store(n + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Не удалось открыть файл для записи:" << path;
+        return false;
+    }
+
+    QList<TraceBuffer*> buffers;
+    {
+        QMutexLocker lock(&registryMutex);
+        buffers = registry;
+    }
+
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (TraceBuffer* buffer : buffers) {
+        QByteArray line = QByteArray(first ? "" : ",\n")
+            + "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->threadId)
+            + ",\"args\":{\"name\":\"thread " + QByteArray::number(buffer->threadId) + "\"}}";
+        file.write(line);
+        first = false;
+
+        quint64 end = buffer->written.load(std::memory_order_acquire);
+        quint64 begin = end > quint64(TRACE_CAPACITY) ? end - TRACE_CAPACITY : 0;
+        for (quint64 i = begin; i < end; i++) {
+            const TraceEvent& event = buffer->events[i % TRACE_CAPACITY];
+            line = ",\n{\"name\":\"" + QByteArray(event.name)
+                + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(buffer->threadId)
+                + ",\"ts\":" + QByteArray::number(event.start / 1000.0, 'f', 3)
+                + ",\"dur\":" + QByteArray::number(event.duration / 1000.0, 'f', 3) + "}";
+            file.write(line);
+        }
+    }
+    file.write("\n]}\n");
+    file.close();
+    return true;
+}
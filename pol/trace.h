@@ -0,0 +1,50 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <atomic>
+
+// Лёгкая трассировка: интервалы пишутся в кольцевой буфер своего потока
+// (без блокировок) и сохраняются в формате Chrome/Perfetto trace-event JSON.
+// Включается переменной окружения POL_TRACE=<файл> или скрытой настройкой
+// debug/traceFile. Выключенная трассировка стоит одну атомарную проверку.
+class Trace {
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    static void initFromEnvironment();
+    static void finish();                      // сохранить в файл из настроек, если включено
+    static bool dump(const QString& path);
+
+    static qint64 nowNs();
+    static void record(const char* name, qint64 startNs, qint64 durationNs);  // name — строковый литерал
+
+private:
+    static std::atomic<bool> enabled;
+    static QString outputPath;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* spanName)
+        : name(Trace::isEnabled() ? spanName : nullptr), start(name ? Trace::nowNs() : 0) {}
+    ~TraceScope() {
+        if (name) {
+            Trace::record(name, start, Trace::nowNs() - start);
+        }
+    }
+
+private:
+    const char* name;
+    qint64 start;
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define POL_TRACE_CONCAT2(a, b) a##b
+#define POL_TRACE_CONCAT(a, b) POL_TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope POL_TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#endif // TRACE_H